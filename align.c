@@ -0,0 +1,272 @@
+/*
+ * Find where crypt output starts inside a larger file.
+ *
+ * Ciphertext recovered from mail spools, archives and disk images
+ * is often preceded by a header, so block k of the crypt output
+ * does not start at byte k*256 of the file.  With the wrong
+ * alignment the equivalence classes of a block mix characters
+ * enciphered by two different permutations, and the guessing
+ * tools fail without saying why.
+ *
+ * For every candidate start position we rebuild the equivalence
+ * classes of each block and check that every class has at least one
+ * partner class that the reflector could be wired to without
+ * deducing a character that never occurs in plaintext.  Real
+ * crypt-over-text passes this test for every class; misaligned
+ * blocks fail it for the characters that came from the neighboring
+ * block.  Blocks that are mostly seven bit characters are header
+ * text, not crypt output, and count as entirely bad.
+ */
+
+#include	<stdlib.h>
+#include	<stdio.h>
+#include	<math.h>
+#include	"window.h"
+#include	"specs.h"
+
+
+#define	ALWORDS		(BLOCKSIZE/32)	/* Words in a set of 256 values. */
+#define	ALMAXBLKS	64		/* Max blocks examined per offset. */
+#define	ALNSHOW		5		/* Candidates printed by standalone. */
+#define	ALMINHIGH	(BLOCKSIZE/4)	/* Fewer eight bit chars is not crypt. */
+
+/* Set operations on 256-bit sets of shifted characters.
+ * Each set is ALWORDS unsigned 32 bit words so the intersections
+ * below handle 32 partner candidates per machine operation.
+ */
+#define	alset_has(set, v)	(((set)[(v)>>5] >> ((v)&037)) & 1)
+#define	alset_add(set, v)	((set)[(v)>>5] |= (1U << ((v)&037)))
+#define	alset_del(set, v)	((set)[(v)>>5] &= ~(1U << ((v)&037)))
+
+
+extern	int		stats1loaded;
+extern	float	logprob[];
+
+/* Forward declarations */
+void align_init(void);
+int align_block(char *cbuf);
+long align_detect(char *filename, long maxstart, float *confp);
+
+
+/* Global state. */
+
+/* posset[i] is the set of shifted plaintext values y such that
+ * (y - i) mod 256 is a character that can appear in plaintext.
+ */
+unsigned int	posset[BLOCKSIZE][ALWORDS];
+int		alinit = FALSE;
+
+/* Results of the last align_detect call, for the standalone report. */
+long	albest[ALNSHOW];
+float	alrate[ALNSHOW];
+int		alnblocks[ALNSHOW];
+
+
+#ifdef ALIGN_STANDALONE
+int main(int argc, char *argv[])
+{
+	long	maxstart;
+	long	start;
+	float	conf;
+	int		i;
+	extern	char	*getenv();
+
+	if (argc < 2 || argc > 3)  {
+		printf("Usage: %s cipherfile [max_start]\n", argv[0]);
+		printf("\tThe shell variable LETTERSTATS may be defined.\n");
+		exit(0);
+		}
+	maxstart = BLOCKSIZE - 1;
+	if (argc == 3  &&  sscanf(argv[2], "%ld", &maxstart) != 1)  {
+		printf("Could not parse the max start from %s.\n", argv[2]);
+		exit(0);
+		}
+
+	if ((letterstats = getenv("LETTERSTATS")) != NULL)
+		need_1stats();
+
+	start = align_detect(argv[1], maxstart, &conf);
+	if (start < 0)  {
+		printf("%s does not hold a full block after any start position.\n",
+				argv[1]);
+		exit(1);
+		}
+
+	printf("Start\tBlocks\tBad fraction\n");
+	for (i = 0 ; i < ALNSHOW  &&  albest[i] >= 0 ; i++)  {
+		printf("%5ld\t%6d\t%12.4f\n", albest[i], alnblocks[i], alrate[i]);
+		}
+	printf("\nBest start is %ld with confidence %5.3f.\n", start, conf);
+	return 0;
+}
+#endif
+
+
+/* Fill in posset from the letter statistics if they are loaded,
+ * otherwise allow any seven bit character.
+ */
+void align_init(void)
+{
+	int		i, y, c;
+
+	for (i = 0 ; i < BLOCKSIZE ; i++)  {
+		for (y = 0 ; y < ALWORDS ; y++)  posset[i][y] = 0;
+		for (y = 0 ; y < BLOCKSIZE ; y++)  {
+			c = (y - i) & MODMASK;
+			if (notascii(c))  continue;
+			if (stats1loaded  &&  logprob[c] == 0.0)  continue;
+			alset_add(posset[i], y);
+			}
+		}
+	alinit = TRUE;
+}
+
+
+/* Return the number of characters in the block that belong to an
+ * equivalence class with no acceptable partner class.
+ * Zero is expected for a correctly aligned block of text.
+ * Crypt output is close to uniform over all 256 byte values, so
+ * a block with fewer than ALMINHIGH eight bit bytes is all bad.
+ */
+int align_block(char *cbuf)
+{
+	int		i, w, c, x, y;
+	int		bad, nhigh;
+	int		feasible;
+	int		size[BLOCKSIZE];
+	unsigned int	cls[BLOCKSIZE][ALWORDS];
+	unsigned int	cand[ALWORDS];
+
+	if (!alinit)  align_init();
+
+	for (x = 0 ; x < BLOCKSIZE ; x++)  {
+		size[x] = 0;
+		for (w = 0 ; w < ALWORDS ; w++)  cls[x][w] = ~0U;
+		}
+
+	/* cls[x] becomes the set of values x can be wired to. */
+	nhigh = 0;
+	for (i = 0 ; i < BLOCKSIZE ; i++)  {
+		c = cbuf[i] & MODMASK;
+		if (notascii(c))  nhigh++;
+		x = (c + i) & MODMASK;
+		size[x]++;
+		for (w = 0 ; w < ALWORDS ; w++)  cls[x][w] &= posset[i][w];
+		}
+
+	if (nhigh < ALMINHIGH)  return(BLOCKSIZE);
+
+	bad = 0;
+	for (x = 0 ; x < BLOCKSIZE ; x++)  {
+		if (size[x] == 0)  continue;
+		for (w = 0 ; w < ALWORDS ; w++)  cand[w] = cls[x][w];
+		alset_del(cand, x);
+
+		feasible = FALSE;
+		for (w = 0 ; w < ALWORDS  &&  !feasible ; w++)  {
+			if (cand[w] == 0)  continue;
+			for (y = w << 5 ; y < (w+1) << 5 ; y++)  {
+				if (!alset_has(cand, y))  continue;
+				if (size[y] == 0  ||  alset_has(cls[y], x))  {
+					feasible = TRUE;
+					break;
+					}
+				}
+			}
+		if (!feasible)  bad += size[x];
+		}
+
+	return(bad);
+}
+
+
+/* Try every start position from 0 to maxstart and return the one
+ * whose blocks look most like crypt output, or -1 if the file is
+ * too short to hold a single block.
+ * The confidence, stored through confp, is near one when the best
+ * start is much cleaner than the best start with any other
+ * alignment mod 256, and near zero when they are indistinguishable.
+ */
+long align_detect(char *filename, long maxstart, float *confp)
+{
+	FILE	*fd;
+	char	*data;
+	long	length;
+	long	start, offset;
+	int		k, m, i;
+	int		bestk;
+	int		nblocks, nbad;
+	int		blkbad[ALMAXBLKS];
+	float	rate;
+	float	bestrate, otherrate;
+	long	beststart;
+
+	*confp = 0.0;
+	for (i = 0 ; i < ALNSHOW ; i++)  albest[i] = -1;
+
+	if ((fd = fopen(filename, "r")) == NULL)  {
+		printf("\nCould not open %s to read ciphertext.\n", filename);
+		exit(0);
+		}
+	fseek(fd, 0L, 2);
+	length = ftell(fd);
+	fseek(fd, 0L, 0);
+	data = ((char *) malloc(length + 1));
+	if (data == NULL)  {
+		printf("\nNo room to read %s.\n", filename);
+		exit(0);
+		}
+	length = fread(data, 1, length, fd);
+	fclose(fd);
+
+	for (offset = 0 ; offset < BLOCKSIZE  &&  offset <= maxstart ; offset++)  {
+		nblocks = 0;
+		for (start = offset ; start + BLOCKSIZE <= length ; start += BLOCKSIZE)  {
+			if (nblocks >= ALMAXBLKS)  break;
+			blkbad[nblocks++] = align_block(&data[start]);
+			}
+
+		/* Consider dropping leading blocks that are really header.
+		 * The extra bad character charged to every start keeps a
+		 * short clean tail from beating a long, nearly clean run.
+		 */
+		beststart = -1;
+		bestrate = 2.0;
+		nbad = 0;
+		for (k = nblocks - 1 ; k >= 0 ; k--)  {
+			nbad += blkbad[k];
+			start = offset + ((long) k) * BLOCKSIZE;
+			if (start > maxstart)  continue;
+			rate = ((float) (nbad + 1)) / ((nblocks - k) * BLOCKSIZE);
+			if (rate <= bestrate)  {
+				bestrate = rate;
+				beststart = start;
+				bestk = k;
+				}
+			}
+		if (beststart < 0)  continue;
+
+		/* Keep the ALNSHOW best alignments. */
+		for (m = 0 ; m < ALNSHOW ; m++)  {
+			if (albest[m] < 0  ||  bestrate < alrate[m])  break;
+			}
+		if (m >= ALNSHOW)  continue;
+		for (i = ALNSHOW - 1 ; i > m ; i--)  {
+			albest[i] = albest[i-1];
+			alrate[i] = alrate[i-1];
+			alnblocks[i] = alnblocks[i-1];
+			}
+		albest[m] = beststart;
+		alrate[m] = bestrate;
+		alnblocks[m] = nblocks - bestk;
+		}
+	free(data);
+
+	if (albest[0] < 0)  return(-1);
+	bestrate = alrate[0];
+	otherrate = (albest[1] < 0) ? 1.0 : alrate[1];
+
+	*confp = 1.0 - bestrate / otherrate;
+	if (*confp < 0.0)  *confp = 0.0;
+	return(albest[0]);
+}
@@ -0,0 +1,189 @@
+/*
+ * Arena allocation of work space.
+ *
+ * Space comes from a list of chunks.  Allocating bumps the offset
+ * into the current chunk, and moves on to the next chunk, or makes
+ * one, when it is full.  Resetting goes back to the start of the
+ * first chunk without giving back any chunks, so an arena that is
+ * reset after each job settles at the size of the biggest job.
+ * A global arena that is all zeros is ready to use.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<sys/types.h>
+#include	<sys/mman.h>
+#include	"window.h"
+#include	"specs.h"
+#include	"arena.h"
+
+
+/* Bytes of a chunk taken by its header. */
+#define	ARHDR		((sizeof(archunk) + ARALIGN - 1) & ~((long) ARALIGN - 1))
+
+/* First byte of a chunk after the header. */
+#define	ardata(chunk)	(((char *) (chunk)) + ARHDR)
+
+
+/* Forward declarations */
+void ar_init(arena *ar, long chunksize, int flags);
+char *ar_alloc(arena *ar, long size);
+void ar_mark(arena *ar, armark *mark);
+void ar_release(arena *ar, armark *mark);
+void ar_reset(arena *ar);
+void ar_free(arena *ar);
+void ar_report(FILE *out, char *name, arena *ar);
+archunk *ar_newchunk(arena *ar, long size);
+
+
+/* Set up an empty arena.  No space is taken until the first
+ * allocation.  A chunksize of zero means ARCHUNK.
+ */
+void ar_init(arena *ar, long chunksize, int flags)
+{
+	ar->first = ar->cur = NULL;
+	ar->used = 0;
+	ar->chunksize = (chunksize > 0) ? chunksize : ARCHUNK;
+	ar->flags = flags;
+	ar->inuse = ar->peak = 0;
+	ar->nalloc = ar->nreset = 0;
+	ar->mapped = 0;
+}
+
+
+/* Return size bytes of space, aligned to ARALIGN.
+ * The space is not cleared.
+ */
+char *ar_alloc(arena *ar, long size)
+{
+	archunk	*chunk;
+	char	*p;
+
+	size = (size + ARALIGN - 1) & ~((long) ARALIGN - 1);
+	if (ar->cur == NULL  ||  ar->used + size > ar->cur->size)  {
+		chunk = (ar->cur == NULL) ? ar->first : ar->cur->next;
+		if (chunk == NULL  ||  chunk->size < size)  {
+			chunk = ar_newchunk(ar, size);
+			if (ar->cur == NULL)  {
+				chunk->next = ar->first;
+				ar->first = chunk;
+				}
+			else  {
+				chunk->next = ar->cur->next;
+				ar->cur->next = chunk;
+				}
+			}
+		ar->cur = chunk;
+		ar->used = 0;
+		}
+
+	p = ardata(ar->cur) + ar->used;
+	ar->used += size;
+	ar->inuse += size;
+	if (ar->inuse > ar->peak)  ar->peak = ar->inuse;
+	ar->nalloc++;
+	return(p);
+}
+
+
+/* Make a chunk with room for at least size bytes.
+ * Huge pages are used if asked for and the system has them.
+ */
+archunk *ar_newchunk(arena *ar, long size)
+{
+	archunk	*chunk;
+	long	total;
+
+	if (ar->chunksize <= 0)  ar->chunksize = ARCHUNK;
+	if (size < ar->chunksize)  size = ar->chunksize;
+	total = ARHDR + size;
+	chunk = NULL;
+
+#ifdef MAP_HUGETLB
+	if (ar->flags & ARHUGE)  {
+		total = (total + ARHUGESIZE - 1) & ~(ARHUGESIZE - 1);
+		chunk = (archunk *) mmap(NULL, total, PROT_READ | PROT_WRITE,
+		                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (chunk == (archunk *) MAP_FAILED)  {
+			chunk = NULL;
+			total = ARHDR + size;
+			}
+		else  {
+			chunk->huge = TRUE;
+			}
+		}
+#endif
+
+	if (chunk == NULL)  {
+		if ((chunk = (archunk *) malloc(total)) == NULL)  {
+			printf("\nNo room for %ld bytes of work space.\n", total);
+			exit(0);
+			}
+		chunk->huge = FALSE;
+		}
+	chunk->size = total - ARHDR;
+	chunk->next = NULL;
+	ar->mapped += total;
+	return(chunk);
+}
+
+
+/* Remember how much of the arena is in use.
+ */
+void ar_mark(arena *ar, armark *mark)
+{
+	mark->cur = ar->cur;
+	mark->used = ar->used;
+	mark->inuse = ar->inuse;
+}
+
+
+/* Give back everything allocated since mark was taken.
+ */
+void ar_release(arena *ar, armark *mark)
+{
+	ar->cur = mark->cur;
+	ar->used = mark->used;
+	ar->inuse = mark->inuse;
+}
+
+
+/* Give back everything, but keep the chunks for next time.
+ */
+void ar_reset(arena *ar)
+{
+	ar->cur = NULL;
+	ar->used = 0;
+	ar->inuse = 0;
+	ar->nreset++;
+}
+
+
+/* Give back everything including the chunks.
+ * The statistics are kept.
+ */
+void ar_free(arena *ar)
+{
+	archunk	*chunk, *next;
+
+	for (chunk = ar->first ; chunk != NULL ; chunk = next)  {
+		next = chunk->next;
+		ar->mapped -= ARHDR + chunk->size;
+		if (chunk->huge)
+			munmap((char *) chunk, ARHDR + chunk->size);
+		else
+			free(chunk);
+		}
+	ar->first = ar->cur = NULL;
+	ar->used = ar->inuse = 0;
+}
+
+
+/* Print the statistics of an arena on one line.
+ */
+void ar_report(FILE *out, char *name, arena *ar)
+{
+	fprintf(out, "%s: %ld bytes in use, peak %ld, %ld mapped,",
+	        name, ar->inuse, ar->peak, ar->mapped);
+	fprintf(out, " %ld allocations, %ld resets.\n", ar->nalloc, ar->nreset);
+}
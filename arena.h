@@ -0,0 +1,75 @@
+#ifndef __ARENA_H
+#define __ARENA_H
+
+/*
+ * Declarations for allocating work space from an arena.
+ *
+ * An arena hands out space by bumping a pointer through big chunks
+ * and gives it all back at once, so the space used for one job or
+ * one block can be dropped in a single step when it is done, and a
+ * long running program does not grow.  Arenas are not shared: each
+ * process made by fanout works in its own copy-on-write copy of its
+ * parent's arenas.
+ *
+ * The permutations of perm.c, the work space of cribmine, the
+ * buffers of fanout and its pipelines, and the corpus of bench come
+ * from arenas.  The other engines are left out on purpose.  The
+ * dictionaries of wordscore.c and webster.c are loaded once and kept
+ * for the life of the program, and the hash table of wordscore.c
+ * grows by doubling, which needs the old table given back by itself.
+ * Phrase.c, wrongwire.c, ensemble.c, mstart.c, orch.c, keysrch.c and
+ * mangle.c work in arrays whose size is fixed by BLOCKSIZE, NPERMS or
+ * FANMAX, on the stack or in globals, so they have nothing to give
+ * back.  Each spool job runs in a process of its own, and all its
+ * space goes back when that process exits.
+ */
+
+
+#define	ARCHUNK		(1L << 20)		/* Default chunk size. */
+#define	ARHUGESIZE	(2L << 20)		/* Size of a huge page. */
+#define	ARALIGN		16				/* Alignment of every allocation. */
+
+/* Flags. */
+#define	ARHUGE		01				/* Try to use huge pages for chunks. */
+
+
+#define	archunk	struct xarchunk
+archunk	{
+		archunk	*next;
+		long	size;				/* Bytes after the header. */
+		int		huge;				/* TRUE if mapped with huge pages. */
+		};
+
+#define	arena	struct xarena
+arena	{
+		archunk	*first;				/* Chunks in the order made. */
+		archunk	*cur;				/* Chunk being allocated from. */
+		long	used;				/* Bytes of cur in use. */
+		long	chunksize;
+		int		flags;
+		/* Statistics. */
+		long	inuse;				/* Bytes handed out since the reset. */
+		long	peak;				/* Most bytes in use at once. */
+		long	nalloc;				/* Allocations since the arena was made. */
+		long	nreset;
+		long	mapped;				/* Bytes of all the chunks. */
+		};
+
+/* A point to go back to with ar_release. */
+#define	armark	struct xarmark
+armark	{
+		archunk	*cur;
+		long	used;
+		long	inuse;
+		};
+
+
+extern	void	ar_init(/* ar, chunksize, flags */);
+extern	char	*ar_alloc(/* ar, size */);	/* Exits if no room. */
+extern	void	ar_mark(/* ar, mark */);
+extern	void	ar_release(/* ar, mark */);	/* Drop what followed mark. */
+extern	void	ar_reset(/* ar */);			/* Drop everything, keep chunks. */
+extern	void	ar_free(/* ar */);			/* Give back the chunks too. */
+extern	void	ar_report(/* out, name, ar */);
+
+#endif /* __ARENA_H */
@@ -173,11 +173,11 @@ char	cipher[];
 int		perm[];
 atrinfo	*atri;
 {
-extern	int	*trig_loaded;
+extern	int	trig_loaded;
 
 	atri->eci = &gecinfo;
 	if (!trig_loaded)
-		load_tri_from(trigramstats);
+		need_tri();
 	ec_init(cipher, perm, atri->eci);
 	atr_guess_init(atri);
 }
@@ -6,7 +6,7 @@
  */
 
 
-#define	PERMSZ		20
+#define	PERMSZ		64
 #define	TRIGTABSZ	150
 #define	TRIGBUFSZ	(4*(TRIGTABSZ+1))
 
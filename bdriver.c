@@ -35,6 +35,9 @@ extern	void lp_accept();
 extern	int lp_best_pos();
 extern	void lp_dclasses();
 
+extern	long	lpnguess;
+extern	long	lpnscore2;
+
 extern	char	mcbuf[];
 extern	char	*fname;			/* Used by fillcbuf. */
 
@@ -95,9 +98,11 @@ char	*argv[];
 
 	printf("Loading statistics ...");
 	printf(" 1");
-	load_1stats_from("mss.stats");
+	letterstats = "mss.stats";
+	need_1stats();
 	printf(" 2");
-	load_2stats_from("mss-bigram.stats");
+	bigramstats = "mss-bigram.stats";
+	need_2stats();
 	printf(" done.\n");
 
 	eci = &myecinfo;
@@ -116,6 +121,8 @@ char	*argv[];
 	for (blknum = 0 ; blknum <= maxblock ; blknum++) {
 		do_lp_block(eci, blknum, infile, inplain);
 		}
+	printf("\n%ld guesses to score, %ld letter pair scores computed.\n",
+	       lpnguess, lpnscore2);
 
 	return 0;
 }
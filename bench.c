@@ -0,0 +1,566 @@
+/*
+ * Batch program that measures how the engines scale with the number
+ * of worker processes, and what they cost in memory.
+ *
+ * A synthetic corpus is made from a sample text by drawing its lines
+ * at random, and enciphered with a fixed key through the rotor of
+ * crypt, so the true permutations are known.  Each engine is then run
+ * as its own program on the corpus with CBWWORKERS set to 1, 2, 4 ...
+ * up to the most workers asked for, and timed from outside.  An
+ * engine that does not use fanout, such as zeecode, is timed with
+ * one worker only and marked as one process in the output.  The
+ * workers are processes made by fanout, which share nothing and take
+ * no locks, so the time the workers were given but did not spend
+ * computing (idle) and the context switches stand in for contention.
+ * Peak RSS is that of the biggest process of a run, and the minor
+ * page faults count the fresh pages the run touched, which is the
+ * nearest measure of allocation that can be had from outside.
+ * Solve and cribmine -s also print the statistics of their arenas,
+ * which can be had by running them on the corpus by hand.  The
+ * corpus is made in an arena of its own, whose statistics are
+ * printed at the end.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<unistd.h>
+#include	<fcntl.h>
+#include	<sys/types.h>
+#include	<sys/stat.h>
+#include	<sys/time.h>
+#include	<sys/resource.h>
+#include	<sys/wait.h>
+#include	"window.h"
+#include	"specs.h"
+#include	"fanout.h"
+#include	"arena.h"
+#include	"rotor.h"
+
+
+#define	BNDIR		"bench.d"	/* Where the corpus is written. */
+#define	BNKEY		"farmkey"	/* Key the corpus is enciphered with. */
+#define	BNSEED		1984		/* Seed for drawing lines. */
+#define	BNBLOCKS	1024		/* Default blocks in the corpus. */
+#define	BNKNOWN		3			/* Blocks given to the knitter. */
+#define	BNMAXLINES	20000		/* Lines kept from the sample. */
+#define	BNSAMPLESZ	(1L << 20)	/* Bytes kept from the sample. */
+#define	BNMINWORD	4			/* Shortest word in the key search list. */
+#define	BNMAXWORDS	2000		/* Words in the key search list. */
+#define	BNNAMELEN	1000
+#define	NPERLINE	10			/* As in the .perm files of perm.c. */
+#define	NOWORDS		"-"			/* Pwords file name for no pwords. */
+
+#define	LETTERSTATS		"LETTERSTATS"
+#define	BIGRAMSTATS		"BIGRAMSTATS"
+#define	TRIGRAMSTATS	"TRIGRAMSTATS"
+#define	TRILETTERS		"mss.stats"		/* Files tri reads from here. */
+#define	TRITRIGRAMS		"trigrams.stats"
+
+
+/* How an engine is run. */
+#define	bnengine	struct xbnengine
+bnengine	{
+		char	*name;
+		char	*argv[6];		/* Program and arguments. */
+		char	*dir;			/* Directory to run in, or NULL. */
+		char	*input;			/* Standard input, or NULL. */
+		char	*unit;			/* What throughput is counted in. */
+		int		*count;			/* How many units a run does. */
+		int		(*ready)();		/* Sets up a run, FALSE to skip. */
+		int		parallel;		/* FALSE if it always runs in one process. */
+		};
+
+/* What one run cost. */
+#define	bnrun	struct xbnrun
+bnrun	{
+		int		workers;
+		int		status;			/* Exit status of the program. */
+		double	wall;			/* Seconds. */
+		double	cpu;			/* User and system seconds of all processes. */
+		long	maxrss;			/* Kilobytes. */
+		long	minflt;
+		long	nvcsw, nivcsw;	/* Voluntary and involuntary switches. */
+		};
+
+
+/* Forward declarations */
+void bn_usage(char *prog);
+void bn_corpus(char *samplefile);
+int bn_sample(char *samplefile, char *buf, char *lines[]);
+void bn_encipher(char *text, long len, char *cipher);
+void bn_words(char *text, long len, char *filename);
+void bn_write(char *filename, char *buf, long len);
+void bn_writeperms(char *filename, int known, int withzee);
+void bn_writeperm(FILE *fd, int perm[]);
+int bn_havestats(void);
+int bn_solveready(void);
+int bn_knitready(void);
+int bn_keysready(void);
+int bn_triready(void);
+int bn_always(void);
+void bn_measure(bnengine *eng, int workers, int repeats, bnrun *run);
+void bn_run(bnengine *eng, int workers, bnrun *run);
+void bn_report(bnengine *eng, bnrun runs[], int nruns, int csv);
+
+/* Global state. */
+char	progdir[BNNAMELEN+1];	/* Where the programs are. */
+int		nblocks = BNBLOCKS;		/* Blocks in the corpus. */
+int		nperms = NPERMS;		/* Blocks the workbench engines solve. */
+int		nkeywords;				/* Words in the key search list. */
+char	*bnroots[] = {BNDIR "/solve", BNDIR "/knit", BNDIR "/keys",
+		              BNDIR "/tri", NULL};
+arena	bnarena;				/* Space for making the corpus. */
+
+bnengine	bntab[] = {
+		{"solve", {"solve", BNDIR "/solve", "0", NOWORDS, NULL},
+		 NULL, NULL, "blocks", &nperms, bn_solveready, TRUE},
+		{"knit", {"solve", BNDIR "/knit", "0", NOWORDS, NULL},
+		 NULL, NULL, "blocks", &nperms, bn_knitready, TRUE},
+		{"zeecode", {"zeecode", NULL},
+		 BNDIR, "bench.cipher", "blocks", &nblocks, bn_always, FALSE},
+		{"keysrch", {"keysrch", BNDIR "/keys", BNDIR "/keys.words", NULL},
+		 NULL, NULL, "words", &nkeywords, bn_keysready, TRUE},
+		{"cribmine", {"cribmine", BNDIR "/bench.txt", NULL},
+		 NULL, NULL, "blocks", &nblocks, bn_always, TRUE},
+		{"tri", {"tri", BNDIR "/tri", "1.0", "10", "3", NULL},
+		 NULL, NULL, "blocks", &nperms, bn_triready, TRUE},
+		{NULL, {NULL}, NULL, NULL, NULL, NULL, NULL, FALSE},
+		};
+
+
+int main(argc, argv)
+int		argc;
+char	*argv[];
+{
+	int		i, csv, maxworkers, repeats, nruns, w;
+	char	*only;
+	bnengine	*eng;
+	bnrun	runs[FANMAX];
+
+	csv = FALSE;
+	maxworkers = fan_limit();
+	repeats = 1;
+	only = NULL;
+	for (i = 1 ; i < argc  &&  argv[i][0] == '-' ; i++)  {
+		if (strcmp(argv[i], "-c") == 0)
+			csv = TRUE;
+		else if (strcmp(argv[i], "-j") == 0  &&  i+1 < argc)
+			maxworkers = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-r") == 0  &&  i+1 < argc)
+			repeats = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-b") == 0  &&  i+1 < argc)
+			nblocks = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-e") == 0  &&  i+1 < argc)
+			only = argv[++i];
+		else
+			bn_usage(argv[0]);
+		}
+	if (i != argc - 1  ||  maxworkers < 1  ||  maxworkers > FANMAX
+	 || repeats < 1  ||  nblocks < NPERMS)
+		bn_usage(argv[0]);
+
+	if (getcwd(progdir, BNNAMELEN) == NULL)  {
+		printf("Could not find the current directory.\n");
+		exit(0);
+		}
+	bn_corpus(argv[i]);
+
+	if (csv)  {
+		printf("engine,workers,wall,throughput,unit,speedup,efficiency,");
+		printf("cpu,idle,maxrss_kb,minflt,nvcsw,nivcsw,status\n");
+		}
+	for (eng = bntab ; eng->name != NULL ; eng++)  {
+		if (only != NULL  &&  strcmp(only, eng->name) != 0)  continue;
+		if (!(*eng->ready)())  {
+			if (!csv)  printf("%s: skipped, see the usage.\n\n", eng->name);
+			continue;
+			}
+		nruns = 0;
+		for (w = 1 ; w < maxworkers  &&  eng->parallel ; w *= 2)
+			bn_measure(eng, w, repeats, &runs[nruns++]);
+		bn_measure(eng, eng->parallel ? maxworkers : 1, repeats,
+		           &runs[nruns++]);
+		bn_report(eng, runs, nruns, csv);
+		fflush(stdout);
+		}
+	if (!csv)  ar_report(stdout, "Corpus work space", &bnarena);
+	return 0;
+}
+
+
+/* Explain the arguments and exit.
+ */
+void bn_usage(char *prog)
+{
+	bnengine	*eng;
+
+	printf("Usage: %s [-c] [-j max_workers] [-r repeats] [-b blocks]", prog);
+	printf(" [-e engine] sample_text\n");
+	printf("\tMakes a corpus of blocks from the lines of sample_text in %s", BNDIR);
+	printf("\n\tand times each engine on it with 1, 2, 4 ... max_workers.");
+	printf("\n\tThe programs are run from the current directory.");
+	printf("\n\t-c prints comma separated values, -r keeps the fastest of");
+	printf(" repeats runs,");
+	printf("\n\t-e runs just one engine.  The engines are");
+	for (eng = bntab ; eng->name != NULL ; eng++)
+		printf(" %s", eng->name);
+	printf(".\n\tSolve and knit need the shell variables");
+	printf(" %s, %s and %s,", LETTERSTATS, BIGRAMSTATS, TRIGRAMSTATS);
+	printf("\n\ttri needs %s and %s here.\n", TRILETTERS, TRITRIGRAMS);
+	exit(0);
+}
+
+
+/* Make the corpus in BNDIR and the files each engine starts from.
+ */
+void bn_corpus(char *samplefile)
+{
+	char	*sample, *text, *cipher, *line;
+	char	*lines[BNMAXLINES];
+	long	len, n;
+	int		nlines, i;
+	char	filename[BNNAMELEN+1];
+
+	sample = ar_alloc(&bnarena, BNSAMPLESZ + 1);
+	len = ((long) nblocks) * BLOCKSIZE;
+	text = ar_alloc(&bnarena, len);
+	cipher = ar_alloc(&bnarena, len);
+	if ((nlines = bn_sample(samplefile, sample, lines)) == 0)  {
+		printf("There are no lines of text in %s.\n", samplefile);
+		exit(0);
+		}
+
+	srand(BNSEED);
+	for (n = 0 ; n < len ; )  {
+		line = lines[rand() % nlines];
+		for (i = 0 ; line[i] != 0  &&  n < len ; i++)
+			text[n++] = line[i];
+		}
+	bn_encipher(text, len, cipher);
+
+	if (mkdir(BNDIR, 0777) != 0  &&  access(BNDIR, W_OK) != 0)  {
+		printf("Could not make the directory %s.\n", BNDIR);
+		exit(0);
+		}
+	bn_write(BNDIR "/bench.txt", text, len);
+	bn_write(BNDIR "/bench.cipher", cipher, len);
+	for (i = 0 ; bnroots[i] != NULL ; i++)  {
+		sprintf(filename, "%s.cipher", bnroots[i]);
+		bn_write(filename, cipher, NPERMS*BLOCKSIZE);
+		sprintf(filename, "%s.txt", bnroots[i]);
+		bn_write(filename, text, NPERMS*BLOCKSIZE);
+		}
+	bn_writeperms(BNDIR "/zeecode.perm", NPERMS, TRUE);
+	bn_words(text, NPERMS*BLOCKSIZE, BNDIR "/keys.words");
+
+	ar_reset(&bnarena);
+}
+
+
+/* Read the lines of samplefile into buf, leaving out those with
+ * characters the workbench can't show, and point lines at them.
+ * Returns the number of lines.
+ */
+int bn_sample(char *samplefile, char *buf, char *lines[])
+{
+	FILE	*fd;
+	int		c, n, ok;
+	long	len, start;
+
+	if ((fd = fopen(samplefile, "r")) == NULL)  {
+		printf("Could not open %s to read sample text.\n", samplefile);
+		exit(0);
+		}
+	n = 0;
+	len = start = 0;
+	ok = TRUE;
+	while ((c = getc(fd)) != EOF  &&  len < BNSAMPLESZ  &&  n < BNMAXLINES)  {
+		buf[len++] = c;
+		if (c > MAXCHAR  ||  c == 0)  ok = FALSE;
+		if (c != '\n')  continue;
+		if (ok)  {
+			buf[len++] = 0;
+			lines[n++] = &buf[start];
+			}
+		else  {
+			len = start;
+			}
+		start = len;
+		ok = TRUE;
+		}
+	fclose(fd);
+	return(n);
+}
+
+
+/* Encipher len chars of text into cipher with the rotor of BNKEY,
+ * which does what crypt does to each block.
+ */
+void bn_encipher(char *text, long len, char *cipher)
+{
+	rotor	rot;
+	int		perm[ROTORSZ+1];
+	long	n;
+	int		pos;
+
+	rot_setup(BNKEY, &rot);
+	for (n = 0 ; n < len ; n++)  {
+		pos = n % BLOCKSIZE;
+		if (pos == 0)  rot_blockperm(&rot, (int) (n / BLOCKSIZE), perm);
+		cipher[n] = MODMASK & (perm[MODMASK & (text[n] + pos)] - pos);
+		}
+}
+
+
+/* Write a word list for the key search: the different words of
+ * text, then BNKEY, so every key but the last is tried.
+ */
+void bn_words(char *text, long len, char *filename)
+{
+	FILE	*fd;
+	char	*words[BNMAXWORDS];
+	long	n;
+	int		nwords, i, wlen;
+
+	nwords = 0;
+	for (n = 0 ; n < len  &&  nwords < BNMAXWORDS ; n += wlen + 1)  {
+		for (wlen = 0 ; n + wlen < len  &&  isletter(text[n+wlen]) ; wlen++);
+		if (wlen < BNMINWORD  ||  n + wlen >= len)  continue;
+		text[n+wlen] = 0;
+		for (i = 0 ; i < nwords  &&  strcmp(words[i], &text[n]) != 0 ; i++);
+		if (i == nwords)  {
+			words[nwords] = ar_alloc(&bnarena, wlen + 1);
+			strcpy(words[nwords++], &text[n]);
+			}
+		text[n+wlen] = ' ';
+		}
+
+	if ((fd = fopen(filename, "w")) == NULL)  {
+		printf("Could not open %s to write words.\n", filename);
+		exit(0);
+		}
+	for (i = 0 ; i < nwords ; i++)
+		fprintf(fd, "%s\n", words[i]);
+	fprintf(fd, "%s\n", BNKEY);
+	fclose(fd);
+	nkeywords = nwords + 1;
+}
+
+
+/* Write len chars of buf to filename.
+ */
+void bn_write(char *filename, char *buf, long len)
+{
+	FILE	*fd;
+
+	if ((fd = fopen(filename, "w")) == NULL
+	 || (long) fwrite(buf, 1, len, fd) != len)  {
+		printf("Could not write %s.\n", filename);
+		exit(0);
+		}
+	fclose(fd);
+}
+
+
+/* Write a .perm file with the true permutations of the first known
+ * blocks, and the true Zee if withzee is TRUE.  The rest is unknown.
+ */
+void bn_writeperms(char *filename, int known, int withzee)
+{
+	FILE	*fd;
+	rotor	rot;
+	int		perm[ROTORSZ+1];
+	int		b, x;
+
+	if ((fd = fopen(filename, "w")) == NULL)  {
+		printf("Could not open %s to write permutations.\n", filename);
+		exit(0);
+		}
+	rot_setup(BNKEY, &rot);
+	for (x = 0 ; x <= ROTORSZ ; x++)  perm[x] = NONE;
+	if (withzee)  rot_zee(&rot, perm);
+	bn_writeperm(fd, perm);
+	for (b = 0 ; b < NPERMS ; b++)  {
+		for (x = 0 ; x <= ROTORSZ ; x++)  perm[x] = NONE;
+		if (b < known)  rot_blockperm(&rot, b, perm);
+		bn_writeperm(fd, perm);
+		}
+	fclose(fd);
+}
+
+
+/* Write perm in the format of writeperm.
+ */
+void bn_writeperm(FILE *fd, int perm[])
+{
+	int		j;
+
+	for (j = 0 ; j < BLOCKSIZE ; j++)  {
+		fprintf(fd, "%3d ", perm[j]);
+		if ((j+1)%NPERLINE == 0)  fprintf(fd,"\n");
+		}
+	fprintf(fd,"\n");
+}
+
+
+/* Return TRUE if the statistics solve needs are named.
+ */
+int bn_havestats(void)
+{
+	return(getenv(LETTERSTATS) != NULL  &&  getenv(BIGRAMSTATS) != NULL
+	    && getenv(TRIGRAMSTATS) != NULL);
+}
+
+
+/* The solver starts from nothing.
+ */
+int bn_solveready(void)
+{
+	unlink(BNDIR "/solve.perm");
+	return(bn_havestats());
+}
+
+
+/* The solver is given a few solved blocks, so most of its time goes
+ * to knitting Zee and carrying the wires to the other blocks.
+ */
+int bn_knitready(void)
+{
+	bn_writeperms(BNDIR "/knit.perm", BNKNOWN, FALSE);
+	return(bn_havestats());
+}
+
+
+/* The key search is given the wires of the first block.
+ */
+int bn_keysready(void)
+{
+	bn_writeperms(BNDIR "/keys.perm", 1, FALSE);
+	return(TRUE);
+}
+
+
+/* The trigram guesser starts from nothing.
+ */
+int bn_triready(void)
+{
+	unlink(BNDIR "/tri.perm");
+	return(access(TRILETTERS, R_OK) == 0  &&  access(TRITRIGRAMS, R_OK) == 0);
+}
+
+
+int bn_always(void)
+{
+	return(TRUE);
+}
+
+
+/* Run eng with workers processes repeats times and keep the fastest.
+ */
+void bn_measure(bnengine *eng, int workers, int repeats, bnrun *run)
+{
+	bnrun	try;
+	int		i;
+
+	bn_run(eng, workers, run);
+	for (i = 1 ; i < repeats ; i++)  {
+		bn_run(eng, workers, &try);
+		if (try.wall < run->wall)  *run = try;
+		}
+}
+
+
+/* Run eng once with workers processes and fill in what it cost.
+ * The resource use returned by wait4 covers the program and all the
+ * processes it waited for.
+ */
+void bn_run(bnengine *eng, int workers, bnrun *run)
+{
+	struct	timeval		start, stop;
+	struct	rusage		ru;
+	char	path[2*BNNAMELEN+2];
+	char	num[20];
+	int		pid, status, fd;
+
+	(*eng->ready)();
+	sprintf(path, "%s/%s", progdir, eng->argv[0]);
+	sprintf(num, "%d", workers);
+	fflush(stdout);
+	gettimeofday(&start, NULL);
+
+	if ((pid = fork()) == 0)  {
+		setenv(FANVAR, num, 1);
+		if (eng->dir != NULL  &&  chdir(eng->dir) != 0)  _exit(126);
+		if (eng->input != NULL)  {
+			if ((fd = open(eng->input, O_RDONLY)) < 0)  _exit(126);
+			dup2(fd, 0);
+			close(fd);
+			}
+		if ((fd = open("/dev/null", O_WRONLY)) >= 0)  {
+			dup2(fd, 1);
+			close(fd);
+			}
+		execv(path, eng->argv);
+		_exit(127);
+		}
+	if (pid < 0)  {
+		printf("Could not fork to run %s.\n", path);
+		exit(0);
+		}
+	if (wait4(pid, &status, 0, &ru) != pid)  {
+		printf("Lost track of %s.\n", path);
+		exit(0);
+		}
+	gettimeofday(&stop, NULL);
+
+	run->workers = workers;
+	run->status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+	run->wall = (stop.tv_sec - start.tv_sec) + (stop.tv_usec - start.tv_usec) / 1e6;
+	run->cpu = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6
+	         + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+	run->maxrss = ru.ru_maxrss;
+	run->minflt = ru.ru_minflt;
+	run->nvcsw = ru.ru_nvcsw;
+	run->nivcsw = ru.ru_nivcsw;
+}
+
+
+/* Print the runs of eng as a table, or as comma separated values.
+ * Speedup is against the run with one worker.
+ */
+void bn_report(bnengine *eng, bnrun runs[], int nruns, int csv)
+{
+	bnrun	*r;
+	double	rate, speedup, idle;
+	int		i;
+
+	if (!csv)  {
+		printf("%s: %d %s per run%s\n", eng->name, *eng->count, eng->unit,
+		       eng->parallel ? "" : ", one process, not scaled");
+		printf("workers     wall  %s/s  speedup  effic.      cpu     idle",
+		       eng->unit);
+		printf("  rss(KB)   minflt    vcsw   ivcsw\n");
+		}
+	for (i = 0 ; i < nruns ; i++)  {
+		r = &runs[i];
+		rate = (r->wall > 0.0) ? *eng->count / r->wall : 0.0;
+		speedup = (r->wall > 0.0) ? runs[0].wall / r->wall : 0.0;
+		idle = r->wall * r->workers - r->cpu;
+		if (idle < 0.0)  idle = 0.0;
+		if (csv)  {
+			printf("%s,%d,%.3f,%.2f,%s,%.3f,%.3f,%.3f,%.3f,%ld,%ld,%ld,%ld,%d\n",
+			       eng->name, r->workers, r->wall, rate, eng->unit,
+			       speedup, speedup / r->workers, r->cpu, idle,
+			       r->maxrss, r->minflt, r->nvcsw, r->nivcsw, r->status);
+			continue;
+			}
+		printf("%7d %8.3f %*.1f %8.2f %7.2f %8.3f %8.3f %8ld %8ld %7ld %7ld",
+		       r->workers, r->wall, (int) strlen(eng->unit) + 4, rate,
+		       speedup, speedup / r->workers, r->cpu, idle,
+		       r->maxrss, r->minflt, r->nvcsw, r->nivcsw);
+		if (r->status != 0)  printf("  exit %d", r->status);
+		printf("\n");
+		}
+	if (!csv)  printf("\n");
+}
@@ -0,0 +1,677 @@
+/*
+ * Bitsliced DES for the makekey step of crypt(1).
+ *
+ * Makekey runs the old crypt(3): DES with the E expansion changed
+ * by a 12 bit salt, applied 25 times to a block of zeros.  Here each
+ * bit of the block is held in a word whose bit i belongs to key i,
+ * so every gate of DES is done for BSLANES keys by one operation.
+ * The keys differ in their salt as well, so the salted pairs of the
+ * E expansion are swapped by a mask of the keys whose salt bit is set.
+ *
+ * Each S box is written out as gates.  Two of its six input bits
+ * pick one of four functions of the other four, and each of those
+ * is the exclusive or of ands of the four bits (its algebraic
+ * normal form), which all the functions of the box share.  The
+ * forms were worked out from the S box tables of the standard, and
+ * the pair of bits for each box is the one that needs fewest gates.
+ * Bs_selftest checks the whole against crypt(3).
+ *
+ * The words are gcc vectors of BSWORDS 64 bit words, so this file
+ * is compiled with optimization even when the rest is not.
+ */
+
+#include	<stdio.h>
+#include	<string.h>
+#include	<stdint.h>
+#include	"rotor.h"
+#include	"bsdes.h"
+
+
+#define	BSROUNDS	16			/* Rounds of DES. */
+#define	BSITERS		25			/* DES encryptions in crypt(3). */
+#define	FALSE		0
+#define	TRUE		1
+
+typedef	uint64_t	bsword	__attribute__((vector_size(8*BSWORDS)));
+
+
+/* Forward declarations */
+void bs_tables(void);
+void bs_makekey(char keys[][ROTKEYLEN+1], int n, char bufs[][ROTCRYPTLEN+1]);
+void bs_des(bsword *kb, bsword *sm, bsword *out);
+void bs_round(bsword *lp, bsword *rp, bsword *kb, bsword *sm, int r);
+void bs_s1(bsword *in, bsword *out);
+void bs_s2(bsword *in, bsword *out);
+void bs_s3(bsword *in, bsword *out);
+void bs_s4(bsword *in, bsword *out);
+void bs_s5(bsword *in, bsword *out);
+void bs_s6(bsword *in, bsword *out);
+void bs_s7(bsword *in, bsword *out);
+void bs_s8(bsword *in, bsword *out);
+int bs_selftest(void);
+
+
+/* The tables of DES, numbered from 1 as in the standard. */
+int	bsE[48] = {
+		32,  1,  2,  3,  4,  5,   4,  5,  6,  7,  8,  9,
+		 8,  9, 10, 11, 12, 13,  12, 13, 14, 15, 16, 17,
+		16, 17, 18, 19, 20, 21,  20, 21, 22, 23, 24, 25,
+		24, 25, 26, 27, 28, 29,  28, 29, 30, 31, 32,  1};
+
+int	bsP[32] = {
+		16,  7, 20, 21, 29, 12, 28, 17,   1, 15, 23, 26,  5, 18, 31, 10,
+		 2,  8, 24, 14, 32, 27,  3,  9,  19, 13, 30,  6, 22, 11,  4, 25};
+
+int	bsFP[64] = {
+		40,  8, 48, 16, 56, 24, 64, 32,  39,  7, 47, 15, 55, 23, 63, 31,
+		38,  6, 46, 14, 54, 22, 62, 30,  37,  5, 45, 13, 53, 21, 61, 29,
+		36,  4, 44, 12, 52, 20, 60, 28,  35,  3, 43, 11, 51, 19, 59, 27,
+		34,  2, 42, 10, 50, 18, 58, 26,  33,  1, 41,  9, 49, 17, 57, 25};
+
+int	bsPC1[56] = {
+		57, 49, 41, 33, 25, 17,  9,   1, 58, 50, 42, 34, 26, 18,
+		10,  2, 59, 51, 43, 35, 27,  19, 11,  3, 60, 52, 44, 36,
+		63, 55, 47, 39, 31, 23, 15,   7, 62, 54, 46, 38, 30, 22,
+		14,  6, 61, 53, 45, 37, 29,  21, 13,  5, 28, 20, 12,  4};
+
+int	bsPC2[48] = {
+		14, 17, 11, 24,  1,  5,   3, 28, 15,  6, 21, 10,
+		23, 19, 12,  4, 26,  8,  16,  7, 27, 20, 13,  2,
+		41, 52, 31, 37, 47, 55,  30, 40, 51, 45, 33, 48,
+		44, 49, 39, 56, 34, 53,  46, 42, 50, 36, 29, 32};
+
+int	bsshifts[BSROUNDS] = {1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1};
+
+/* Chars of the crypt(3) output, in order of their six bit value. */
+char	bsitoa64[] =
+	"./0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+
+/* Tables made by bs_tables. */
+int		bsready = FALSE;
+int		bskeyidx[BSROUNDS][48];		/* Key bit of each subkey bit. */
+
+
+/* Work out the key bit of each subkey bit.
+ */
+void bs_tables(void)
+{
+	int		cd[56];
+	int		r, i, n, c;
+
+	for (i = 0 ; i < 56 ; i++)  cd[i] = bsPC1[i] - 1;
+	for (r = 0 ; r < BSROUNDS ; r++)  {
+		for (n = 0 ; n < bsshifts[r] ; n++)  {
+			c = cd[0];
+			for (i = 0 ; i < 27 ; i++)  cd[i] = cd[i+1];
+			cd[27] = c;
+			c = cd[28];
+			for (i = 28 ; i < 55 ; i++)  cd[i] = cd[i+1];
+			cd[55] = c;
+			}
+		for (i = 0 ; i < 48 ; i++)  bskeyidx[r][i] = cd[bsPC2[i] - 1];
+		}
+
+	bsready = TRUE;
+}
+
+
+/* Put in bufs[i] what rot_makekey puts in its buf for keys[i],
+ * for i from 0 to n-1.  N must be at most BSLANES.
+ */
+void bs_makekey(char keys[][ROTKEYLEN+1], int n, char bufs[][ROTCRYPTLEN+1])
+{
+	bsword	kb[64];			/* Bits of the DES key. */
+	bsword	sm[12];			/* Keys with each salt bit set. */
+	bsword	out[64];
+	char	kbuf[ROTKEYLEN+1];
+	int		l, i, j, c, v, w;
+	uint64_t	bit;
+	bsword	zero = {0};
+
+	if (!bsready)  bs_tables();
+	for (i = 0 ; i < 64 ; i++)  kb[i] = zero;
+	for (i = 0 ; i < 12 ; i++)  sm[i] = zero;
+
+	for (l = 0 ; l < n ; l++)  {
+		w = l >> 6;
+		bit = ((uint64_t) 1) << (l & 63);
+		strncpy(kbuf, keys[l], ROTKEYLEN);
+		kbuf[ROTKEYLEN] = '\0';
+		for (i = 0 ; i < ROTKEYLEN  &&  kbuf[i] != '\0' ; i++)
+			for (j = 0 ; j < 7 ; j++)
+				if ((kbuf[i] >> (6 - j)) & 1)  kb[8*i + j][w] |= bit;
+		for (i = 0 ; i < ROTSALTLEN ; i++)  {
+			c = kbuf[i];
+			if (c > 'Z')  c -= 6;
+			if (c > '9')  c -= 7;
+			c -= '.';
+			for (j = 0 ; j < 6 ; j++)
+				if ((c >> j) & 1)  sm[6*i + j][w] |= bit;
+			}
+		}
+
+	bs_des(kb, sm, out);
+
+	for (l = 0 ; l < n ; l++)  {
+		w = l >> 6;
+		bit = ((uint64_t) 1) << (l & 63);
+		strncpy(kbuf, keys[l], ROTKEYLEN);
+		for (i = 0 ; i < ROTSALTLEN ; i++)  bufs[l][i] = kbuf[i];
+		for (i = 0 ; i < ROTCRYPTLEN - ROTSALTLEN ; i++)  {
+			v = 0;
+			for (j = 6*i ; j < 6*i + 6 ; j++)
+				v = (v << 1) | (j < 64  &&  (out[j][w] & bit) != 0);
+			bufs[l][ROTSALTLEN + i] = bsitoa64[v];
+			}
+		bufs[l][ROTCRYPTLEN] = '\0';
+		}
+}
+
+
+/* Encrypt a block of zeros BSITERS times with the keys in kb and the
+ * salts in sm, and put the result in out.  The initial permutation
+ * of each encryption undoes the final one of the last, so only the
+ * last is done.
+ */
+void bs_des(bsword *kb, bsword *sm, bsword *out)
+{
+	bsword	lr[64];			/* The left half, then the right half. */
+	bsword	*lp, *rp, *tp;
+	bsword	zero = {0};
+	int		i, r;
+
+	for (i = 0 ; i < 64 ; i++)  lr[i] = zero;
+	lp = &lr[0];
+	rp = &lr[32];
+	for (i = 0 ; i < BSITERS ; i++)  {
+		for (r = 0 ; r < BSROUNDS ; r++)  {
+			bs_round(lp, rp, kb, sm, r);
+			tp = lp;  lp = rp;  rp = tp;
+			}
+		tp = lp;  lp = rp;  rp = tp;
+		}
+	for (i = 0 ; i < 64 ; i++)
+		out[i] = (bsFP[i] <= 32) ? lp[bsFP[i] - 1] : rp[bsFP[i] - 33];
+}
+
+
+/* Do round r: xor f(right half, subkey r) into the left half.
+ */
+void bs_round(bsword *lp, bsword *rp, bsword *kb, bsword *sm, int r)
+{
+	bsword	e[48], o[32];
+	bsword	a, b, t;
+	int		i;
+
+	for (i = 0 ; i < 12 ; i++)  {
+		a = rp[bsE[i] - 1];
+		b = rp[bsE[i+24] - 1];
+		t = (a ^ b) & sm[i];
+		e[i] = a ^ t;
+		e[i+24] = b ^ t;
+		}
+	for (i = 12 ; i < 24 ; i++)  {
+		e[i] = rp[bsE[i] - 1];
+		e[i+24] = rp[bsE[i+24] - 1];
+		}
+	for (i = 0 ; i < 48 ; i++)  e[i] ^= kb[bskeyidx[r][i]];
+	bs_s1(&e[0], &o[0]);
+	bs_s2(&e[6], &o[4]);
+	bs_s3(&e[12], &o[8]);
+	bs_s4(&e[18], &o[12]);
+	bs_s5(&e[24], &o[16]);
+	bs_s6(&e[30], &o[20]);
+	bs_s7(&e[36], &o[24]);
+	bs_s8(&e[42], &o[28]);
+	for (i = 0 ; i < 32 ; i++)  lp[i] ^= o[bsP[i] - 1];
+}
+
+
+/* S box 1, with one of four functions picked by in[0] and in[1]. */
+void bs_s1(bsword *in, bsword *out)
+{
+	bsword	a, b, c, d, ab, ac, ad, bc, bd, cd, abc, abd, acd, bcd, abcd;
+	bsword	g0, g1, g2, g3, lo, hi;
+
+	a = in[2];  b = in[3];  c = in[4];  d = in[5];
+	ab = a & b;
+	ac = a & c;
+	ad = a & d;
+	bc = b & c;
+	bd = b & d;
+	cd = c & d;
+	abc = ab & c;
+	abd = ab & d;
+	acd = ac & d;
+	bcd = bc & d;
+	abcd = abc & d;
+
+	g0 = ~(a ^ c ^ d ^ ab ^ abc ^ abd ^ bcd);
+	g1 = c ^ d ^ abc ^ abd ^ bcd;
+	g2 = a ^ b ^ d ^ ac ^ bd ^ bcd;
+	g3 = ~(a ^ d ^ ac ^ bc ^ cd ^ abd ^ acd ^ bcd);
+	lo = g0 ^ ((g0 ^ g1) & in[1]);
+	hi = g2 ^ ((g2 ^ g3) & in[1]);
+	out[0] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = ~(a ^ d ^ ac ^ bc ^ bd ^ cd ^ abd ^ acd ^ abcd);
+	g1 = a ^ b ^ ac ^ ad ^ cd ^ abd ^ acd ^ abcd;
+	g2 = ~(c ^ ab ^ ac ^ bd ^ cd ^ abd);
+	g3 = ~(a ^ b ^ bc ^ cd ^ acd ^ bcd);
+	lo = g0 ^ ((g0 ^ g1) & in[1]);
+	hi = g2 ^ ((g2 ^ g3) & in[1]);
+	out[1] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = ~(b ^ c ^ d ^ ab ^ ac ^ ad ^ bc ^ abd ^ bcd);
+	g1 = ~(a ^ bc ^ bd);
+	g2 = b ^ d ^ ac ^ ad ^ bc ^ cd ^ abd ^ bcd ^ abcd;
+	g3 = ~(b ^ c ^ d ^ ac ^ ad ^ abd ^ acd ^ bcd ^ abcd);
+	lo = g0 ^ ((g0 ^ g1) & in[1]);
+	hi = g2 ^ ((g2 ^ g3) & in[1]);
+	out[2] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = b ^ ac ^ cd;
+	g1 = ~(b ^ c ^ d ^ ac ^ ad ^ bc ^ bd ^ cd ^ acd);
+	g2 = a ^ c ^ d ^ ab ^ bc ^ bd ^ abc ^ abd ^ abcd;
+	g3 = ~(c ^ ad ^ bc ^ cd ^ abc ^ abcd);
+	lo = g0 ^ ((g0 ^ g1) & in[1]);
+	hi = g2 ^ ((g2 ^ g3) & in[1]);
+	out[3] = lo ^ ((lo ^ hi) & in[0]);
+}
+
+
+/* S box 2, with one of four functions picked by in[0] and in[1]. */
+void bs_s2(bsword *in, bsword *out)
+{
+	bsword	a, b, c, d, ab, ac, ad, bc, bd, cd, abc, abd, acd, bcd, abcd;
+	bsword	g0, g1, g2, g3, lo, hi;
+
+	a = in[2];  b = in[3];  c = in[4];  d = in[5];
+	ab = a & b;
+	ac = a & c;
+	ad = a & d;
+	bc = b & c;
+	bd = b & d;
+	cd = c & d;
+	abc = ab & c;
+	abd = ab & d;
+	acd = ac & d;
+	bcd = bc & d;
+	abcd = abc & d;
+
+	g0 = ~(a ^ c ^ d ^ bc);
+	g1 = ~(b ^ c ^ ad);
+	g2 = a ^ c ^ d ^ cd ^ acd ^ bcd;
+	g3 = a ^ b ^ c ^ d ^ acd;
+	lo = g0 ^ ((g0 ^ g1) & in[1]);
+	hi = g2 ^ ((g2 ^ g3) & in[1]);
+	out[0] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = ~(b ^ c ^ d ^ ad ^ bcd ^ abcd);
+	g1 = a ^ c ^ d ^ ad ^ bd ^ bcd ^ abcd;
+	g2 = b ^ c ^ d ^ ad ^ bcd ^ abcd;
+	g3 = ~(a ^ c ^ d ^ ac ^ ad ^ bc ^ bd ^ acd ^ abcd);
+	lo = g0 ^ ((g0 ^ g1) & in[1]);
+	hi = g2 ^ ((g2 ^ g3) & in[1]);
+	out[1] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = ~(b ^ c ^ ab ^ ac ^ abc ^ abd);
+	g1 = b ^ c ^ ab ^ ac ^ ad ^ bd ^ cd ^ abc ^ abd ^ bcd;
+	g2 = a ^ b ^ c ^ bc ^ cd;
+	g3 = d ^ ab ^ ac ^ ad ^ bc ^ acd;
+	lo = g0 ^ ((g0 ^ g1) & in[1]);
+	hi = g2 ^ ((g2 ^ g3) & in[1]);
+	out[2] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = ~(a ^ b ^ ac ^ ad ^ bcd);
+	g1 = ~(a ^ b ^ d ^ ad ^ bc ^ acd);
+	g2 = b ^ d ^ cd ^ acd;
+	g3 = ~(b ^ c ^ ac ^ ad ^ bc ^ bd ^ acd ^ bcd);
+	lo = g0 ^ ((g0 ^ g1) & in[1]);
+	hi = g2 ^ ((g2 ^ g3) & in[1]);
+	out[3] = lo ^ ((lo ^ hi) & in[0]);
+}
+
+
+/* S box 3, with one of four functions picked by in[0] and in[4]. */
+void bs_s3(bsword *in, bsword *out)
+{
+	bsword	a, b, c, d, ab, ac, ad, bc, bd, cd, abc, abd, acd, bcd, abcd;
+	bsword	g0, g1, g2, g3, lo, hi;
+
+	a = in[1];  b = in[2];  c = in[3];  d = in[5];
+	ab = a & b;
+	ac = a & c;
+	ad = a & d;
+	bc = b & c;
+	bd = b & d;
+	cd = c & d;
+	abc = ab & c;
+	abd = ab & d;
+	acd = ac & d;
+	bcd = bc & d;
+	abcd = abc & d;
+
+	g0 = ~(a ^ b ^ ac ^ bc ^ cd ^ abc);
+	g1 = a ^ c ^ ab ^ bc ^ abc ^ abd ^ acd ^ bcd;
+	g2 = ~(c ^ d ^ ab);
+	g3 = b ^ c ^ d ^ bd ^ abd;
+	lo = g0 ^ ((g0 ^ g1) & in[4]);
+	hi = g2 ^ ((g2 ^ g3) & in[4]);
+	out[0] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = b ^ d ^ ab ^ ac ^ ad ^ cd ^ abc ^ abd ^ acd;
+	g1 = a ^ c ^ d ^ ac ^ abc ^ acd;
+	g2 = ~(a ^ b ^ d ^ cd ^ acd);
+	g3 = ~(a ^ c ^ d ^ cd ^ acd ^ bcd);
+	lo = g0 ^ ((g0 ^ g1) & in[4]);
+	hi = g2 ^ ((g2 ^ g3) & in[4]);
+	out[1] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = ~(a ^ c ^ d ^ ab ^ ac ^ bc ^ bd ^ cd ^ abc ^ abd ^ bcd ^ abcd);
+	g1 = b ^ c ^ d ^ ab ^ ad ^ abc ^ abd ^ abcd;
+	g2 = a ^ ab ^ ad ^ bc ^ bd ^ abd ^ acd;
+	g3 = ~(a ^ c ^ ab ^ ac ^ ad ^ bd ^ abd);
+	lo = g0 ^ ((g0 ^ g1) & in[4]);
+	hi = g2 ^ ((g2 ^ g3) & in[4]);
+	out[2] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = a ^ c ^ d;
+	g1 = a ^ b ^ d;
+	g2 = ~(b ^ c ^ ab ^ ad ^ cd ^ abd ^ abcd);
+	g3 = a ^ b ^ c ^ cd ^ abd ^ abcd;
+	lo = g0 ^ ((g0 ^ g1) & in[4]);
+	hi = g2 ^ ((g2 ^ g3) & in[4]);
+	out[3] = lo ^ ((lo ^ hi) & in[0]);
+}
+
+
+/* S box 4, with one of four functions picked by in[0] and in[5]. */
+void bs_s4(bsword *in, bsword *out)
+{
+	bsword	a, b, c, d, ab, ac, ad, bc, bd, cd, abc, abd, acd, bcd;
+	bsword	g0, g1, g2, g3, lo, hi;
+
+	a = in[1];  b = in[2];  c = in[3];  d = in[4];
+	ab = a & b;
+	ac = a & c;
+	ad = a & d;
+	bc = b & c;
+	bd = b & d;
+	cd = c & d;
+	abc = ab & c;
+	abd = ab & d;
+	acd = ac & d;
+	bcd = bc & d;
+
+	g0 = c ^ d ^ ab ^ ad ^ bd ^ abd ^ acd;
+	g1 = ~(a ^ b ^ ab ^ bd ^ cd ^ abc);
+	g2 = ~(d ^ ab ^ ac ^ bc ^ bd ^ abc ^ bcd);
+	g3 = a ^ b ^ d ^ ab ^ ac ^ cd ^ acd;
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[0] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = ~(a ^ b ^ ab ^ bd ^ cd ^ abc);
+	g1 = ~(c ^ d ^ ab ^ ad ^ bd ^ abd ^ acd);
+	g2 = a ^ b ^ d ^ ab ^ ac ^ cd ^ acd;
+	g3 = d ^ ab ^ ac ^ bc ^ bd ^ abc ^ bcd;
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[1] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = ~(a ^ b ^ d ^ cd ^ abc ^ bcd);
+	g1 = b ^ c ^ ab ^ ad ^ cd ^ acd;
+	g2 = ~(b ^ c ^ ac ^ ad ^ bd ^ abd ^ acd);
+	g3 = ~(a ^ c ^ ac ^ bd ^ cd ^ abc);
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[2] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = ~(b ^ c ^ ab ^ ad ^ cd ^ acd);
+	g1 = ~(a ^ b ^ d ^ cd ^ abc ^ bcd);
+	g2 = a ^ c ^ ac ^ bd ^ cd ^ abc;
+	g3 = ~(b ^ c ^ ac ^ ad ^ bd ^ abd ^ acd);
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[3] = lo ^ ((lo ^ hi) & in[0]);
+}
+
+
+/* S box 5, with one of four functions picked by in[0] and in[5]. */
+void bs_s5(bsword *in, bsword *out)
+{
+	bsword	a, b, c, d, ab, ac, ad, bc, bd, cd, abc, abd, acd, bcd;
+	bsword	g0, g1, g2, g3, lo, hi;
+
+	a = in[1];  b = in[2];  c = in[3];  d = in[4];
+	ab = a & b;
+	ac = a & c;
+	ad = a & d;
+	bc = b & c;
+	bd = b & d;
+	cd = c & d;
+	abc = ab & c;
+	abd = ab & d;
+	acd = ac & d;
+	bcd = bc & d;
+
+	g0 = a ^ d ^ ac ^ bc ^ cd ^ acd ^ bcd;
+	g1 = ~(a ^ b ^ c ^ ab ^ cd ^ abd ^ acd);
+	g2 = a ^ b ^ bc ^ cd ^ abc;
+	g3 = ~(a ^ b ^ ad ^ bd ^ cd ^ abc ^ abd ^ acd ^ bcd);
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[0] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = b ^ c ^ d ^ ac;
+	g1 = ~(c ^ d ^ ab ^ ac ^ bc ^ bd ^ abc ^ bcd);
+	g2 = ~(b ^ c ^ d ^ ab ^ ac ^ cd ^ abc ^ bcd);
+	g3 = a ^ c ^ ab ^ bc ^ bd ^ abc;
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[1] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = ~(a ^ c ^ d ^ ad ^ bc ^ bd ^ cd ^ abc ^ abd ^ acd ^ bcd);
+	g1 = ~(a ^ b ^ ac ^ bd ^ cd ^ acd);
+	g2 = a ^ b ^ d ^ ab ^ ac ^ abd ^ acd;
+	g3 = ~(b ^ c ^ d ^ ab ^ ad ^ abd);
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[2] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = b ^ ac ^ ad ^ bd ^ cd ^ abd ^ bcd;
+	g1 = a ^ d ^ bc ^ cd ^ abd ^ acd;
+	g2 = a ^ c ^ ab ^ bd ^ abc ^ acd;
+	g3 = ~(a ^ c ^ d ^ ac ^ abc ^ abd);
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[3] = lo ^ ((lo ^ hi) & in[0]);
+}
+
+
+/* S box 6, with one of four functions picked by in[0] and in[2]. */
+void bs_s6(bsword *in, bsword *out)
+{
+	bsword	a, b, c, d, ab, ac, ad, bc, bd, cd, abc, abd, acd, bcd, abcd;
+	bsword	g0, g1, g2, g3, lo, hi;
+
+	a = in[1];  b = in[3];  c = in[4];  d = in[5];
+	ab = a & b;
+	ac = a & c;
+	ad = a & d;
+	bc = b & c;
+	bd = b & d;
+	cd = c & d;
+	abc = ab & c;
+	abd = ab & d;
+	acd = ac & d;
+	bcd = bc & d;
+	abcd = abc & d;
+
+	g0 = ~(a ^ c ^ bc ^ bd ^ cd ^ bcd);
+	g1 = ~(b ^ c ^ d ^ abd);
+	g2 = ~(a ^ d ^ bc ^ abd ^ abcd);
+	g3 = b ^ c ^ d ^ ad ^ bd ^ abd ^ acd ^ bcd ^ abcd;
+	lo = g0 ^ ((g0 ^ g1) & in[2]);
+	hi = g2 ^ ((g2 ^ g3) & in[2]);
+	out[0] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = ~(a ^ b ^ c ^ d ^ ab ^ abcd);
+	g1 = a ^ b ^ d ^ ab ^ bc ^ abcd;
+	g2 = a ^ b ^ c ^ d ^ ab ^ bc ^ abc ^ bcd ^ abcd;
+	g3 = b ^ ab ^ ac ^ ad ^ bc ^ cd ^ abc ^ abd ^ acd ^ bcd ^ abcd;
+	lo = g0 ^ ((g0 ^ g1) & in[2]);
+	hi = g2 ^ ((g2 ^ g3) & in[2]);
+	out[1] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = b ^ d ^ abc ^ acd ^ bcd;
+	g1 = a ^ b ^ c ^ d ^ ac ^ abc ^ acd ^ bcd;
+	g2 = a ^ b ^ c ^ acd ^ abcd;
+	g3 = ~(a ^ b ^ c ^ d ^ ac ^ cd ^ abcd);
+	lo = g0 ^ ((g0 ^ g1) & in[2]);
+	hi = g2 ^ ((g2 ^ g3) & in[2]);
+	out[2] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = c ^ ab ^ bcd ^ abcd;
+	g1 = ~(a ^ b ^ c ^ bc ^ bd ^ abd ^ abcd);
+	g2 = ~(c ^ d ^ ab ^ ad ^ bc ^ abd);
+	g3 = a ^ d ^ bc;
+	lo = g0 ^ ((g0 ^ g1) & in[2]);
+	hi = g2 ^ ((g2 ^ g3) & in[2]);
+	out[3] = lo ^ ((lo ^ hi) & in[0]);
+}
+
+
+/* S box 7, with one of four functions picked by in[0] and in[5]. */
+void bs_s7(bsword *in, bsword *out)
+{
+	bsword	a, b, c, d, ab, ac, ad, bc, bd, cd, abc, abd, acd, bcd;
+	bsword	g0, g1, g2, g3, lo, hi;
+
+	a = in[1];  b = in[2];  c = in[3];  d = in[4];
+	ab = a & b;
+	ac = a & c;
+	ad = a & d;
+	bc = b & c;
+	bd = b & d;
+	cd = c & d;
+	abc = ab & c;
+	abd = ab & d;
+	acd = ac & d;
+	bcd = bc & d;
+
+	g0 = b ^ d ^ ab ^ ac ^ abc ^ bcd;
+	g1 = ~(b ^ d ^ ac);
+	g2 = a ^ b ^ c ^ bd ^ abd ^ acd;
+	g3 = a ^ c ^ d ^ bd ^ cd ^ abd ^ acd;
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[0] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = ~(a ^ c ^ d ^ ab ^ ac);
+	g1 = ~(c ^ d ^ ab ^ ac ^ acd ^ bcd);
+	g2 = b ^ d ^ ab ^ ac ^ abc ^ bcd;
+	g3 = ~(a ^ b ^ d ^ abc);
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[1] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = a ^ b ^ c ^ d ^ cd ^ acd;
+	g1 = a ^ c ^ bc ^ abc ^ bcd;
+	g2 = a ^ c ^ ab ^ ac ^ bd ^ cd ^ abd;
+	g3 = ~(a ^ b ^ c ^ ac ^ acd);
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[2] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = a ^ b ^ d ^ ab ^ bc ^ cd ^ bcd;
+	g1 = ~(a ^ b ^ d ^ ab ^ ac ^ bc ^ cd ^ acd ^ bcd);
+	g2 = ~(a ^ b ^ d ^ ab ^ bc ^ cd ^ bcd);
+	g3 = a ^ b ^ c ^ d ^ ad ^ acd;
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[3] = lo ^ ((lo ^ hi) & in[0]);
+}
+
+
+/* S box 8, with one of four functions picked by in[0] and in[5]. */
+void bs_s8(bsword *in, bsword *out)
+{
+	bsword	a, b, c, d, ab, ac, ad, bc, bd, cd, abc, abd, acd, bcd;
+	bsword	g0, g1, g2, g3, lo, hi;
+
+	a = in[1];  b = in[2];  c = in[3];  d = in[4];
+	ab = a & b;
+	ac = a & c;
+	ad = a & d;
+	bc = b & c;
+	bd = b & d;
+	cd = c & d;
+	abc = ab & c;
+	abd = ab & d;
+	acd = ac & d;
+	bcd = bc & d;
+
+	g0 = ~(b ^ d ^ ac ^ ad ^ bc ^ abc ^ acd);
+	g1 = a ^ b ^ c ^ d ^ cd ^ acd;
+	g2 = b ^ d ^ ac ^ ad ^ bd ^ cd ^ acd;
+	g3 = a ^ c ^ ab ^ ac ^ bd ^ cd ^ abd;
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[0] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = ~(a ^ c ^ d ^ ab ^ ac ^ ad ^ bd ^ acd);
+	g1 = a ^ c ^ d ^ ab ^ ac ^ ad ^ bd ^ acd;
+	g2 = ~(a ^ b ^ d ^ bc ^ abc);
+	g3 = a ^ b ^ c ^ bd;
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[1] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = a ^ b ^ d ^ bd ^ cd;
+	g1 = b ^ d ^ ab ^ ac ^ ad ^ bd ^ cd ^ abc ^ acd;
+	g2 = ~(a ^ b ^ c ^ ad ^ abd);
+	g3 = ~(b ^ d ^ ab ^ ac ^ cd ^ abc);
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[2] = lo ^ ((lo ^ hi) & in[0]);
+
+	g0 = ~(a ^ b ^ c ^ d ^ cd ^ acd);
+	g1 = ~(a ^ b ^ ab ^ ad ^ bc ^ bd ^ cd ^ acd ^ bcd);
+	g2 = ~(a ^ c ^ ab ^ ac ^ bd ^ cd ^ abd);
+	g3 = a ^ d ^ bd ^ abc ^ bcd;
+	lo = g0 ^ ((g0 ^ g1) & in[5]);
+	hi = g2 ^ ((g2 ^ g3) & in[5]);
+	out[3] = lo ^ ((lo ^ hi) & in[0]);
+}
+
+
+/* Compare bs_makekey with rot_makekey, which calls crypt(3), on
+ * BSLANES keys of every length.  Returns TRUE if they all agree.
+ */
+int bs_selftest(void)
+{
+	char	keys[BSLANES][ROTKEYLEN+1];
+	char	bufs[BSLANES][ROTCRYPTLEN+1];
+	char	buf[ROTCRYPTLEN+1];
+	unsigned	seed;
+	int		l, i, len;
+
+	seed = 1;
+	for (l = 0 ; l < BSLANES ; l++)  {
+		len = l % (ROTKEYLEN + 1);
+		for (i = 0 ; i < len ; i++)  {
+			seed = 1103515245 * seed + 12345;
+			keys[l][i] = '!' + (seed >> 16) % ('~' - '!' + 1);
+			}
+		keys[l][len] = '\0';
+		}
+	bs_makekey(keys, BSLANES, bufs);
+	for (l = 0 ; l < BSLANES ; l++)  {
+		rot_makekey(keys[l], buf);
+		if (memcmp(buf, bufs[l], ROTCRYPTLEN+1) != 0)  return(FALSE);
+		}
+	return(TRUE);
+}
@@ -0,0 +1,21 @@
+#ifndef __BSDES_H
+#define __BSDES_H
+
+/*
+ * Declarations for the bitsliced DES of makekey.
+ *
+ * Makekey is crypt(3) of the key with the salt taken from the key,
+ * and is most of the cost of trying a key.  Bit i of every word of
+ * the bitsliced DES belongs to key i, so one pass computes the
+ * makekey output of BSLANES keys, each with its own salt.
+ */
+
+
+#define	BSWORDS		4			/* 64 bit words in a bitsliced word. */
+#define	BSLANES		(64*BSWORDS)	/* Keys done at once. */
+
+
+extern	void	bs_makekey(/* keys, n, bufs */);	/* As rot_makekey for n keys. */
+extern	int		bs_selftest(/* */);		/* TRUE if it agrees with crypt(3). */
+
+#endif /* __BSDES_H */
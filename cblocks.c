@@ -23,9 +23,14 @@
 /* Input file name for ciphertext, set by main. */
 char	*cipherfile;
 
+/* Byte offset in cipherfile where the crypt output starts.
+ * Non-zero when the ciphertext is preceded by a header.
+ */
+long	cipheroffset = 0;
+
 
 /* Fill the given buffer with the i-th ciphertext block.
- * The block index is zero-based.
+ * The block index is zero-based and counted from cipheroffset.
  * Return FALSE if try to read non-existant bytes.
  */
 int	fillcbuf(blocknum, cbuf)
@@ -43,7 +48,7 @@ char	*cbuf;
 		exit(0);
 		}
 
-	offset = blocknum * BLOCKSIZE;
+	offset = cipheroffset + ((long) blocknum) * BLOCKSIZE;
 	fseek(fd, offset, FROMSTART);
 	res = ftell(fd);
 	if (res != offset) {
@@ -52,6 +57,7 @@ char	*cbuf;
 		}
 
 	if (fread(cbuf,sizeof(*(cbuf)),BLOCKSIZE,fd) != BLOCKSIZE)  {
+		fclose(fd);
 		return(FALSE);
 		}
 
@@ -323,24 +323,44 @@ int		pos;
 perment	permvec[];
 {
 	int		wcount;
-	int		i, c;
+
+	wcount = permvec_add_string(eci, str, pos, permvec, 0);
+	if (wcount == ERROR)  permvec[0].x = NONE;
+	return(wcount);
+}
+
+
+/* Like permvec_from_string, but adds the wires for str at pos to
+ * the wcount wires already in permvec, so a guess can be built up a
+ * piece at a time.  Returns the new number of wires, or ERROR if str
+ * conflicts with eci->perm or with the wires already there, in which
+ * case the first wcount entries are left alone.
+ */
+int		permvec_add_string(eci, str, pos, permvec, wcount)
+ecinfo	*eci;
+char	*str;
+int		pos;
+perment	permvec[];
+int		wcount;
+{
+	int		i, c, n;
 	int		x,y;
 	char	*cp;
 	int		curpos;
 
 	if (pos < 0 || pos >= BLOCKSIZE)  {return(ERROR);}
 
-	wcount = 0;
+	n = wcount;
 	curpos = pos;
 	cp = str;
 	while ((c = (*cp & MODMASK)) != 0  &&  (curpos < BLOCKSIZE))  {
 		x = eci->scipher[curpos];
 		y = MODMASK & (c + curpos);
 		if (perm_conflict(eci->perm, x, y))  {
-			permvec[0].x = NONE;
+			permvec[wcount].x = NONE;
 			return(ERROR);
 			}
-		for (i = 0 ; i < wcount ; i++) {
+		for (i = 0 ; i < n ; i++) {
 			if ( (permvec[i].x == x  &&  permvec[i].y != y)
 			  || (permvec[i].x == y  &&  permvec[i].y != x)
 			  || (permvec[i].y == x  &&  permvec[i].x != y)
@@ -348,22 +368,24 @@ perment	permvec[];
 #if DEBUG
 				printf("Conflict within permvec.\n");
 #endif
-				permvec[0].x = NONE;
+				permvec[wcount].x = NONE;
 				return(ERROR);
 				}
 			if ( (permvec[i].x == x  &&  permvec[i].y == y)
 			  || (permvec[i].x == y  &&  permvec[i].y == x) )
 			    break;
 			}
-		permvec[i].x = x;
-		permvec[i].y = y;
-		if (i >= wcount)  wcount++;
+		if (i >= n)  {
+			permvec[i].x = x;
+			permvec[i].y = y;
+			n++;
+			}
 	 	curpos++;
 		cp++;
 		}
 
-	permvec[wcount].x = NONE;
-	return(wcount);
+	permvec[n].x = NONE;
+	return(n);
 }
 
 
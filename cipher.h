@@ -21,9 +21,9 @@
  * initialized.  eci->next must be a table of next pointers for this block.
  */
 #define	for_pos_in_class(pos, class)		     \
-  for ((pos=class)&&(firstflag=TRUE) ;		     \
+  for ((pos=class),(firstflag=TRUE) ;		     \
        firstflag || pos != class ;		     \
-       (firstflag=FALSE)&&(pos = eci->next[pos]))
+       (firstflag=FALSE),(pos = eci->next[pos]))
 
 
 /* Return TRUE if given wiring conflicts with the wiring
@@ -110,6 +110,12 @@ ecinfo	{
 		
 		/* Table mapping positions into their class list index. */
 		short	posclass[BLOCKSIZE+1];
+
+		/* Wire outcomes for this block, see wiretab.c. */
+		short	wtlo[BLOCKSIZE];	/* Arc of values each class */
+		short	wtlen[BLOCKSIZE];	/* can be wired to. */
+		int	wtidx;			/* Table of scores last used. */
+		int	wtgen;
 		};
 
 
@@ -132,6 +138,7 @@ gsinfo	{
 		};
 
 extern int permvec_from_string(/* eci, str, pos, permvec */);
+extern int permvec_add_string(/* eci, str, pos, permvec, wcount */);
 extern int decode_wire_but(/* eci, x, y, pvec, first, last */);
 
 #endif /* __CIPHER_H */
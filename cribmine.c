@@ -0,0 +1,471 @@
+/*
+ * Batch program that mines cribs from an archive of plaintext.
+ *
+ * Files from the same source repeat the same headers, signatures
+ * and form text, so the long strings that recur in old plaintext
+ * make good probable phrases for new ciphertext.  A string that
+ * occurs more than once is the common prefix of neighbouring
+ * suffixes in a sorted list of all the suffixes of the text (a
+ * suffix array), and every occurrence of it starts with the same
+ * character.  So the suffixes are split by their first character
+ * into pieces of about the same size, and each piece is sorted and
+ * scanned in its own process.  Each piece keeps its best repeats,
+ * ranked by the number of characters they cover, and the best of
+ * those are printed in the format of a pwords or phrases file.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	"window.h"
+#include	"specs.h"
+#include	"fanout.h"
+#include	"arena.h"
+
+
+#define	CMMINLEN	6			/* Shorter repeats are not cribs. */
+#define	CMMAXLEN	40			/* Longer repeats are cut in pieces. */
+#define	CMMINCOUNT	2			/* Occurrences a crib needs. */
+#define	CMMINLETTERS 3			/* Letters a crib needs. */
+#define	CMTOP		100			/* Default number of cribs. */
+#define	CMMAXTOP	400
+#define	CMSUFFIX	".cribs"	/* Added to a source to name its list. */
+
+
+/* A repeated string. */
+#define	cmcrib	struct xcmcrib
+cmcrib	{
+		long	count;			/* Number of occurrences. */
+		int		len;
+		char	text[CMMAXLEN+1];
+		};
+
+/* The best repeats that start with one range of characters. */
+#define	cmresult	struct xcmresult
+cmresult	{
+		int		ncribs;
+		cmcrib	cribs[CMMAXTOP];	/* Best first. */
+		};
+
+#define	cminfo	struct xcminfo
+cminfo	{
+		int		ntop;			/* Cribs wanted. */
+		int		npieces;
+		int		lo[FANMAX];		/* Piece k has the suffixes that */
+		int		hi[FANMAX];		/* start with lo[k] .. hi[k]. */
+		};
+
+/* An interval of the sorted suffixes that share a prefix. */
+#define	cmint	struct xcmint
+cmint	{
+		int		lcp;			/* Length of the shared prefix. */
+		long	lb;				/* First suffix. */
+		};
+
+
+extern	void	write_char();
+
+/* Forward declarations */
+void cm_load(char **files, int nfiles);
+void cm_mine(cminfo *cmi, FILE *out);
+void cm_split(cminfo *cmi);
+void cm_piece(int k, char *arg, char *result, int size);
+int cm_compare(const void *a, const void *b);
+int cm_lcp(long a, long b);
+void cm_interval(cmresult *cmr, int ntop, long *sa, int lcp, long lb, long rb);
+int cm_segment(cmresult *cmr, int ntop, long *sa, long lb, long rb,
+               long off, int len);
+void cm_keep(cmresult *cmr, int ntop, cmcrib *crib);
+long cm_score(cmcrib *crib);
+int cm_better(cmcrib *a, cmcrib *b);
+void cm_print(FILE *out, cmcrib *crib);
+
+/* Global state. */
+char	*cmtext = NULL;			/* All the plaintext, NUL between files. */
+long	cmsize = 0;
+arena	cmarena;				/* Work space of the current job. */
+cminfo	mycminfo;
+cmresult	cmresults[FANMAX];
+cmresult	cmbest;
+
+
+int main(argc, argv)
+int		argc;
+char	*argv[];
+{
+	int		i, bysource;
+	FILE	*out;
+	cminfo	*cmi;
+	char	outname[MAXWIDTH+1];
+
+	ar_init(&cmarena, 0, ARHUGE);
+	cmi = &mycminfo;
+	cmi->ntop = CMTOP;
+	bysource = FALSE;
+	for (i = 1 ; i < argc  &&  argv[i][0] == '-' ; i++)  {
+		if (strcmp(argv[i], "-s") == 0)  {
+			bysource = TRUE;
+			}
+		else if (strcmp(argv[i], "-n") == 0  &&  i+1 < argc)  {
+			cmi->ntop = atoi(argv[++i]);
+			}
+		else  break;
+		}
+	if (i >= argc  ||  argv[i][0] == '-'  ||  cmi->ntop < 1)  {
+		printf("Usage: %s [-s] [-n count] archive_file ...\n", argv[0]);
+		printf("\tPrints the strings that recur most in the files, as a");
+		printf(" phrases file.\n\tWith -s each file is mined by itself");
+		printf(" and its list is written to file%s.\n", CMSUFFIX);
+		exit(0);
+		}
+	if (cmi->ntop > CMMAXTOP)  cmi->ntop = CMMAXTOP;
+
+	if (!bysource)  {
+		cm_load(&argv[i], argc - i);
+		cm_mine(cmi, stdout);
+		return 0;
+		}
+
+	for ( ; i < argc ; i++)  {
+		ar_reset(&cmarena);
+		cm_load(&argv[i], 1);
+		if (strlen(argv[i]) + strlen(CMSUFFIX) > MAXWIDTH)  {
+			printf("The file name %s is too long.\n", argv[i]);
+			exit(0);
+			}
+		sprintf(outname, "%s%s", argv[i], CMSUFFIX);
+		if ((out = fopen(outname, "w")) == NULL)  {
+			printf("Could not open %s to write cribs.\n", outname);
+			exit(0);
+			}
+		cm_mine(cmi, out);
+		fclose(out);
+		printf("%d cribs from %s written to %s.\n",
+		       cmbest.ncribs, argv[i], outname);
+		}
+	ar_report(stdout, "Work space", &cmarena);
+	return 0;
+}
+
+
+/* Load the contents of the files into cmtext, each followed by a NUL.
+ */
+void cm_load(char **files, int nfiles)
+{
+	FILE	*inp;
+	long	size;
+	int		i, c;
+
+	size = 0;
+	for (i = 0 ; i < nfiles ; i++)  {
+		if ((inp = fopen(files[i], "r")) == NULL)  {
+			printf("Could not open %s to read plaintext.\n", files[i]);
+			exit(0);
+			}
+		fseek(inp, 0L, 2);
+		size += ftell(inp) + 1;
+		fclose(inp);
+		}
+	cmtext = ar_alloc(&cmarena, size);
+
+	cmsize = 0;
+	for (i = 0 ; i < nfiles ; i++)  {
+		if ((inp = fopen(files[i], "r")) == NULL)  {
+			printf("Could not open %s to read plaintext.\n", files[i]);
+			exit(0);
+			}
+		while ((c = getc(inp)) != EOF  &&  cmsize < size - 1)
+			cmtext[cmsize++] = c;
+		cmtext[cmsize++] = 0;
+		fclose(inp);
+		}
+}
+
+
+/* Mine cmtext and print its best cribs on out.
+ * The cribs are also left in cmbest.
+ */
+void cm_mine(cminfo *cmi, FILE *out)
+{
+	int		k, i;
+	cmresult	*cmr;
+
+	cm_split(cmi);
+	fanout(cmi->npieces, cm_piece, (char *) cmi,
+	       (char *) cmresults, sizeof(cmresults[0]));
+
+	cmbest.ncribs = 0;
+	for (k = 0 ; k < cmi->npieces ; k++)  {
+		cmr = &cmresults[k];
+		for (i = 0 ; i < cmr->ncribs ; i++)
+			cm_keep(&cmbest, cmi->ntop, &cmr->cribs[i]);
+		}
+
+	for (i = 0 ; i < cmbest.ncribs ; i++)
+		cm_print(out, &cmbest.cribs[i]);
+	fprintf(out, "\n");
+}
+
+
+/* Split the characters into ranges for the pieces, so that each
+ * piece gets about the same number of suffixes.
+ */
+void cm_split(cminfo *cmi)
+{
+	long	count[256];
+	long	i, sum, share;
+	int		c, k;
+
+	for (c = 0 ; c < 256 ; c++)  count[c] = 0;
+	for (i = 0 ; i < cmsize ; i++)  count[cmtext[i] & 0377]++;
+	count[0] = 0;
+
+	cmi->npieces = fan_limit();
+	if (cmi->npieces < 1)  cmi->npieces = 1;
+	if (cmi->npieces > FANMAX)  cmi->npieces = FANMAX;
+	share = cmsize / cmi->npieces + 1;
+
+	k = 0;
+	sum = 0;
+	cmi->lo[0] = 1;
+	for (c = 1 ; c < 256 ; c++)  {
+		sum += count[c];
+		if (sum >= share * (k+1)  &&  k < cmi->npieces - 1  &&  c < 255)  {
+			cmi->hi[k++] = c;
+			cmi->lo[k] = c + 1;
+			}
+		}
+	cmi->hi[k] = 255;
+	cmi->npieces = k + 1;
+}
+
+
+/* Find the best repeats among the suffixes of piece k.
+ * Called through fanout, possibly in a child process.
+ */
+void cm_piece(int k, char *arg, char *result, int size __attribute__((unused)))
+{
+	cminfo	*cmi;
+	cmresult	*cmr;
+	cmint	stack[CMMAXLEN+2];
+	armark	mark;
+	long	*sa;
+	long	i, n, lb;
+	int		c, lcp, top;
+
+	cmi = (cminfo *) arg;
+	cmr = (cmresult *) result;
+	cmr->ncribs = 0;
+
+	n = 0;
+	for (i = 0 ; i < cmsize ; i++)  {
+		c = cmtext[i] & 0377;
+		if (c >= cmi->lo[k]  &&  c <= cmi->hi[k])  n++;
+		}
+	if (n < CMMINCOUNT)  return;
+	ar_mark(&cmarena, &mark);
+	sa = (long *) ar_alloc(&cmarena, n * sizeof(long));
+	n = 0;
+	for (i = 0 ; i < cmsize ; i++)  {
+		c = cmtext[i] & 0377;
+		if (c >= cmi->lo[k]  &&  c <= cmi->hi[k])  sa[n++] = i;
+		}
+	qsort(sa, n, sizeof(long), cm_compare);
+
+	/* Walk the intervals of suffixes that share a prefix, reporting
+	 * each one as the first suffix after it has a shorter prefix
+	 * in common with the one before.
+	 */
+	top = 0;
+	stack[0].lcp = 0;
+	stack[0].lb = 0;
+	for (i = 1 ; i <= n ; i++)  {
+		lcp = (i < n) ? cm_lcp(sa[i-1], sa[i]) : 0;
+		lb = i - 1;
+		while (lcp < stack[top].lcp)  {
+			lb = stack[top].lb;
+			cm_interval(cmr, cmi->ntop, sa, stack[top].lcp, lb, i - 1);
+			top--;
+			}
+		if (lcp > stack[top].lcp)  {
+			stack[++top].lcp = lcp;
+			stack[top].lb = lb;
+			}
+		}
+	ar_release(&cmarena, &mark);
+}
+
+
+/* Order suffixes by their first CMMAXLEN characters.
+ * A NUL ends a suffix.
+ */
+int cm_compare(const void *a, const void *b)
+{
+	unsigned char	*p, *q;
+	int		i;
+
+	p = (unsigned char *) &cmtext[*((long *) a)];
+	q = (unsigned char *) &cmtext[*((long *) b)];
+	for (i = 0 ; i < CMMAXLEN  &&  *p == *q  &&  *p != 0 ; i++)  {
+		p++;
+		q++;
+		}
+	if (i >= CMMAXLEN  ||  *p == *q)  return(0);
+	return((int) *p - (int) *q);
+}
+
+
+/* Return the length of the common prefix of two suffixes,
+ * up to CMMAXLEN.
+ */
+int cm_lcp(long a, long b)
+{
+	int		i;
+
+	for (i = 0 ; i < CMMAXLEN  &&  cmtext[a+i] == cmtext[b+i]
+	             &&  cmtext[a+i] != 0 ; i++);
+	return(i);
+}
+
+
+/* Consider the prefix of length lcp shared by the suffixes
+ * sa[lb] .. sa[rb] as a crib.  If all of them have the same
+ * character before them, the crib is part of a longer one.
+ * A repeat cut at CMMAXLEN goes on past it, so the rest of it is
+ * reported as more cribs, each starting where the last one ended.
+ */
+void cm_interval(cmresult *cmr, int ntop, long *sa, int lcp, long lb, long rb)
+{
+	long	i, off;
+	int		c, before, len, used;
+
+	if (lcp < CMMINLEN  ||  rb - lb + 1 < CMMINCOUNT)  return;
+
+	before = (sa[lb] == 0) ? 0 : cmtext[sa[lb]-1] & 0377;
+	for (i = lb + 1 ; i <= rb ; i++)  {
+		c = (sa[i] == 0) ? 0 : cmtext[sa[i]-1] & 0377;
+		if (c != before  ||  c == 0)  break;
+		}
+	if (i > rb  &&  before != 0)  return;
+
+	off = 0;
+	len = lcp;
+	while (len >= CMMINLEN)  {
+		used = cm_segment(cmr, ntop, sa, lb, rb, off, len);
+		if (len < CMMAXLEN)  break;
+		off += (used > 0) ? used : len;
+		len = CMMAXLEN;
+		for (i = lb + 1 ; i <= rb ; i++)  {
+			c = cm_lcp(sa[lb] + off, sa[i] + off);
+			if (c < len)  len = c;
+			}
+		}
+}
+
+
+/* Consider the len characters at off in each of the suffixes
+ * sa[lb] .. sa[rb] as a crib.  A crib that ends in part of a word
+ * is cut back to the end of the word before, and only the
+ * occurrences that start and end at the edges of words are counted.
+ * Return the length left after the cut.
+ */
+int cm_segment(cmresult *cmr, int ntop, long *sa, long lb, long rb,
+               long off, int len)
+{
+	cmcrib	crib;
+	long	i, count, at;
+	int		nletters;
+	char	*p;
+
+	p = &cmtext[sa[lb] + off];
+	if (isletter(p[len-1]))  {
+		count = 0;
+		for (i = lb ; i <= rb ; i++)
+			if (!isletter(cmtext[sa[i]+off+len]))  count++;
+		if (count < CMMINCOUNT)
+			while (len > 0  &&  isletter(p[len-1]))  len--;
+		}
+	if (len < CMMINLEN)  return(len);
+
+	count = 0;
+	for (i = lb ; i <= rb ; i++)  {
+		at = sa[i] + off;
+		if (isletter(p[0])  &&  at > 0  &&  isletter(cmtext[at-1]))
+			continue;
+		if (isletter(p[len-1])  &&  isletter(cmtext[at+len]))
+			continue;
+		count++;
+		}
+	if (count < CMMINCOUNT)  return(len);
+
+	nletters = 0;
+	for (i = 0 ; i < len ; i++)
+		if (isletter(p[i]))  nletters++;
+	if (nletters < CMMINLETTERS)  return(len);
+
+	crib.count = count;
+	crib.len = len;
+	memcpy(crib.text, p, len);
+	crib.text[len] = 0;
+	cm_keep(cmr, ntop, &crib);
+	return(len);
+}
+
+
+/* Add crib to the ntop best in cmr if it is good enough, replacing
+ * the same text with a lower count.
+ */
+void cm_keep(cmresult *cmr, int ntop, cmcrib *crib)
+{
+	int		i;
+
+	for (i = 0 ; i < cmr->ncribs ; i++)  {
+		if (cmr->cribs[i].len != crib->len)  continue;
+		if (memcmp(cmr->cribs[i].text, crib->text, crib->len) != 0)  continue;
+		if (cmr->cribs[i].count >= crib->count)  return;
+		for (cmr->ncribs-- ; i < cmr->ncribs ; i++)
+			cmr->cribs[i] = cmr->cribs[i+1];
+		break;
+		}
+	if (cmr->ncribs >= ntop  &&  !cm_better(crib, &cmr->cribs[ntop-1]))
+		return;
+
+	i = cmr->ncribs;
+	if (i >= ntop)  i = ntop - 1;
+	for ( ; i > 0  &&  cm_better(crib, &cmr->cribs[i-1]) ; i--)
+		cmr->cribs[i] = cmr->cribs[i-1];
+	cmr->cribs[i] = *crib;
+	if (cmr->ncribs < ntop)  cmr->ncribs++;
+}
+
+
+/* Return the number of characters of plaintext a crib covers.
+ */
+long cm_score(cmcrib *crib)
+{
+	return(crib->count * crib->len);
+}
+
+
+/* Return TRUE if crib a ranks before crib b.  Ties go to the longer
+ * crib and then to the first in character order, so the list does
+ * not depend on how the work was split.
+ */
+int cm_better(cmcrib *a, cmcrib *b)
+{
+	if (cm_score(a) != cm_score(b))  return(cm_score(a) > cm_score(b));
+	if (a->len != b->len)  return(a->len > b->len);
+	return(strcmp(a->text, b->text) < 0);
+}
+
+
+/* Print a crib as a line of a pwords file.
+ */
+void cm_print(FILE *out, cmcrib *crib)
+{
+	int		i;
+
+	for (i = 0 ; i < crib->len ; i++)
+		write_char(out, crib->text[i] & 0377);
+	fprintf(out, "\n");
+}
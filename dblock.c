@@ -78,6 +78,9 @@ int	mcmdbuf[BLOCKSIZE+1];		/* Static buffer for now. */
 
 dbsinfo dbsprivate;
 
+dbsjentry	dbsjournal[DBSJSIZE];
+int		dbsjcount = 0;
+
 
 
 /* Window for the decryption block label. */
@@ -598,6 +601,7 @@ int	x, y;
 {
 	int	i;
 	dbsinfo	*dbsi;
+	dbsjentry	*j;
 	dbsi = ((dbsinfo *) dbs->wprivate);
 
 	if (x == NONE  ||  y == NONE)  return;
@@ -609,7 +613,13 @@ int	x, y;
 		if (dbsi->perm[x] != NONE)  dbscwire(dbs, x, dbsi->perm[x]);
 		if (dbsi->perm[y] != NONE)  dbscwire(dbs, y, dbsi->perm[y]);
 		}
-	if (dbsi->perm[x] == NONE)  dbsi->wirecnt++;
+	if (dbsi->perm[x] == NONE)  {
+		dbsi->wirecnt++;
+		j = &dbsjournal[dbsjcount++ % DBSJSIZE];
+		j->blknum = dbsi->blknum;
+		j->x = x;
+		j->y = y;
+		}
 	dbsi->perm[x] = y;
 	dbsi->perm[y] = x;
 
@@ -23,4 +23,22 @@ struct	xdbsinfo	{
 		int		blknum;		/* Zero based index of current block. */
 		};
 
+
+/* Journal of wires set in any block, oldest first.
+ * Entry k lives at dbsjournal[k % DBSJSIZE]; dbsjcount is the
+ * number of entries ever made, so a reader that falls more than
+ * DBSJSIZE behind knows it has missed some.
+ */
+#define	DBSJSIZE	512
+
+#define	dbsjentry	struct	xdbsjentry
+struct	xdbsjentry	{
+		int		blknum;		/* Block the wire was set in. */
+		int		x;			/* The wire, perm[x] == y. */
+		int		y;
+		};
+
+extern	dbsjentry	dbsjournal[];
+extern	int		dbsjcount;
+
 #endif /* __DBLOCK_H */
@@ -11,12 +11,16 @@
 #include	"specs.h"
 #include	"pqueue.h"
 #include	"cipher.h"
+#include	"wordscore.h"
 
 #include	"dblock.h"
 #include	"terminal.h"
 
 
+#define	DBSWORDDEV	1.0		/* Std devs per unit of word score. */
+
 ecinfo	t_ecinfo;
+wsinfo	t_wsinfo;
 
 
 /* Try all the possible characters at the current position.
@@ -36,7 +40,8 @@ void dbstryall(gwindow *dbs, key k __attribute__((unused)))
 	dbsi = ((dbsinfo *) dbs->wprivate);
 	ecbi = &t_ecinfo;
 
-	pque_init(&pque_hdr, 1000.0, &the_pque[0], MAXCHAR+1);
+	pque_init(&pque_hdr, 1000.0, &the_pque[0],
+	          (dbs->wwidth - 1 < MAXCHAR+1) ? dbs->wwidth - 1 : MAXCHAR+1);
 	ec_init(dbsi->cbuf, dbsi->perm, ecbi);
 	
 	oldrow = dbs->wcur_row;
@@ -61,6 +66,11 @@ void dbstryall(gwindow *dbs, key k __attribute__((unused)))
 
 /* Try all chars in position pos.  Added them to a priority queue.
  * The most likely character appears first.
+ * If there is a dictionary, the change in the word score of the
+ * block takes DBSWORDDEV standard deviations off for each unit.
+ * The letter pair score is at least zero, so once the queue is full
+ * a char that would not get in without it is passed over without
+ * working it out.
  */
 void dbstrypq(ecbi, pque_hdr, pos)
 ecinfo		*ecbi;
@@ -69,14 +79,20 @@ int			pos;
 {
 	int		plainchar;
 	int		added;
+	int		i, words;
 	float	score;
 	float	sdev1, sdev2;		/* Standard Deviation for 1st and 2nd stats. */
+	float	wdev;				/* Word score as standard deviations. */
 	gsinfo	tmpgsi;
 	gsinfo	*gsi;
 	int		gssbuf[BLOCKSIZE+1];
+	wsinfo	*wsi;
 
 	gsi	= &tmpgsi;
 	gsi_init(gsi, ecbi->plaintext, gssbuf);
+	wsi = &t_wsinfo;
+	if ((words = ws_ready()))  ws_init(wsi, ecbi->plaintext);
+	wdev = 0.0;
 
 	for (plainchar = 0 ; plainchar <= MAXCHAR ; plainchar++)  {
 		gsi_clear(gsi);
@@ -85,10 +101,20 @@ int			pos;
 			sdev1 = gsi_1score(gsi);
 			if (sdev1 < 0.0)
 				continue;
+			if (words)  {
+				wdev = 0.0 - wsi->total;
+				for (i = 0 ; gsi->cpos[i] != NONE ; i++)
+					ws_set(wsi, gsi->cpos[i], gsi->cguessed[gsi->cpos[i]]);
+				wdev = DBSWORDDEV * (wdev + wsi->total);
+				for (i-- ; i >= 0 ; i--)
+					ws_set(wsi, gsi->cpos[i], ecbi->plaintext[gsi->cpos[i]]);
+				}
+			if (sdev1 - wdev >= pque_worst(pque_hdr))
+				continue;
 			sdev2 = gsi_2score(gsi);
 			if (sdev2 < 0.0)
 				continue;
-			score = sdev1 + sdev2;
+			score = sdev1 + sdev2 - wdev;
 			pque_add(pque_hdr, score, plainchar, 0);
 			}
 		}
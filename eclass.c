@@ -11,6 +11,7 @@
 #include	"layout.h"
 #include	"specs.h"
 #include	"cipher.h"
+#include	"wiretab.h"
 #include	"dblock.h"
 
 
@@ -285,25 +286,29 @@ int		plainchar;
 {
 	extern	float	logvar;
 	float	score;
-	int		pvec[BLOCKSIZE+1];
-	int		ccount;
+	int		x, y;
+	wtent	*ent;
 #if DEBUG
+	int		pvec[BLOCKSIZE+1];
 	char	str[BLOCKSIZE+1];
 #endif
 
+	firstpos = MODMASK & firstpos;
+	plainchar = CHARMASK & plainchar;
+	x = eci->scipher[firstpos];
+	y = MODMASK & (plainchar + firstpos);
+	if (!wt_ascii(eci, x, y)  ||  perm_conflict(eci->perm, x, y))  return(0.0);
+	ent = wt_wire(eci, x, y);
+	if (ent->count == 0)  return(0.0);
 
-	if (decode_class(eci, firstpos, plainchar, pvec) == ERROR)  {
-		return(0.0);
-		}
-
-	score = pvec_1score(pvec);
+	score = sum_1score(ent->sum, (float) ent->count);
 	if (score < 0.0)  return(0.0);
 	score = exp(-(score * score) / 2.0);
-	for (ccount = 0 ; pvec[ccount] != NONE ; ccount++);
-	score = score / sqrt(2*PI*logvar/ccount);
+	score = score / sqrt(2*PI*logvar/ent->count);
 
 #if DEBUG
 	if (score > MIN_SHOW_SCORE) {
+		decode_class(eci, firstpos, plainchar, pvec);
 		pvec2str(str, pvec);
 		printf("Derived characters are '%s", str);
 		printf("', their score is %7.4f\n", score);
@@ -394,6 +399,8 @@ void ec_init(char cipher[], int perm[], ecinfo *eci)
 
 	eci->sizelast = 0;
 	eci->sizemin = 2;
+	eci->wtidx = 0;
+	eci->wtgen = NONE;
 	for (i = 0 ; i < BLOCKSIZE ; i++)  {
 		eci->ciphertext[i] = cipher[i];
 		eci->scipher[i] = (cipher[i] + i)&MODMASK;
@@ -421,6 +428,7 @@ void ec_init(char cipher[], int perm[], ecinfo *eci)
 			ec_addsize(eci, size, firstpos);
 			}
 		}
+	wt_arcs(eci);
 }
 
 
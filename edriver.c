@@ -70,7 +70,8 @@ char	*argv[];
 		exit(0);
 		}
 
-	load_1stats_from("mss.stats");
+	letterstats = "mss.stats";
+	need_1stats();
 	eci = &myecinfo;
 
 	if ((inp = fopen(infile, "r")) == NULL) {
@@ -18,11 +18,15 @@ char	t1[ROTORSZ];
 char	t2[ROTORSZ];
 char	t3[ROTORSZ];
 char	deck[ROTORSZ];
+char	blkperm[ROTORSZ];
+unsigned char	ibuf[ROTORSZ];
+unsigned char	obuf[ROTORSZ];
 char	*getpass();
 char	buf[13];
 
 /* Forward declarations */
 void shuffle(char deck[]);
+void blocktab(int n2);
 
 void setup(char *pw)
 {
@@ -96,6 +100,22 @@ int main(int argc, char *argv[])
 	n2 = 0;
 	nr2 = 0;
 
+	/*
+	 * Without -s the rotor only moves between blocks, so each
+	 * block is one permutation of the shifted characters.
+	 */
+	if (!secureflg) {
+		while ((nr1 = fread(ibuf, 1, ROTORSZ, stdin)) > 0) {
+			blocktab(n2);
+			for (n1 = 0; n1 < nr1; n1++)
+				obuf[n1] = blkperm[(ibuf[n1]+n1)&MASK] - n1;
+			fwrite(obuf, 1, nr1, stdout);
+			n2++;
+			if (n2==ROTORSZ) n2 = 0;
+		}
+		return 0;
+	}
+
 	while((i=getchar()) >=0) {
 		if (secureflg) {
 			nr1 = deck[n1]&MASK;
@@ -121,6 +141,17 @@ int main(int argc, char *argv[])
 	return 0;
 }
 
+/*
+ * Fill in blkperm with the permutation of block n2.
+ */
+void blocktab(int n2)
+{
+	int i;
+
+	for(i=0;i<ROTORSZ;i++)
+		blkperm[i] = t2[(t3[(t1[i]+n2)&MASK]-n2)&MASK];
+}
+
 void shuffle(char deck[])
 {
 	int i, ic, k, temp;
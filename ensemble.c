@@ -0,0 +1,587 @@
+/*
+ * Ensemble guessing.
+ *
+ * The equivalence class, bigram, trigram and probable word
+ * engines are run in parallel on the same snapshot of a block.
+ * A wire is accepted when enough engines propose it, or when a
+ * single engine proposes it and the class statistics make it a
+ * clear winner.  Wires that the engines disagree about are kept
+ * so the user can step through them in the guess window.
+ */
+
+#include	<stdio.h>
+#include	<string.h>
+#include	<math.h>
+#include	"window.h"
+#include	"terminal.h"
+#include	"layout.h"
+#include	"specs.h"
+#include	"cipher.h"
+#include	"autotri.h"
+#include	"dblock.h"
+#include	"fanout.h"
+
+
+#define	ENLABEL1	"Ensemble guess, votes %d, lone level %5.2f -- Please Wait"
+#define	ENLABEL2	"Ensemble guess, %d wires, %d disputed -- Done"
+#define	ENHELP		"F3 enters guess, ^G undoes it, F2 shows next dispute."
+#define	ENNODISPUTE	"The engines did not disagree."
+#define	ENNOWORDS	"-"		/* Pwords file name for no pwords. */
+
+/* Engines, in the order their results are kept. */
+#define	EN_EC		0
+#define	EN_LP		1
+#define	EN_TRI		2
+#define	EN_PWD		3
+#define	NENGINES	4
+
+/* Engine parameters.  These are the conservative settings the
+ * manual suggests for each command on its own.
+ */
+#define	EN_ECLEVEL	2.0
+#define	EN_LPLEVEL	1.5
+#define	EN_LPPROB	0.6
+#define	EN_TRIDEV	1.0
+#define	EN_TRITOTAL	8
+#define	EN_TRIWIRE	2
+#define	EN_PWDDEV	1.0
+
+#define	ENMAXWIRES	(NENGINES*BLOCKSIZE/2)
+#define	ENSURE		(1000000.0)	/* Ratio for a class with one choice. */
+
+/* Values for the status of a proposed wire. */
+#define	ENWEAK		0	/* Not enough support to accept. */
+#define	ENACCEPT	1	/* Accepted into the guess. */
+#define	ENDISPUTE	2	/* Engines disagree, user should review. */
+
+
+/* A wire proposed by one or more engines. */
+#define	enwire	struct xenwire
+enwire	{
+		short	x;			/* Sorted so x < y. */
+		short	y;
+		short	votes;		/* Number of engines proposing it. */
+		short	engines;	/* Bit k set if engine k proposed it. */
+		short	status;		/* ENWEAK, ENACCEPT or ENDISPUTE. */
+		float	conf;		/* Class score ratio, see en_conf. */
+		};
+
+#define	eninfo	struct xeninfo
+eninfo	{
+		/* Accepted wires and the plaintext they deduce. */
+		ecinfo	eci;
+		/* Snapshot of the block permutation the engines started from. */
+		int		baseperm[BLOCKSIZE+1];
+		char	*cbuf;
+		/* Acceptance parameters. */
+		int		min_votes;
+		float	lone_level;
+		char	pwfile[MAXWIDTH+1];
+		/* All proposed wires. */
+		int		nwires;
+		enwire	wires[ENMAXWIRES];
+		int		naccept;
+		int		ndispute;
+		/* Index of the dispute last shown, or NONE. */
+		int		curwire;
+		};
+
+
+extern	char	mcbuf[];
+extern	ecinfo	gecinfo;
+extern	atrinfo	gatrinfo;
+extern	void	ec_autoguess(ecinfo *eci, float alevel);
+extern	float	ec_cscore();
+extern	void	lp_init();
+extern	void	lp_autoguess();
+extern	char	*pwd_init();
+extern	void	pwd_autoguess();
+extern	int		nhot;
+
+/* Forward declarations */
+void endraw(gwindow *enb);
+void enfirst(gwindow *enb, int row, int col);
+void enenter(gwindow *enb);
+void enundo(gwindow *enb);
+void ennext(gwindow *enb);
+void en_guess(eninfo *eni, char *cbuf, int *perm);
+int en_autoguess(char *cbuf, int *perm, int min_votes, float lone_level,
+                 char *pwfile);
+void en_engine(int k, char *arg, char *result, int size);
+void en_addwire(eninfo *eni, int x, int y, int k);
+void en_decide(eninfo *eni);
+float en_conf(ecinfo *eci, int x, int y);
+int en_wirepos(ecinfo *eci, enwire *wire, int *charp);
+void en_wirestr(eninfo *eni, enwire *wire, char *str);
+void en_onewire(ecinfo *eci, enwire *wire, char *str);
+
+/* Global state. */
+char	*en_names[NENGINES] = {"ec", "lp", "tri", "pw"};
+eninfo	geninfo;
+keyer	enktab[] = {
+		{CACCEPT, enenter},
+		{CUNDO, enundo},
+		{CNEXTGUESS, ennext},
+		{CGO_UP, jogup},
+		{CGO_DOWN, jogdown},
+		{CGO_LEFT, jogleft},
+		{CGO_RIGHT, jogright},
+		{0, NULL},
+};
+
+
+/* Routine invoked by user to run the ensemble of guessing engines.
+ * The window is drawn empty, and then filled in with the guess.
+ * Return NULL if command completes ok.
+ */
+char	*ensguess(str)
+char	*str;			/* Command line */
+{
+	eninfo	*eni;
+	gwindow	*enb;
+
+	enb = &gbstore;
+	eni = &geninfo;
+
+	if (sscanf(str, "%*[^:]: %d %*[^:]: %f %*[^:]: %s",
+			&eni->min_votes, &eni->lone_level, eni->pwfile) != 3)  {
+		return("Could not parse all three arguments.");
+		}
+	if (eni->min_votes < 1  ||  eni->min_votes > NENGINES)  {
+		return("The number of votes must be between 1 and 4.");
+		}
+
+	gbsswitch(enb, ((char *) eni), enktab, enfirst, wl_noop, endraw);
+
+	sprintf(statmsg, ENLABEL1, eni->min_votes, eni->lone_level);
+	gblset(&gblabel, statmsg);
+	gbsclear(enb);
+	fflush(stdout);
+
+	en_guess(eni, mcbuf, refperm(dbsgetblk(&dbstore)));
+
+	sprintf(statmsg, ENLABEL2, eni->naccept, eni->ndispute);
+	gblset(&gblabel, statmsg);
+	endraw(enb);
+
+	return(NULL);
+}
+
+
+/*  (re) Draw the window.
+ */
+void endraw(enb)
+gwindow	*enb;
+{
+	int			i;
+	int			row, col;
+	eninfo		*eni;
+
+	eni = ((eninfo *) enb->wprivate);
+	row = 1;
+	col = 1;
+
+	for (i = 0 ; i < BLOCKSIZE ; i++)  {
+		if (i%LINELEN == 0) {
+			wl_setcur(enb, gbspos2row(i), gbspos2col(i));
+			}
+		plnchars(1, char2sym(eni->eci.plaintext[i]));
+		}
+
+	for (i = gbspos2row(BLOCKSIZE) ; i <= GBHEIGHT ; i++) {
+		wl_setcur(enb, i, 1);
+		plnchars(LINELEN, ' ');
+		}
+
+	for (i = 1 ; i <= GBHEIGHT ; i++) {
+		wl_setcur(enb, i, LINELEN+1);
+		plnchars(enb->wwidth - LINELEN, ' ');
+		}
+
+	wl_setcur(enb, row, col);
+}
+
+
+/* First time cursor enters window.
+ */
+void enfirst(gwindow *enb, int row, int col)
+{
+	usrhelp(&user, ENHELP);
+	wl_setcur(enb, row, col);
+}
+
+
+/* Enter the accepted wires into the decryption block.
+ */
+void enenter(gwindow *enb)
+{
+	eninfo		*eni;
+
+	eni = ((eninfo *) enb->wprivate);
+	dbsmerge(&dbstore, eni->eci.perm);
+	wl_rcursor(enb);
+}
+
+
+/* Undo the last guess.
+ */
+void enundo(gwindow *enb)
+{
+	dbsundo(&dbstore);
+	wl_rcursor(enb);
+}
+
+
+/* Show the next disputed wire in the guess label and move the
+ * cursor to the position it deduces.
+ */
+void ennext(gwindow *enb)
+{
+	eninfo	*eni;
+	enwire	*wire;
+	int		i, w, n, pos, c;
+
+	eni = ((eninfo *) enb->wprivate);
+	if (eni->ndispute == 0)  {
+		usrstatus(&user, ENNODISPUTE);
+		wl_rcursor(enb);
+		return;
+		}
+
+	w = eni->curwire;
+	for (i = 0 ; i < eni->nwires ; i++)  {
+		w = (w + 1) % eni->nwires;
+		if (eni->wires[w].status == ENDISPUTE)  break;
+		}
+	eni->curwire = w;
+	wire = &eni->wires[w];
+
+	n = 0;
+	for (i = 0 ; i <= w ; i++)  {
+		if (eni->wires[i].status == ENDISPUTE)  n++;
+		}
+	sprintf(statmsg, "Dispute %d of %d: ", n, eni->ndispute);
+	en_wirestr(eni, wire, &statmsg[strlen(statmsg)]);
+	gblset(&gblabel, statmsg);
+
+	pos = en_wirepos(&eni->eci, wire, &c);
+	if (pos == NONE)  {
+		wl_rcursor(enb);
+		return;
+		}
+	wl_setcur(enb, gbspos2row(pos), gbspos2col(pos));
+}
+
+
+/* Run all the engines on the block cbuf with partial permutation
+ * perm, and combine their guesses into eni->eci.perm.
+ */
+void en_guess(eninfo *eni, char *cbuf, int *perm)
+{
+	int		results[NENGINES][BLOCKSIZE+1];
+	int		i, k, x, y;
+
+	eni->cbuf = cbuf;
+	for (i = 0 ; i < BLOCKSIZE ; i++)
+		eni->baseperm[i] = perm[i];
+
+	fanout(NENGINES, en_engine, (char *) eni,
+	       (char *) results, sizeof(results[0]));
+
+	/* Set up after the engines since a serial run uses gecinfo. */
+	ec_init(cbuf, eni->baseperm, &eni->eci);
+
+	eni->nwires = 0;
+	eni->curwire = NONE;
+	for (k = 0 ; k < NENGINES ; k++)  {
+		for (x = 0 ; x < BLOCKSIZE ; x++)  {
+			y = results[k][x];
+			if (y == NONE  ||  y <= x  ||  eni->baseperm[x] != NONE)
+				continue;
+			en_addwire(eni, x, y, k);
+			}
+		}
+
+	for (i = 0 ; i < eni->nwires ; i++)  {
+		eni->wires[i].conf = en_conf(&eni->eci,
+		                             eni->wires[i].x, eni->wires[i].y);
+		}
+
+	en_decide(eni);
+	decode(eni->eci.ciphertext, eni->eci.plaintext, eni->eci.perm);
+}
+
+
+/* Run the ensemble on the block cbuf without a display and add the
+ * accepted wires to perm.  Used by the automatic solver.
+ * Returns the number of wires added.
+ */
+int en_autoguess(char *cbuf, int *perm, int min_votes, float lone_level,
+                 char *pwfile)
+{
+	eninfo	*eni;
+	int		x, y, added;
+
+	eni = &geninfo;
+	eni->min_votes = min_votes;
+	eni->lone_level = lone_level;
+	strncpy(eni->pwfile, pwfile, MAXWIDTH);
+	eni->pwfile[MAXWIDTH] = 0;
+
+	en_guess(eni, cbuf, perm);
+
+	added = 0;
+	for (x = 0 ; x < BLOCKSIZE ; x++)  {
+		y = eni->eci.perm[x];
+		if (y == NONE  ||  y <= x  ||  perm[x] != NONE  ||  perm[y] != NONE)
+			continue;
+		perm[x] = y;
+		perm[y] = x;
+		added++;
+		}
+	return(added);
+}
+
+
+/* Run engine k on the snapshot in arg, leaving its permutation
+ * in result.  Called through fanout, possibly in a child process.
+ */
+void en_engine(int k, char *arg, char *result, int size)
+{
+	eninfo	*eni;
+	atrinfo	*atri;
+	int		*perm;
+	int		i;
+	char	*pwfile;
+
+	eni = ((eninfo *) arg);
+	perm = ((int *) result);
+	atri = &gatrinfo;
+
+	switch (k)  {
+	  case EN_EC:
+		ec_init(eni->cbuf, eni->baseperm, &gecinfo);
+		ec_autoguess(&gecinfo, EN_ECLEVEL);
+		break;
+
+	  case EN_LP:
+		lp_init(eni->cbuf, eni->baseperm, &gecinfo);
+		lp_autoguess(&gecinfo, EN_LPLEVEL, EN_LPPROB);
+		break;
+
+	  case EN_TRI:
+		atr_init(eni->cbuf, eni->baseperm, atri);
+		atri->max_score = EN_TRIDEV;
+		atri->min_total_chars = EN_TRITOTAL;
+		atri->min_wire_chars = EN_TRIWIRE;
+		atr_autoguess(atri);
+		break;
+
+	  case EN_PWD:
+		ec_init(eni->cbuf, eni->baseperm, &gecinfo);
+		pwfile = eni->pwfile;
+		if (strcmp(pwfile, ENNOWORDS) == 0)  {
+			if (nhot == 0)  break;
+			pwfile = NULL;
+			}
+		if (pwd_init(pwfile, eni->cbuf, eni->baseperm, atri) != NULL)
+			break;
+		atri->min_total_chars = 1;
+		atri->max_score = EN_PWDDEV;
+		atri->min_wire_chars = 0;
+		pwd_autoguess(atri);
+		break;
+	  }
+
+	for (i = 0 ; i < BLOCKSIZE  &&  (i+1) * (int) sizeof(int) <= size ; i++)
+		perm[i] = gecinfo.perm[i];
+}
+
+
+/* Record that engine k proposes wiring x to y, x < y.
+ */
+void en_addwire(eninfo *eni, int x, int y, int k)
+{
+	int		i;
+	enwire	*wire;
+
+	for (i = 0 ; i < eni->nwires ; i++)  {
+		wire = &eni->wires[i];
+		if (wire->x == x  &&  wire->y == y)  {
+			wire->votes++;
+			wire->engines |= (1 << k);
+			return;
+			}
+		}
+	if (eni->nwires >= ENMAXWIRES)  return;
+
+	wire = &eni->wires[eni->nwires++];
+	wire->x = x;
+	wire->y = y;
+	wire->votes = 1;
+	wire->engines = (1 << k);
+	wire->status = ENWEAK;
+	wire->conf = 0.0;
+}
+
+
+/* Decide the status of every proposed wire and fill in eni->eci.perm.
+ * Wires are considered from most to least supported.  A wire that
+ * shares a terminal with a different proposal is accepted only if
+ * it has enough votes and more votes than every rival; otherwise it
+ * is a dispute.  An unrivaled wire needs enough votes or a class
+ * score ratio of at least lone_level.
+ */
+void en_decide(eninfo *eni)
+{
+	int		order[ENMAXWIRES];
+	int		i, j, t, rivals, maxrival;
+	enwire	*wire, *other;
+
+	for (i = 0 ; i < eni->nwires ; i++)  order[i] = i;
+	for (i = 1 ; i < eni->nwires ; i++)  {
+		t = order[i];
+		for (j = i ; j > 0 ; j--)  {
+			wire = &eni->wires[t];
+			other = &eni->wires[order[j-1]];
+			if (other->votes > wire->votes)  break;
+			if (other->votes == wire->votes  &&  other->conf >= wire->conf)
+				break;
+			order[j] = order[j-1];
+			}
+		order[j] = t;
+		}
+
+	eni->naccept = 0;
+	eni->ndispute = 0;
+	for (i = 0 ; i < eni->nwires ; i++)  {
+		wire = &eni->wires[order[i]];
+		rivals = 0;
+		maxrival = 0;
+		for (j = 0 ; j < eni->nwires ; j++)  {
+			other = &eni->wires[j];
+			if (other == wire)  continue;
+			if (other->x != wire->x  &&  other->x != wire->y
+			 && other->y != wire->x  &&  other->y != wire->y)
+				continue;
+			rivals++;
+			if (other->votes > maxrival)  maxrival = other->votes;
+			}
+
+		wire->status = ENWEAK;
+		if (rivals > 0)  {
+			wire->status = ENDISPUTE;
+			if (wire->votes < eni->min_votes  ||  wire->votes <= maxrival)
+				{eni->ndispute++;  continue;}
+			}
+		else if (wire->votes < eni->min_votes
+		      && wire->conf < eni->lone_level)  {
+			continue;
+			}
+
+		if (perm_conflict(eni->eci.perm, wire->x, wire->y))  {
+			if (wire->status == ENDISPUTE)  eni->ndispute++;
+			continue;
+			}
+		eni->eci.perm[wire->x] = wire->y;
+		eni->eci.perm[wire->y] = wire->x;
+		wire->status = ENACCEPT;
+		eni->naccept++;
+		}
+}
+
+
+/* Return how strongly the first order statistics favor wiring x
+ * to y over every other choice for the same class, as the ratio of
+ * the score of that choice to the sum of the scores of the others.
+ * This is the measure the equivalence class engine uses, computed
+ * here for every engine so that their proposals are comparable.
+ */
+float en_conf(ecinfo *eci, int x, int y)
+{
+	enwire	wire;
+	int		pos, c, d;
+	float	score, total;
+
+	wire.x = x;
+	wire.y = y;
+	if ((pos = en_wirepos(eci, &wire, &c)) == NONE)  return(0.0);
+	if (c > MAXCHAR)  return(0.0);
+
+	score = ec_cscore(eci, pos, c);
+	if (score <= 0.0)  return(0.0);
+	total = 0.0;
+	for (d = 0 ; d <= MAXCHAR ; d++)  {
+		if (d != c)  total += ec_cscore(eci, pos, d);
+		}
+	if (total <= 0.0)  return(ENSURE);
+	return(score / total);
+}
+
+
+/* Return the first position of a class that the wire deduces,
+ * or NONE if neither terminal occurs in the block.
+ * The plaintext deduced at that position is stored through charp.
+ */
+int en_wirepos(ecinfo *eci, enwire *wire, int *charp)
+{
+	int		pos;
+
+	if ((pos = eci->permmap[wire->x]) != NONE)  {
+		*charp = MODMASK & (wire->y - pos);
+		}
+	else if ((pos = eci->permmap[wire->y]) != NONE)  {
+		*charp = MODMASK & (wire->x - pos);
+		}
+	return(pos);
+}
+
+
+/* Describe a disputed wire and its first rival in str, e.g.,
+ * "'e'@41 (lp tri) vs 'a'@41 (ec)".
+ */
+void en_wirestr(eninfo *eni, enwire *wire, char *str)
+{
+	int		j, nrival;
+	enwire	*other;
+
+	en_onewire(&eni->eci, wire, str);
+	nrival = 0;
+	for (j = 0 ; j < eni->nwires ; j++)  {
+		other = &eni->wires[j];
+		if (other == wire)  continue;
+		if (other->x != wire->x  &&  other->x != wire->y
+		 && other->y != wire->x  &&  other->y != wire->y)
+			continue;
+		if (nrival++ > 0)  {
+			strcat(str, " ...");
+			break;
+			}
+		strcat(str, " vs ");
+		en_onewire(&eni->eci, other, &str[strlen(str)]);
+		}
+}
+
+
+/* Describe one wire in str by the character it deduces, its
+ * position and the engines that proposed it.
+ */
+void en_onewire(ecinfo *eci, enwire *wire, char *str)
+{
+	int		k, pos, c;
+
+	pos = en_wirepos(eci, wire, &c);
+	if (pos == NONE)
+		sprintf(str, "%d-%d (", wire->x, wire->y);
+	else if (printable(c))
+		sprintf(str, "'%c'@%d (", c, pos);
+	else
+		sprintf(str, "\\%03o@%d (", c, pos);
+	for (k = 0 ; k < NENGINES ; k++)  {
+		if (wire->engines & (1 << k))  {
+			strcat(str, en_names[k]);
+			strcat(str, " ");
+			}
+		}
+	str[strlen(str)-1] = ')';
+}
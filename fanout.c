@@ -0,0 +1,315 @@
+/*
+ * Run independent pieces of work in parallel, or a stream of work
+ * as a pipeline of processes.
+ *
+ * Most of the workbench keeps its state in global tables, so the
+ * pieces run in forked processes rather than threads.  Each child
+ * starts with a copy-on-write snapshot of the parent, does its
+ * piece, writes a fixed size result down a pipe and exits.
+ * If a process cannot be created, or a child dies before sending
+ * its whole result, the piece is simply done in the parent.
+ */
+
+#include	<stdlib.h>
+#include	<stdio.h>
+#include	<unistd.h>
+#include	<errno.h>
+#include	<signal.h>
+#include	<sys/types.h>
+#include	<sys/wait.h>
+#include	"window.h"
+#include	"specs.h"
+#include	"arena.h"
+#include	"fanout.h"
+
+
+/* Forward declarations */
+int fan_pipeline(int (*reader)(), void (*work)(), void (*writer)(),
+                 char *arg, int insize, int outsize);
+int fan_pstart(int nwork, int (*reader)(), void (*work)(), char *arg,
+               int insize, int outsize, pid_t *pids, int *outfds);
+int fan_pstop(int nwork, pid_t *pids, int *outfds, int w);
+int fan_pwait(pid_t pid);
+int fan_limit(void);
+int fan_write(int fd, char *buf, int size);
+int fan_read(int fd, char *buf, int size);
+
+/* Global state. */
+arena	fanarena;			/* Buffers of the call being run. */
+
+
+/* Do pieces 0 to nwork-1 of some work, putting the result of
+ * piece k at results[k*size].  At most fan_limit() processes run
+ * at once.  Returns the number of pieces that ran in a child.
+ */
+int fanout(int nwork, void (*work)(), char *arg, char *results, int size)
+{
+	int		first, last, limit;
+	int		k, got, nforked;
+	int		pfd[2];
+	int		fds[FANMAX];
+	pid_t	pids[FANMAX];
+	char	*buf;
+
+	if (nwork > FANMAX)  nwork = FANMAX;
+	limit = fan_limit();
+	nforked = 0;
+
+	for (first = 0 ; first < nwork ; first = last)  {
+		last = first + limit;
+		if (last > nwork)  last = nwork;
+		fflush(stdout);
+
+		for (k = first ; k < last ; k++)  {
+			fds[k] = NONE;
+			if (limit < 2)  continue;
+			if (pipe(pfd) < 0)  continue;
+			if ((pids[k] = fork()) < 0)  {
+				close(pfd[0]);
+				close(pfd[1]);
+				continue;
+				}
+			if (pids[k] == 0)  {
+				close(pfd[0]);
+				buf = ar_alloc(&fanarena, size);
+				(*work)(k, arg, buf, size);
+				fan_write(pfd[1], buf, size);
+				_exit(0);
+				}
+			close(pfd[1]);
+			fds[k] = pfd[0];
+			nforked++;
+			}
+
+		for (k = first ; k < last ; k++)  {
+			got = 0;
+			if (fds[k] != NONE)  {
+				got = fan_read(fds[k], &results[k*size], size);
+				close(fds[k]);
+				while (waitpid(pids[k], NULL, 0) < 0  &&  errno == EINTR);
+				}
+			if (got != size)  {
+				if (fds[k] != NONE)  nforked--;
+				(*work)(k, arg, &results[k*size], size);
+				}
+			}
+		}
+
+	return(nforked);
+}
+
+
+/* Run a stream of items through a pipeline of a reader, several
+ * workers and a writer (see fanout.h), so that reading, working
+ * and writing overlap.  The reader runs in one child and deals
+ * the items round robin to the worker children.  The writer runs
+ * in the caller and collects the results in order.  Each stage
+ * talks to the next through a pipe, which holds only a bounded
+ * number of items, so a stage that gets ahead waits for the next.
+ * If a child dies, the rest of the stream is done in the caller,
+ * so the reader must be able to produce any item on its own.
+ * Returns the number of items.
+ */
+int fan_pipeline(int (*reader)(), void (*work)(), void (*writer)(),
+                 char *arg, int insize, int outsize)
+{
+	int		nwork, w, k;
+	int		outfds[FANMAX];
+	pid_t	pids[FANMAX+1];
+	char	*inbuf, *outbuf;
+	armark	mark;
+
+	ar_mark(&fanarena, &mark);
+	inbuf = ar_alloc(&fanarena, insize);
+	outbuf = ar_alloc(&fanarena, outsize);
+
+	k = 0;
+	nwork = fan_limit();
+	if (nwork >= 2
+	 && fan_pstart(nwork, reader, work, arg, insize, outsize, pids, outfds))  {
+		for (k = 0 ; ; k++)  {
+			w = k % nwork;
+			if (fan_read(outfds[w], outbuf, outsize) != outsize)  break;
+			(*writer)(k, arg, outbuf, outsize);
+			}
+		if (fan_pstop(nwork, pids, outfds, w))  {
+			ar_release(&fanarena, &mark);
+			return(k);
+			}
+		}
+
+	for ( ; (*reader)(k, arg, inbuf, insize) ; k++)  {
+		(*work)(k, arg, inbuf, insize, outbuf, outsize);
+		(*writer)(k, arg, outbuf, outsize);
+		}
+	ar_release(&fanarena, &mark);
+	return(k);
+}
+
+
+/* Start the reader and nwork worker processes of a pipeline.
+ * Pids[0] is the reader and pids[w+1] is worker w, whose results
+ * can be read from outfds[w].
+ * Returns FALSE, with no process left running, if they cannot
+ * all be started.
+ */
+int fan_pstart(int nwork, int (*reader)(), void (*work)(), char *arg,
+               int insize, int outsize, pid_t *pids, int *outfds)
+{
+	int		infds[FANMAX][2];
+	int		wfds[FANMAX];
+	int		pfd[2];
+	int		i, w, k, n, ok;
+	char	*inbuf, *outbuf;
+
+	/* Worker w reads its items from infds[w] and writes to wfds[w]. */
+	for (n = 0 ; n < nwork ; n++)  {
+		if (pipe(infds[n]) < 0)  break;
+		if (pipe(pfd) < 0)  {
+			close(infds[n][0]);
+			close(infds[n][1]);
+			break;
+			}
+		outfds[n] = pfd[0];
+		wfds[n] = pfd[1];
+		}
+	ok = (n == nwork);
+	fflush(stdout);
+
+	for (i = 0 ; ok  &&  i <= nwork ; i++)  {
+		if ((pids[i] = fork()) < 0)  {
+			ok = FALSE;
+			break;
+			}
+		if (pids[i] != 0)  continue;
+
+		/* In the child, keep only the ends this stage uses. */
+		for (w = 0 ; w < nwork ; w++)  {
+			close(outfds[w]);
+			if (i != w+1)  {
+				close(infds[w][0]);
+				close(wfds[w]);
+				}
+			if (i != 0)  close(infds[w][1]);
+			}
+		inbuf = ar_alloc(&fanarena, insize);
+		outbuf = ar_alloc(&fanarena, outsize);
+		if (i == 0)  {
+			for (k = 0 ; (*reader)(k, arg, inbuf, insize) ; k++)  {
+				if (fan_write(infds[k % nwork][1], inbuf, insize) != insize)
+					_exit(1);
+				}
+			_exit(0);
+			}
+		w = i - 1;
+		for (k = w ; fan_read(infds[w][0], inbuf, insize) == insize ; k += nwork)  {
+			(*work)(k, arg, inbuf, insize, outbuf, outsize);
+			if (fan_write(wfds[w], outbuf, outsize) != outsize)  _exit(1);
+			}
+		_exit(0);
+		}
+
+	for (w = 0 ; w < n ; w++)  {
+		close(infds[w][0]);
+		close(infds[w][1]);
+		close(wfds[w]);
+		if (!ok)  close(outfds[w]);
+		}
+	if (!ok)  {
+		for (w = 0 ; w < i ; w++)  {
+			kill(pids[w], SIGKILL);
+			fan_pwait(pids[w]);
+			}
+		}
+	return(ok);
+}
+
+
+/* Wait for the processes of a pipeline once the writer has found
+ * no result from worker w.  Returns TRUE if that is because the
+ * reader ran out of items, or FALSE if a child died, in which case
+ * the rest are stopped.
+ */
+int fan_pstop(int nwork, pid_t *pids, int *outfds, int w)
+{
+	int		i, ok;
+
+	ok = fan_pwait(pids[w+1]);
+	pids[w+1] = NONE;
+	for (i = 0 ; i < nwork ; i++)  close(outfds[i]);
+	for (i = 0 ; i <= nwork ; i++)  {
+		if (pids[i] == NONE)  continue;
+		if (!ok)  kill(pids[i], SIGKILL);
+		if (!fan_pwait(pids[i]))  ok = FALSE;
+		}
+	return(ok);
+}
+
+
+/* Wait for process pid.  Returns TRUE if it exited normally.
+ */
+int fan_pwait(pid_t pid)
+{
+	int		status;
+
+	while (waitpid(pid, &status, 0) < 0)  {
+		if (errno != EINTR)  return(FALSE);
+		}
+	return(WIFEXITED(status)  &&  WEXITSTATUS(status) == 0);
+}
+
+
+/* Return the number of processes to run at once.
+ * The shell variable named by FANVAR overrides the processor count.
+ */
+int fan_limit(void)
+{
+	char	*var;
+	long	n;
+
+	n = 0;
+	if ((var = getenv(FANVAR)) != NULL)
+		n = atoi(var);
+	if (n <= 0)
+		n = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n < 1)  n = 1;
+	if (n > FANMAX)  n = FANMAX;
+	return((int) n);
+}
+
+
+/* Write all of buf to fd.  Returns the number of bytes written.
+ */
+int fan_write(int fd, char *buf, int size)
+{
+	int		done, n;
+
+	for (done = 0 ; done < size ; done += n)  {
+		n = write(fd, &buf[done], size - done);
+		if (n < 0  &&  errno == EINTR)  {
+			n = 0;
+			continue;
+			}
+		if (n <= 0)  break;
+		}
+	return(done);
+}
+
+
+/* Read up to size bytes from fd into buf, stopping early at end
+ * of file.  Returns the number of bytes read.
+ */
+int fan_read(int fd, char *buf, int size)
+{
+	int		done, n;
+
+	for (done = 0 ; done < size ; done += n)  {
+		n = read(fd, &buf[done], size - done);
+		if (n < 0  &&  errno == EINTR)  {
+			n = 0;
+			continue;
+			}
+		if (n <= 0)  break;
+		}
+	return(done);
+}
@@ -0,0 +1,39 @@
+#ifndef __FANOUT_H
+#define __FANOUT_H
+
+/*
+ * Declarations for running independent pieces of work in parallel.
+ *
+ * Each piece of work runs in a forked copy of the program, so it
+ * sees a private snapshot of all the global tables and can use the
+ * guessing engines without disturbing the caller.  The result comes
+ * back through a pipe as a fixed size buffer.
+ */
+
+
+#define	FANMAX		64		/* Max pieces of work in one call. */
+#define	FANVAR		"CBWWORKERS"	/* Shell var limiting # processes. */
+
+
+/* The work routine is called as (*work)(k, arg, result, size).
+ * It must fill in result[0 .. size-1] for piece k and must not
+ * touch the screen.
+ */
+extern	int	fanout(/* nwork, work, arg, results, size */);
+extern	int	fan_limit(/* */);	/* Max processes run at once. */
+
+/* The stages of a pipeline are called as
+ * (*reader)(k, arg, in, insize), which fills in item k and returns
+ * FALSE if there is no item k, (*work)(k, arg, in, insize, out, outsize),
+ * which turns item k into its result, and (*writer)(k, arg, out, outsize),
+ * which is given the results in order.  Only the writer may touch
+ * the screen.
+ */
+extern	int	fan_pipeline(/* reader, work, writer, arg, insize, outsize */);
+
+/* The buffers of a call come from fanarena (see arena.h), and are
+ * given back when it returns.
+ */
+extern	struct	xarena	fanarena;
+
+#endif /* __FANOUT_H */
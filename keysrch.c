@@ -0,0 +1,653 @@
+/*
+ * Batch program that searches for the key of a file.
+ *
+ * Once cbw has found some wires, every candidate key can be checked
+ * by building the rotor crypt makes from it and comparing its block
+ * permutations with those wires.  The candidates come from a word
+ * list run through the mangler, and are split among processes that
+ * each make the whole stream of keys but only try their own share.
+ * When the key is found, every block permutation and Zee follow
+ * from it and are saved in the .perm file.
+ *
+ * With -x every key made from a set of chars, in a range of lengths,
+ * is tried instead.  The keys are numbered and cut into chunks, and
+ * each round of the search gives one chunk to each process.  After
+ * a round the number of the next chunk is saved, so an interrupted
+ * search carries on from there, with any number of processes.  If
+ * too few wires are known to pick out the key, a key is kept if it
+ * decodes block 0 of the cipher into text.
+ *
+ * Keys are tried BSLANES at a time, so that makekey, most of the
+ * cost of a key, is done for all of them at once by the bitsliced
+ * DES in bsdes.c.  That is checked against crypt(3) when the search
+ * starts, and crypt(3) is used instead if they disagree.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<time.h>
+#include	<unistd.h>
+#include	"window.h"
+#include	"specs.h"
+#include	"fanout.h"
+#include	"rotor.h"
+#include	"mangle.h"
+#include	"bsdes.h"
+
+
+#define	ROOTLEN		1000		/* Max length of a file name root. */
+#define	KSMINWIRES	8			/* Fewer known wires can't pick out a key. */
+#define	KSWRONGFRAC	10			/* Allow one in this many wires wrong. */
+#define	KSMAXWIRES	(NPERMS*BLOCKSIZE/2)
+
+#define	KXFLAG		"-x"
+#define	KXCHUNK		65536		/* Keys in a chunk of the key space. */
+#define	KXREPORT	10			/* Seconds between progress lines. */
+#define	KXODDFRAC	32			/* One in this many chars of block 0 may not be text. */
+#define	KXSHOW		60			/* Chars of block 0 shown for a key. */
+#define	LETTERSTATS	"LETTERSTATS"
+#define	BIGRAMSTATS	"BIGRAMSTATS"
+
+
+/* A known wire. */
+#define	kswire	struct xkswire
+kswire	{
+		int		blknum;
+		int		x, y;
+		};
+
+#define	ksinfo	struct xksinfo
+ksinfo	{
+		char	*wordfile;
+		int		npieces;		/* Processes sharing the search. */
+		int		nwires;
+		int		maxwrong;		/* Wrong wires allowed in a match. */
+		kswire	wires[KSMAXWIRES];
+		int		nblock0;		/* Chars of block 0 read. */
+		int		block0[BLOCKSIZE];
+		};
+
+/* An exhaustive search of the keys made from cs. */
+#define	kxinfo	struct xkxinfo
+kxinfo	{
+		char	cs[MAXCHAR+2];	/* Chars the keys are made of. */
+		int		ncs;
+		int		minlen, maxlen;
+		long long	count[ROTKEYLEN+1];	/* Keys of each length. */
+		long long	total;
+		long long	nchunks;
+		long long	first;		/* First chunk of this round. */
+		char	ckptfile[ROOTLEN+10];
+		ksinfo	*ksi;			/* Known wires. */
+		};
+
+/* What one piece of the search found. */
+#define	ksresult	struct xksresult
+ksresult	{
+		int		found;
+		char	pw[ROTKEYLEN+1];
+		int		nwrong;			/* Wires the key disagrees with. */
+		long	nwords;
+		long	nkeys;			/* Keys made from the list. */
+		long	ndups;			/* Duplicates skipped. */
+		long	ntried;			/* Keys this piece tried. */
+		};
+
+
+extern	int	kzee[];
+
+/* Forward declarations */
+void ks_setroot(char *root);
+void ks_load(ksinfo *ksi, char *filename);
+void ks_piece(int k, char *arg, char *result, int size);
+void ks_selftest(void);
+int ks_batch(ksinfo *ksi, char pws[][ROTKEYLEN+1], int n, int *nwrongp);
+int ks_check(ksinfo *ksi, rotor *rot);
+int ks_block0(ksinfo *ksi, rotor *rot, int *pbuf);
+void ks_save(char *pw);
+void kx_main(int argc, char *argv[]);
+int kx_charset(char *spec, char *cs);
+void kx_key(kxinfo *kxi, long long idx, char *pw);
+void kx_piece(int k, char *arg, char *result, int size);
+long long kx_resume(kxinfo *kxi);
+void kx_checkpoint(kxinfo *kxi, long long next);
+
+int		ksbitslice;				/* TRUE to use bs_makekey. */
+ksinfo	myksinfo;
+kxinfo	mykxinfo;
+ksresult	ksresults[FANMAX];
+char	cfilebuf[ROOTLEN+10];
+char	pfilebuf[ROOTLEN+10];
+
+
+int main(argc, argv)
+int		argc;
+char	*argv[];
+{
+	int		k, found;
+	long	ntried, ndups, nwords;
+	time_t	start, secs;
+	ksinfo	*ksi;
+	ksresult	*ksr;
+
+	if (argc >= 2  &&  strcmp(argv[1], KXFLAG) == 0)  {
+		kx_main(argc, argv);
+		return 0;
+		}
+	if (argc != 3)  {
+		printf("Usage: %s FileNameRoot word_file\n", argv[0]);
+		printf("   or: %s %s chars min_length max_length FileNameRoot\n",
+		       argv[0], KXFLAG);
+		printf("\tTries keys made from the words against the wires");
+		printf(" in FileNameRoot.perm.");
+		printf("\n\tWith %s, tries every key of the given lengths made", KXFLAG);
+		printf("\n\tfrom chars, which may hold ranges like a-z.");
+		printf("\n\tIf one fits, the permutations it gives are saved there.\n");
+		exit(0);
+		}
+	ks_setroot(argv[1]);
+
+	ksi = &myksinfo;
+	ksi->wordfile = argv[2];
+	ks_load(ksi, permfile);
+	if (ksi->nwires < KSMINWIRES)  {
+		printf("Only %d wires are known, at least %d are needed.\n",
+		       ksi->nwires, KSMINWIRES);
+		exit(0);
+		}
+	ksi->maxwrong = ksi->nwires / KSWRONGFRAC;
+	ksi->nblock0 = 0;
+	ksi->npieces = fan_limit();
+	ks_selftest();
+
+	printf("Trying keys from %s against %d wires", ksi->wordfile, ksi->nwires);
+	printf(" with %d processes.\n", ksi->npieces);
+	start = time(NULL);
+	fanout(ksi->npieces, ks_piece, (char *) ksi,
+	       (char *) ksresults, sizeof(ksresults[0]));
+	secs = time(NULL) - start;
+
+	found = NONE;
+	for (k = 0 ; k < ksi->npieces ; k++)  {
+		ksr = &ksresults[k];
+		if (ksr->found  &&  (found == NONE || ksr->nwrong < ksresults[found].nwrong))
+			found = k;
+		}
+	ntried = nwords = ndups = 0;
+	for (k = 0 ; k < ksi->npieces ; k++)  {
+		ksr = &ksresults[k];
+		ntried += ksr->ntried;
+		if (ksr->nwords > nwords)  nwords = ksr->nwords;
+		if (ksr->ndups > ndups)  ndups = ksr->ndups;
+		}
+	printf("Tried %ld keys from %ld words, %ld duplicates skipped, in %ld seconds.\n",
+	       ntried, nwords, ndups, (long) secs);
+
+	if (found == NONE)  {
+		printf("No key fits.\n");
+		return 0;
+		}
+	ksr = &ksresults[found];
+	printf("The key is '%s', it disagrees with %d of the wires.\n",
+	       ksr->pw, ksr->nwrong);
+	ks_save(ksr->pw);
+	printf("Permutations saved in %s.\n", permfile);
+	return 0;
+}
+
+
+/* Set cipherfile and permfile from the file name root.
+ */
+void ks_setroot(char *root)
+{
+	if (strlen(root) > ROOTLEN)  {
+		printf("The file name root %s is too long.\n", root);
+		exit(0);
+		}
+	cipherfile = cfilebuf;
+	sprintf(cipherfile, "%s.cipher", root);
+	permfile = pfilebuf;
+	sprintf(permfile, "%s.perm", root);
+}
+
+
+/* Read the permutations in filename and list their wires in ksi.
+ */
+void ks_load(ksinfo *ksi, char *filename)
+{
+	char	*msg;
+	int		b, x, y;
+	int		*perm;
+
+	if ((msg = permread(filename)) != NULL)  {
+		printf("%s\n", msg);
+		exit(0);
+		}
+
+	ksi->nwires = 0;
+	for (b = 0 ; b < NPERMS ; b++)  {
+		perm = refperm(b);
+		for (x = 0 ; x < BLOCKSIZE ; x++)  {
+			if ((y = perm[x]) == NONE  ||  y < x)  continue;
+			ksi->wires[ksi->nwires].blknum = b;
+			ksi->wires[ksi->nwires].x = x;
+			ksi->wires[ksi->nwires].y = y;
+			ksi->nwires++;
+			}
+		}
+}
+
+
+/* Try piece k of the keys, that is every ksi->npieces'th key
+ * starting with key k, and stop at the first that fits.
+ * Called through fanout, possibly in a child process.
+ */
+void ks_piece(int k, char *arg, char *result, int size)
+{
+	ksinfo		*ksi;
+	ksresult	*ksr;
+	mglinfo		mgi;
+	long		i;
+	int			n, more, hit, nwrong;
+	char		pws[BSLANES][ROTKEYLEN+1];
+
+	ksi = (ksinfo *) arg;
+	ksr = (ksresult *) result;
+	if (size < (int) sizeof(*ksr))  return;
+	ksr->found = FALSE;
+	ksr->ntried = 0;
+	ksr->nwords = ksr->nkeys = ksr->ndups = 0;
+
+	if (!mgl_open(&mgi, ksi->wordfile))  return;
+	i = 0;
+	more = TRUE;
+	while (more)  {
+		for (n = 0 ; n < BSLANES ; )  {
+			if (!(more = mgl_next(&mgi, pws[n])))  break;
+			if (i++ % ksi->npieces == k)  n++;
+			}
+		if ((hit = ks_batch(ksi, pws, n, &nwrong)) == NONE)  {
+			ksr->ntried += n;
+			continue;
+			}
+		ksr->ntried += hit + 1;
+		ksr->found = TRUE;
+		ksr->nwrong = nwrong;
+		strcpy(ksr->pw, pws[hit]);
+		break;
+		}
+	ksr->nwords = mgi.nwords;
+	ksr->nkeys = mgi.nkeys;
+	ksr->ndups = mgi.ndups;
+	mgl_close(&mgi);
+}
+
+
+/* Check that bs_makekey agrees with crypt(3), and use it if so.
+ */
+void ks_selftest(void)
+{
+	ksbitslice = bs_selftest();
+	if (!ksbitslice)
+		printf("The bitsliced DES disagrees with crypt(3), using crypt(3).\n");
+}
+
+
+/* Try the n keys in pws, at most BSLANES of them, in order.
+ * A key fits if it disagrees with no more of the known wires than
+ * allowed or, if too few are known, if it decodes block 0 into text.
+ * Returns the index of the first key that fits, with the number of
+ * wires it disagrees with in *nwrongp, or NONE.
+ */
+int ks_batch(ksinfo *ksi, char pws[][ROTKEYLEN+1], int n, int *nwrongp)
+{
+	char	bufs[BSLANES][ROTCRYPTLEN+1];
+	int		pbuf[BLOCKSIZE];
+	rotor	rot;
+	int		i, nwrong;
+
+	if (ksbitslice)
+		bs_makekey(pws, n, bufs);
+	else
+		for (i = 0 ; i < n ; i++)  rot_makekey(pws[i], bufs[i]);
+
+	for (i = 0 ; i < n ; i++)  {
+		rot_build(bufs[i], &rot);
+		if (ksi->nwires >= KSMINWIRES)  {
+			if ((nwrong = ks_check(ksi, &rot)) == NONE)  continue;
+			}
+		else  {
+			if (!ks_block0(ksi, &rot, pbuf))  continue;
+			nwrong = 0;
+			}
+		*nwrongp = nwrong;
+		return(i);
+		}
+	return(NONE);
+}
+
+
+/* Return the number of known wires that disagree with rot,
+ * or NONE if that is more than allowed.
+ */
+int ks_check(ksinfo *ksi, rotor *rot)
+{
+	kswire	*w;
+	int		i, nwrong;
+
+	nwrong = 0;
+	for (i = 0 ; i < ksi->nwires ; i++)  {
+		w = &ksi->wires[i];
+		if (rot_wire(rot, w->blknum, w->x) == w->y)  continue;
+		if (++nwrong > ksi->maxwrong)  return(NONE);
+		}
+	return(nwrong);
+}
+
+
+/* Decode block 0 of the cipher with rot into pbuf.
+ * Returns TRUE if it looks like text: no more than one char in
+ * KXODDFRAC is outside printing ascii and white space.  Most keys
+ * fail within a few chars, and then pbuf is only partly filled in.
+ */
+int ks_block0(ksinfo *ksi, rotor *rot, int *pbuf)
+{
+	int		pos, c, nodd;
+
+	nodd = 0;
+	for (pos = 0 ; pos < ksi->nblock0 ; pos++)  {
+		c = rot_wire(rot, 0, (ksi->block0[pos] + pos) & MODMASK);
+		pbuf[pos] = c = (c - pos) & MODMASK;
+		if ((c < ' '  ||  c >= MAXCHAR)  &&  c != '\n'  &&  c != '\t'
+		 && c != '\r'  &&  c != '\f')
+			if (++nodd * KXODDFRAC > ksi->nblock0)  return(FALSE);
+		}
+	return(TRUE);
+}
+
+
+/* Replace the permutations and Zee with those of the key pw, and save them.
+ */
+void ks_save(char *pw)
+{
+	rotor	rot;
+	int		b;
+
+	rot_setup(pw, &rot);
+	for (b = 0 ; b < NPERMS ; b++)  {
+		rot_blockperm(&rot, b, refperm(b));
+		}
+	rot_zee(&rot, kzee);
+	permchgflg = TRUE;
+	if (permsave(NULL) != NULL)  {
+		printf("%s\n", statmsg);
+		exit(1);
+		}
+}
+
+
+/* Run an exhaustive search, as keysrch -x chars min max root.
+ */
+void kx_main(int argc, char *argv[])
+{
+	kxinfo		*kxi;
+	ksinfo		*ksi;
+	ksresult	*ksr;
+	FILE		*fd;
+	char		*c;
+	int			k, len, npieces, found;
+	int			pbuf[BLOCKSIZE];
+	long long	next, done, ntried, start;
+	time_t		started, now, reported;
+	double		rate;
+	rotor		rot;
+
+	kxi = &mykxinfo;
+	ksi = &myksinfo;
+	kxi->ksi = ksi;
+	if (argc != 6
+	 || sscanf(argv[3], "%d", &kxi->minlen) != 1
+	 || sscanf(argv[4], "%d", &kxi->maxlen) != 1
+	 || kxi->minlen < 1  ||  kxi->maxlen > ROTKEYLEN
+	 || kxi->minlen > kxi->maxlen)  {
+		printf("Usage: %s %s chars min_length max_length FileNameRoot\n",
+		       argv[0], KXFLAG);
+		printf("\tThe lengths must be from 1 to %d.\n", ROTKEYLEN);
+		exit(0);
+		}
+	if ((kxi->ncs = kx_charset(argv[2], kxi->cs)) == 0)  {
+		printf("Could not make a set of chars from '%s'.\n", argv[2]);
+		exit(0);
+		}
+	ks_setroot(argv[5]);
+	sprintf(kxi->ckptfile, "%s.kx", argv[5]);
+
+	kxi->total = 0;
+	for (len = 1 ; len <= ROTKEYLEN ; len++)  {
+		kxi->count[len] = (len == 1) ? kxi->ncs : kxi->count[len-1] * kxi->ncs;
+		if (len >= kxi->minlen  &&  len <= kxi->maxlen)
+			kxi->total += kxi->count[len];
+		}
+	kxi->nchunks = (kxi->total + KXCHUNK - 1) / KXCHUNK;
+
+	ksi->nwires = 0;
+	if (access(permfile, F_OK) == 0)  ks_load(ksi, permfile);
+	ksi->maxwrong = ksi->nwires / KSWRONGFRAC;
+	if ((fd = fopen(cipherfile, "r")) == NULL)  {
+		printf("Could not open %s to read the cipher.\n", cipherfile);
+		exit(0);
+		}
+	for (k = 0 ; k < BLOCKSIZE  &&  (ksi->block0[k] = getc(fd)) != EOF ; k++) ;
+	ksi->nblock0 = k;
+	fclose(fd);
+	if (ksi->nwires < KSMINWIRES  &&  ksi->nblock0 == 0)  {
+		printf("%s is empty and only %d wires are known.\n", cipherfile, ksi->nwires);
+		exit(0);
+		}
+
+	start = kx_resume(kxi);
+	npieces = fan_limit();
+	ks_selftest();
+	printf("Trying %lld keys of %d to %d chars from '%s'", kxi->total,
+	       kxi->minlen, kxi->maxlen, kxi->cs);
+	if (ksi->nwires >= KSMINWIRES)
+		printf(" against %d wires", ksi->nwires);
+	else
+		printf(" against block 0");
+	printf(" with %d processes.\n", npieces);
+	if (start > 0)
+		printf("Carrying on from chunk %lld of %lld.\n", start, kxi->nchunks);
+
+	started = reported = time(NULL);
+	ntried = 0;
+	found = NONE;
+	for (next = start ; next < kxi->nchunks ; next += npieces)  {
+		kxi->first = next;
+		fanout(npieces, kx_piece, (char *) kxi,
+		       (char *) ksresults, sizeof(ksresults[0]));
+		for (k = 0 ; k < npieces ; k++)  {
+			ksr = &ksresults[k];
+			ntried += ksr->ntried;
+			if (ksr->found  &&  (found == NONE || ksr->nwrong < ksresults[found].nwrong))
+				found = k;
+			}
+		if (found != NONE)  break;
+		kx_checkpoint(kxi, next + npieces);
+
+		now = time(NULL);
+		if (now - reported < KXREPORT)  continue;
+		reported = now;
+		done = (next + npieces) * KXCHUNK;
+		if (done > kxi->total)  done = kxi->total;
+		rate = (double) ntried / (now - started);
+		printf("Tried %lld of %lld keys (%.1f%%), %.0f keys/s, about %.0f seconds left.\n",
+		       done, kxi->total, 100.0 * done / kxi->total, rate,
+		       (kxi->total - done) / rate);
+		fflush(stdout);
+		}
+	printf("Tried %lld keys in %ld seconds.\n", ntried, (long) (time(NULL) - started));
+
+	if (found == NONE)  {
+		kx_checkpoint(kxi, kxi->nchunks);
+		printf("No key fits.\n");
+		return;
+		}
+	ksr = &ksresults[found];
+	printf("The key is '%s'", ksr->pw);
+	if (ksi->nwires >= KSMINWIRES)
+		printf(", it disagrees with %d of the wires", ksr->nwrong);
+	printf(".\n");
+	rot_setup(ksr->pw, &rot);
+	ks_block0(ksi, &rot, pbuf);
+	printf("Block 0 starts: ");
+	for (k = 0 ; k < ksi->nblock0  &&  k < KXSHOW ; k++)
+		putchar((pbuf[k] >= ' '  &&  pbuf[k] < MAXCHAR) ? pbuf[k] : '.');
+	printf("\n");
+	if ((c = getenv(LETTERSTATS)) != NULL  &&  (bigramstats = getenv(BIGRAMSTATS)) != NULL)  {
+		letterstats = c;
+		for (k = ksi->nblock0 ; k < BLOCKSIZE ; k++)  pbuf[k] = NONE;
+		printf("Block 0 scores %.1f as english.\n", pbuf_2score(pbuf));
+		}
+	ks_save(ksr->pw);
+	printf("Permutations saved in %s.\n", permfile);
+}
+
+
+/* Expand spec, in which a-z stands for the chars a through z, into
+ * cs without repeats.  Returns the number of chars, or 0 if there
+ * are none or one is not a printing ascii char.
+ */
+int kx_charset(char *spec, char *cs)
+{
+	char	seen[MAXCHAR+1];
+	int		c, lo, hi, n;
+
+	for (c = 0 ; c <= MAXCHAR ; c++)  seen[c] = FALSE;
+	n = 0;
+	while (*spec != '\0')  {
+		lo = hi = *spec++ & 0377;
+		if (*spec == '-'  &&  spec[1] != '\0')  {
+			hi = spec[1] & 0377;
+			spec += 2;
+			}
+		if (lo <= ' '  ||  hi >= MAXCHAR  ||  lo > hi)  return(0);
+		for (c = lo ; c <= hi ; c++)  {
+			if (seen[c])  continue;
+			seen[c] = TRUE;
+			cs[n++] = c;
+			}
+		}
+	cs[n] = '\0';
+	return(n);
+}
+
+
+/* Put key number idx in pw.  The keys are numbered shortest first,
+ * and within a length in the order of cs, last char fastest.
+ */
+void kx_key(kxinfo *kxi, long long idx, char *pw)
+{
+	int		len, i;
+
+	for (len = kxi->minlen ; len < kxi->maxlen ; len++)  {
+		if (idx < kxi->count[len])  break;
+		idx -= kxi->count[len];
+		}
+	for (i = len - 1 ; i >= 0 ; i--)  {
+		pw[i] = kxi->cs[idx % kxi->ncs];
+		idx /= kxi->ncs;
+		}
+	pw[len] = '\0';
+}
+
+
+/* Try chunk first+k of the keys, and stop at the first that fits.
+ * Called through fanout, possibly in a child process.
+ */
+void kx_piece(int k, char *arg, char *result, int size)
+{
+	kxinfo		*kxi;
+	ksresult	*ksr;
+	long long	idx, end;
+	int			n, hit, nwrong;
+	char		pws[BSLANES][ROTKEYLEN+1];
+
+	kxi = (kxinfo *) arg;
+	ksr = (ksresult *) result;
+	if (size < (int) sizeof(*ksr))  return;
+	ksr->found = FALSE;
+	ksr->ntried = 0;
+	ksr->nwords = ksr->nkeys = ksr->ndups = 0;
+
+	idx = (kxi->first + k) * KXCHUNK;
+	end = idx + KXCHUNK;
+	if (end > kxi->total)  end = kxi->total;
+	while (idx < end)  {
+		for (n = 0 ; n < BSLANES  &&  idx < end ; n++, idx++)
+			kx_key(kxi, idx, pws[n]);
+		if ((hit = ks_batch(kxi->ksi, pws, n, &nwrong)) == NONE)  {
+			ksr->ntried += n;
+			continue;
+			}
+		ksr->ntried += hit + 1;
+		ksr->found = TRUE;
+		ksr->nwrong = nwrong;
+		strcpy(ksr->pw, pws[hit]);
+		break;
+		}
+}
+
+
+/* Return the chunk to start from, as saved in the checkpoint file
+ * by a search of the same keys, or 0.
+ */
+long long kx_resume(kxinfo *kxi)
+{
+	FILE		*fd;
+	char		cs[MAXCHAR+2];
+	int			minlen, maxlen;
+	long long	next;
+
+	if ((fd = fopen(kxi->ckptfile, "r")) == NULL)  return(0);
+	if (fscanf(fd, "%d %d %lld %95s", &minlen, &maxlen, &next, cs) != 4
+	 || minlen != kxi->minlen  ||  maxlen != kxi->maxlen
+	 || strcmp(cs, kxi->cs) != 0  ||  next < 0)  {
+		printf("%s is for a different search, starting over.\n", kxi->ckptfile);
+		next = 0;
+		}
+	fclose(fd);
+	return(next);
+}
+
+
+/* Save the number of the next chunk to try in the checkpoint file.
+ * The file is written under another name and renamed, so it is
+ * never left half written.
+ */
+void kx_checkpoint(kxinfo *kxi, long long next)
+{
+	FILE	*fd;
+	char	tmpfile[ROOTLEN+20];
+
+	if (next > kxi->nchunks)  next = kxi->nchunks;
+	sprintf(tmpfile, "%s.tmp", kxi->ckptfile);
+	if ((fd = fopen(tmpfile, "w")) == NULL)  return;
+	fprintf(fd, "%d %d %lld %s\n", kxi->minlen, kxi->maxlen, next, kxi->cs);
+	if (fclose(fd) == 0)  rename(tmpfile, kxi->ckptfile);
+}
+
+
+key u_getkey(void)
+{
+	return 0;
+}
+
+keyer	topktab[] ={{0, NULL}};
+
+
+char *quitcmd(char *arg __attribute__((unused)))
+{
+	printf("\n");
+	exit(1);
+}
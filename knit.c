@@ -23,7 +23,11 @@ extern	int		gperm[];
 #define STARTMSG "Knitting from %d to %d.   Known Zee: %d of 256."
 #define GUESSMSG "guesscount = %d, xi=%d, yi=%d.   Known Zee: %d of 256."
 #define UNDOMSG  "Undone.  Current known Zee: %d of 256"
-#define	BIG		1000		/* Size of try stack in kntadvance(). */
+#define BGGAINMSG "Background knit: Zee +%d (now %d of 256)."
+#define BGCONFMSG "Background knit: a wire in block %d conflicts with Zee."
+#define	BIG		1000		/* Size of try stack in knt_propagate(). */
+#define	KNTMINAGREE	3		/* Agreements knt_autoknit needs to keep a guess, */
+#define	KNTMARGIN	2		/* and how many more than the next best. */
 
 
 /* Pack and unpack two bytes into an integer. */
@@ -37,6 +41,7 @@ struct	xkntinfo	{
 		char	*cbuf;		/* The cipher block. */
 		int		*pbuf;		/* The derived guess plaintext, -1 = none. */
 		int		*perm;		/* Permutation of block highbnum+1. */
+		int		xpass;		/* 0 = ends of chains in Zee, 1 = the rest. */
 		int		xindex;		/* Starting position of next x guess. */
 		int		yindex;		/* Starting position of next y guess. */
 		int		*zee;		/* Knitting matrix. */
@@ -47,6 +52,8 @@ struct	xkntinfo	{
 		int		lowbnum;	/* Block number of lowest source. */
 		int		highbnum;	/* Block number of highest source. */
 		int		min_show;	/* Smallest count to show. */
+		int		nagree;		/* Deductions of the last knt_propagate */
+							/* that Zee already held. */
 		};
 
 /* Keystroke handler table. */
@@ -55,6 +62,13 @@ struct	xkntinfo	{
 /* Forward declarations */
 void initknt(void);
 int kntadvance(kntinfo *knti);
+int knt_propagate(kntinfo *knti, int x, int y);
+int knt_shortcycle(kntinfo *knti, int x, int y);
+void kntbackground(void);
+int kntbgseed(kntinfo *knti, int b, int x, int *gainedp);
+int knt_autoknit(int low, int high);
+void knt_unwind(kntinfo *knti, int *stkp);
+void kntsetup(void);
 void kntundo(gwindow *knt);
 void kntnextg(gwindow *knt);
 void kntenter(gwindow *knt);
@@ -84,6 +98,12 @@ int		kustk[BLOCKSIZE+1];
 
 kntinfo	kntprivate;
 
+/* State of the background and automatic knitters. */
+kntinfo	kbgprivate;
+int		kbgstk[BLOCKSIZE+1];
+int		kbgread = 0;		/* Journal entries already seen. */
+int		kbgrescan = FALSE;	/* True to reexamine every wire. */
+
 int		kntinit	= FALSE;
 
 
@@ -156,6 +176,7 @@ char *kntguess(char *str)
 		return("Bad to: value");
 		}
 	decode(knti->cbuf, knti->pbuf, knti->perm);
+	knti->xpass = 0;
 	knti->xindex = 0;
 	knti->yindex = 0;
 	knti->lowbnum = from;
@@ -241,6 +262,8 @@ void kntclrlast(kntinfo *knti)
  * This modifies zee, zeeinv, and perm.  Perm only contains the
  * info derived from this guess, while zee and zeeinv accumulate
  * information from all preceeding accepted guesses.
+ * Guesses that extend a chain of Zee (x is the end of a chain) are
+ * shown before the guesses that start a new chain.
  * Returns the number of guesses that we derived from the initial one.
  * If out of acceptable guesses, returns 0.
  * Perm must be cleared before calling this.
@@ -248,100 +271,341 @@ void kntclrlast(kntinfo *knti)
 int kntadvance(kntinfo *knti)
 {
 	int		guesscount;
-	int		i;
 	int		tmpv;		/* For unpack. */
 	int		x,y;
 	int		tx,ty;
 	int		v;
-	int		tu,tv;
-	int		*a2;		/* The permutation as in u = A2 x */
-	int		*a1;		/* The permutation as in v = A1 y */
 	int		*propp;		/* Temp for undo stack propagation. */
 	int		*highperm;	/* Perm used to derive next perm. */
-	int		trycount;	/* Size of trystk. */
-	int		*tstkp;		/* Stack of guesses to check. */
-	int		trystk[BIG];
 
 /* kntadvance(knti)
  */
 	guesscount = 0;		/* In case loop body never executes. */
 
-	if (knti->xindex >= BLOCKSIZE)  return(0);
 	if (knti->yindex >= BLOCKSIZE)  {
 		knti->yindex = 0;
 		knti->xindex++;
 		}
 
-	for (x = knti->xindex ; x < BLOCKSIZE ; x++) {
-		if (knti->zee[x] != -1)  {
-			knti->yindex = 0;
-			continue;
-			}
-		for (y = knti->yindex ; y < BLOCKSIZE ; y++) {
-			if (knti->zeeinv[y] != -1)  continue;
-			guesscount = 0;
-			tstkp = trystk;					/* Assume ustkp == undostk. */
-			trycount = 0;
-			*(tstkp++) = pack(x,y);
-			trycount++;
-
-			while (tstkp > trystk) {
-				unpack(tx, ty, *(--tstkp));
-				trycount--;
-				if (knti->zee[tx] == -1 && knti->zeeinv[ty] == -1) {
-					knti->zee[tx] = ty;
-					knti->zeeinv[ty] = tx;
-					*((knti->ustkp)++) = pack(tx,ty);
-					guesscount++;
-					for (i = knti->lowbnum ; (i+1) <= knti->highbnum ; i++) {
-						a1 = refperm(i);
-						a2 = refperm(i+1);
-						tu = a2[tx];
-						tv = a1[ty];
-						if (tu != -1 && tv != -1 && trycount < BIG) {
-							*(tstkp++) = pack(tu, tv);
-							trycount++;
-							}
-						}
-					}
-				else if (knti->zee[tx] != ty
-					  || knti->zeeinv[ty] != tx) {		/* If conflict. */
-						while (knti->ustkp > knti->undostk)  {
-							unpack(tx, ty, *(--(knti->ustkp)));
-							knti->zee[tx] = -1;
-							knti->zeeinv[ty] = -1;
-							guesscount--;
-							}
-						knti->ustkp = knti->undostk;
-						goto nxtguess;
-					  }
-				else continue;		/* Already know about it. */
+	for ( ; knti->xpass < 2 ; knti->xpass++, knti->xindex = 0)  {
+		for (x = knti->xindex ; x < BLOCKSIZE ; x++) {
+			if (knti->zee[x] != -1
+			 || (knti->zeeinv[x] != -1) != (knti->xpass == 0))  {
+				knti->yindex = 0;
+				continue;
 				}
+			for (y = knti->yindex ; y < BLOCKSIZE ; y++) {
+				if (knti->zeeinv[y] != -1)  continue;
+				guesscount = knt_propagate(knti, x, y);
+				if (guesscount < 0)  {
+					guesscount = 0;
+					continue;
+					}
 
-			knti->xindex = x;		/* Zee[x] = y was a good guess. */
-			knti->yindex = y+1;
-			propp = knti->ustkp;
-			highperm = refperm(knti->highbnum);
-			while (propp > knti->undostk) {  /* Update perm. */
-				unpack(tx, ty, *(--propp));
-				v = highperm[ty];
-				if (v != -1  &&  (tmpv = knti->zeeinv[v]) != -1)  {
-					knti->perm[tx] = tmpv;
-					knti->perm[tmpv] = tx;
+				knti->xindex = x;		/* Zee[x] = y was a good guess. */
+				knti->yindex = y+1;
+				propp = knti->ustkp;
+				highperm = refperm(knti->highbnum);
+				while (propp > knti->undostk) {  /* Update perm. */
+					unpack(tx, ty, *(--propp));
+					v = highperm[ty];
+					if (v != -1  &&  (tmpv = knti->zeeinv[v]) != -1)  {
+						knti->perm[tx] = tmpv;
+						knti->perm[tmpv] = tx;
+						}
 					}
+				return (guesscount);
 				}
-			return (guesscount);
-			nxtguess: ;
+			knti->yindex = 0;
 			}
-		knti->yindex = 0;
 		}
 
 	knti->yindex = 0;
 	knti->xindex = 0;
+	knti->xpass = 0;
 	return(guesscount);
 }
 			 
 
+/* Add zee[x] = y and everything the known blocks lowbnum through
+ * highbnum deduce from it, pushing each new entry of zee on the
+ * undo stack.  Deductions that zee already holds are counted in
+ * knti->nagree.  Returns the number of new entries, or -1 if the
+ * deductions conflict with zee, in which case zee and the undo
+ * stack are left as they were.
+ * Since Zee is the rotor's step by one seen through the rotor, it
+ * is a single cycle of length 256, so an entry that closes a
+ * shorter cycle is a conflict too.
+ */
+int knt_propagate(kntinfo *knti, int x, int y)
+{
+	int		guesscount;
+	int		i;
+	int		tmpv;		/* For unpack. */
+	int		tx,ty;
+	int		tu,tv;
+	int		*a2;		/* The permutation as in u = A2 x */
+	int		*a1;		/* The permutation as in v = A1 y */
+	int		*entryp;	/* Undo stack pointer on entry. */
+	int		trycount;	/* Size of trystk. */
+	int		*tstkp;		/* Stack of guesses to check. */
+	int		trystk[BIG];
+	int		fromstk[BIG];	/* Block that deduced each one, or -1. */
+	int		from;
+
+	guesscount = 0;
+	knti->nagree = 0;
+	entryp = knti->ustkp;
+	tstkp = trystk;
+	trycount = 0;
+	*(tstkp++) = pack(x,y);
+	fromstk[trycount++] = -1;
+
+	while (tstkp > trystk) {
+		unpack(tx, ty, *(--tstkp));
+		from = fromstk[--trycount];
+		if (knti->zee[tx] == -1 && knti->zeeinv[ty] == -1) {
+			if (knt_shortcycle(knti, tx, ty))  {
+				knt_unwind(knti, entryp);
+				return(-1);
+				}
+			knti->zee[tx] = ty;
+			knti->zeeinv[ty] = tx;
+			*((knti->ustkp)++) = pack(tx,ty);
+			guesscount++;
+			for (i = knti->lowbnum ; (i+1) <= knti->highbnum ; i++) {
+				if (i == from)  continue;	/* Only leads back to x,y. */
+				a1 = refperm(i);
+				a2 = refperm(i+1);
+				tu = a2[tx];
+				tv = a1[ty];
+				if (tu != -1 && tv != -1 && trycount < BIG) {
+					*(tstkp++) = pack(tu, tv);
+					fromstk[trycount++] = i;
+					}
+				}
+			}
+		else if (knti->zee[tx] != ty
+			  || knti->zeeinv[ty] != tx) {		/* If conflict. */
+				knt_unwind(knti, entryp);
+				return(-1);
+			  }
+		else knti->nagree++;		/* Already know about it. */
+		}
+
+	return(guesscount);
+}
+
+
+/* Return TRUE if zee[x] = y would close a cycle in Zee shorter
+ * than BLOCKSIZE.  Zee[x] and zeeinv[y] must be unknown, so y
+ * starts a chain, and the cycle is closed if that chain ends at x.
+ */
+int knt_shortcycle(kntinfo *knti, int x, int y)
+{
+	int		v, n;
+
+	n = 1;
+	for (v = y ; v != x ; v = knti->zee[v])  {
+		if (v == -1  ||  n >= BLOCKSIZE)  return(FALSE);
+		n++;
+		}
+	return(n < BLOCKSIZE);
+}
+
+
+/* Called between keystrokes to extend Zee with what the wires set
+ * since the last call imply.  A new wire in block b that meets a
+ * known entry of Zee through block b-1 or b+1 seeds the same
+ * propagation the knit command uses, over all the blocks.
+ * Nothing is done while a knit guess is showing or can be undone,
+ * and a seed that conflicts with Zee is dropped and reported.
+ * Zee only grows when the knit relation forces it, so what is
+ * added is the same as rerunning the knit command would find.
+ */
+void kntbackground(void)
+{
+	int		gained, conflict;
+	int		b, x;
+	dbsjentry	*j;
+	kntinfo	*knti;
+	int		*perm;
+
+	knti = &kbgprivate;
+	if (kntprivate.ustkp != kntprivate.undostk
+	 || kntprivate.savedustkp != kntprivate.undostk)  return;
+	if (kbgread == dbsjcount  &&  !kbgrescan)  return;
+	if (!kntinit)  {			/* Zee is empty, nothing to seed. */
+		kbgread = dbsjcount;
+		return;
+		}
+
+	knti->zee = kzee;
+	knti->zeeinv = kzeeinv;
+	knti->undostk = kbgstk;
+	knti->ustkp = knti->savedustkp = knti->undostk;
+	knti->lowbnum = 0;
+	knti->highbnum = NPERMS - 1;
+
+	gained = 0;
+	conflict = NONE;
+	if (kbgrescan  ||  dbsjcount - kbgread > DBSJSIZE)  {
+		for (b = 0 ; b < NPERMS ; b++)  {
+			perm = refperm(b);
+			for (x = 0 ; x < BLOCKSIZE ; x++)  {
+				if (perm[x] == NONE)  continue;
+				if (!kntbgseed(knti, b, x, &gained))  conflict = b;
+				}
+			}
+		}
+	else  {
+		for ( ; kbgread < dbsjcount ; kbgread++)  {
+			j = &dbsjournal[kbgread % DBSJSIZE];
+			perm = refperm(j->blknum);
+			if (perm == NULL  ||  perm[j->x] != j->y)  continue;
+			if (!kntbgseed(knti, j->blknum, j->x, &gained)
+			 || !kntbgseed(knti, j->blknum, j->y, &gained))
+				conflict = j->blknum;
+			}
+		}
+	kbgread = dbsjcount;
+	kbgrescan = FALSE;
+
+	if (conflict != NONE)  {
+		sprintf(statmsg, BGCONFMSG, conflict);
+		usrstatus(&user, statmsg);
+		}
+	else if (gained > 0)  {
+		sprintf(statmsg, BGGAINMSG, gained, permcount(kzee));
+		usrstatus(&user, statmsg);
+		}
+}
+
+
+/* Propagate the entries of Zee implied by end point x of a wire in
+ * block b, adding the number of new entries to *gainedp.
+ * Returns FALSE if one of them conflicts with Zee.
+ */
+int kntbgseed(kntinfo *knti, int b, int x, int *gainedp)
+{
+	int		n;
+	int		ok;
+	int		*perm, *other;
+
+	ok = TRUE;
+	perm = refperm(b);
+
+	/* As block i+1: zee[x] = z gives zee[perm[x]] = other[z]. */
+	if (b > 0  &&  knti->zee[x] != NONE)  {
+		other = refperm(b - 1);
+		if (other[knti->zee[x]] != NONE)  {
+			n = knt_propagate(knti, perm[x], other[knti->zee[x]]);
+			if (n < 0)  ok = FALSE;
+			else  *gainedp += n;
+			}
+		}
+
+	/* As block i: zee[z] = x gives zee[other[z]] = perm[x]. */
+	if (b + 1 < NPERMS  &&  knti->zeeinv[x] != NONE)  {
+		other = refperm(b + 1);
+		if (other[knti->zeeinv[x]] != NONE)  {
+			n = knt_propagate(knti, other[knti->zeeinv[x]], perm[x]);
+			if (n < 0)  ok = FALSE;
+			else  *gainedp += n;
+			}
+		}
+
+	knti->ustkp = knti->undostk;		/* Keep what was deduced. */
+	return(ok);
+}
+
+
+/* Extend Zee using blocks low through high without asking the user.
+ * For each unknown entry zee[x], every y is tried as in kntadvance.
+ * Partly solved blocks let a wrong guess run as far as the right
+ * one, so the number of entries a guess deduces says little.  What
+ * tells them apart is how many deductions land on entries Zee
+ * already holds, including ones the guess itself just added: the
+ * right guess is confirmed each time the blocks lead back to a
+ * known entry, while a wrong one conflicts there.  The guess is kept
+ * if it is the only one that does not conflict, or if it has at
+ * least KNTMINAGREE agreements and KNTMARGIN more than any other.
+ * The ends of chains are tried first, as what they add shortens the
+ * chains that can close a cycle too soon.
+ * Returns the number of entries added to Zee.
+ */
+int knt_autoknit(int low, int high)
+{
+	int		x, y, n;
+	int		nok, goody;
+	int		best, next;
+	int		added, passadded;
+	int		ends;
+	kntinfo	*knti;
+
+	kntsetup();
+	knti = &kbgprivate;
+	knti->zee = kzee;
+	knti->zeeinv = kzeeinv;
+	knti->undostk = kbgstk;
+	knti->ustkp = knti->savedustkp = knti->undostk;
+	knti->lowbnum = low;
+	knti->highbnum = high;
+
+	added = 0;
+	do  {
+		passadded = 0;
+		for (ends = 1 ; ends >= 0 ; ends--)  {
+			for (x = 0 ; x < BLOCKSIZE ; x++)  {
+				if (knti->zee[x] != NONE)  continue;
+				if ((knti->zeeinv[x] != NONE) != ends)  continue;
+				nok = 0;
+				goody = NONE;
+				best = next = 0;
+				for (y = 0 ; y < BLOCKSIZE ; y++)  {
+					if (knti->zeeinv[y] != NONE)  continue;
+					n = knt_propagate(knti, x, y);
+					if (n < 0)  continue;
+					knt_unwind(knti, knti->undostk);
+					nok++;
+					if (nok == 1  ||  knti->nagree > best)  {
+						if (nok > 1)  next = best;
+						best = knti->nagree;
+						goody = y;
+						}
+					else if (knti->nagree > next)  {
+						next = knti->nagree;
+						}
+					}
+				if (nok == 1
+				 || (best >= KNTMINAGREE  &&  best >= next + KNTMARGIN))  {
+					passadded += knt_propagate(knti, x, goody);
+					knti->ustkp = knti->undostk;
+					}
+				}
+			}
+		added += passadded;
+		} while (passadded > 0);
+
+	return(added);
+}
+
+
+/* Remove the entries of Zee pushed on the undo stack above stkp.
+ */
+void knt_unwind(kntinfo *knti, int *stkp)
+{
+	int		tmpv;	/* For unpack. */
+	int		x,y;
+
+	while (knti->ustkp > stkp)  {
+		unpack(x, y, *(--(knti->ustkp)));
+		knti->zee[x] = -1;
+		knti->zeeinv[y] = -1;
+		}
+}
+
+
 /* Enter our current guess into the decryption block.
  * Clear out the undo stack.
  */
@@ -438,10 +702,10 @@ void storezee(FILE *fd)
 }
 
 
-/* Load the Zee permutation from a file.
+/* Load the Zee permutation read from a file.
  * Update display if necessary.
  */
-void loadzee(FILE *fd)
+void loadzee(int *zee)
 {
 	int		i;
 	kntinfo	*knti;
@@ -451,7 +715,8 @@ void loadzee(FILE *fd)
 	kntinit = TRUE;
 	kntclrzee(knti);		/* Clear zeeinv */
 
-	readperm(fd, kzee);	
+	copyperm(zee, kzee);
+	kbgrescan = TRUE;
 	for (i = 0 ; i < BLOCKSIZE ; i++) {
 		if (kzee[i] != -1)  {kzeeinv[kzee[i]] = i;}
 		}
@@ -470,6 +735,18 @@ void loadzee(FILE *fd)
 }
 
 
+/* Make sure Zee has been cleared before it is first used.
+ */
+void kntsetup(void)
+{
+	if (!kntinit)  {
+		initknt();
+		kntinit = TRUE;
+		kntclrzee(&kntprivate);
+		}
+}
+
+
 /* Set up all the pointers in kntprivate.
  */
 void initknt(void)
@@ -11,11 +11,19 @@
 #include	"layout.h"
 #include	"specs.h"
 #include	"cipher.h"
+#include	"wiretab.h"
 #include	"dblock.h"
 
 #define	DEBUG		FALSE
 #define	AUTOREPEAT	1	/* Number of times to repeat guess loop. */
 
+/* Perturbations used by the randomized guesser, lp_rautoguess. */
+#define	LPORDERJIT	2.0		/* Max noise added to class reliability. */
+#define	LPLEVELJIT	0.25	/* Max fractional change in the cutoffs. */
+
+/* Relative margin by which bounds must settle lp_best_char. */
+#define	LPSLACK		1.0e-4
+
 #define	LPBLABEL1	"Bigram guess, level %6.3f, prob %6.3f  -- Wait"
 #define	LPBLABEL2	"Bigram guess, level %6.3f, prob %6.3f  -- Done"
 #define	LPBHELP "F3 enters guess, ^G undoes it."
@@ -32,11 +40,20 @@ void lpbenter();
 void lpbundo();
 void lp_init();
 void lp_autoguess();
+void lp_rautoguess();
 int lp_best_pos();
+int lp_rbest_pos();
+float lp_rand();
 int lp_best_char();
+float lp_1cscore();
+float lp_2cscore();
+float lp_2cbound();
 void lp_accept();
 
 /* Gloabal State. */
+long	lpnguess = 0;		/* Values lp_best_char had to consider. */
+long	lpnscore2 = 0;		/* Letter pair scores computed. */
+
 keyer	lpbktab[] = {
 		{CACCEPT, lpbenter},
 		{CUNDO, lpbundo},
@@ -205,6 +222,53 @@ for(repeat = 0 ; repeat < AUTOREPEAT ; repeat++)  {
 }
 
 
+/* Randomized version of lp_autoguess for multi-start guessing.
+ * The order in which classes are guessed and the two cutoffs are
+ * perturbed by a pseudo-random sequence that depends only on seed,
+ * so a run can be repeated.  A seed of zero gives lp_autoguess.
+ * Modfies eci.
+ */
+void lp_rautoguess(eci, accept_level, prob_cutoff, seed)
+reg	ecinfo	*eci;
+	float	accept_level;
+	float	prob_cutoff;
+	unsigned int	seed;
+{
+reg	int		c;
+	int		ntried;
+reg	int		classpos;
+
+	if (seed == 0)  {
+		lp_autoguess(eci, accept_level, prob_cutoff);
+		return;
+		}
+
+	accept_level *= 1.0 + LPLEVELJIT * (2.0 * lp_rand(&seed) - 1.0);
+	prob_cutoff *= 1.0 + LPLEVELJIT * (2.0 * lp_rand(&seed) - 1.0);
+
+	for (ntried = 0 ; ntried < BLOCKSIZE ; ntried++)  {
+		classpos = lp_rbest_pos(eci, 2, &seed);
+		if (classpos == NONE)
+			break;
+		c = lp_best_char(eci, classpos, accept_level, prob_cutoff);
+		if (c != NONE) {
+			lp_accept(eci, classpos, c);
+			}
+		}
+}
+
+
+/* Return the next number in [0,1) from the pseudo-random
+ * sequence whose state is *seedp.
+ */
+float lp_rand(seedp)
+unsigned int	*seedp;
+{
+	*seedp = (*seedp * 1103515245 + 12345) & 0xFFFFFFFF;
+	return(((*seedp >> 8) & 0xFFFF) / 65536.0);
+}
+
+
 /* Score a guess using letter pair statistics.
  * Bigger scores are better scores.  They range from 0 to 1.
  * A score of zero means the choice is not possible.
@@ -215,27 +279,68 @@ for(repeat = 0 ; repeat < AUTOREPEAT ; repeat++)  {
 float	lp_cscore(gsi)
 reg	gsinfo	*gsi;
 {
-	extern	float	score2_scale, score1_scale;
-	float	score1, score2;
-reg	float	sdev1, sdev2;		/* Standard Deviation for 1st and 2nd stats. */
+	float	score1;
 	int		ccount;
 
 	for (ccount = 0 ; gsi->cpos[ccount] != NONE ; ccount++);
 
+	score1 = lp_1cscore(gsi, ccount);
+	if (score1 == 0.0)  return(0.0);
+	return(score1 * lp_2cscore(gsi, ccount));
+}
+
+
+/* Return the first order factor of lp_cscore for the ccount
+ * characters guessed in gsi, or zero if they are not possible.
+ */
+float	lp_1cscore(gsi, ccount)
+gsinfo	*gsi;
+int		ccount;
+{
+	extern	float	score1_scale;
+	float	score1;
+reg	float	sdev1;
+
 	sdev1 = gsi_1score(gsi);
 	if (sdev1 < 0.0)  return(0.0);
 	score1 = fexp(sdev1);
-	score1 = (score1 * isqrt[ccount]) / score1_scale;
+	return((score1 * isqrt[ccount]) / score1_scale);
+}
+
 
+/* Return the second order factor of lp_cscore, or zero.
+ */
+float	lp_2cscore(gsi, ccount)
+gsinfo	*gsi;
+int		ccount;
+{
+	extern	float	score2_scale;
+	float	score2;
+reg	float	sdev2;
+
+	lpnscore2++;
 	sdev2 = gsi_2score(gsi);
 	if (sdev2 < 0.0)  return(0.0);
 	score2 = fexp(sdev2);
-	score2 = (score2 * isqrt[ccount]) / score2_scale;
+	return((score2 * isqrt[ccount]) / score2_scale);
+}
 
-	return(score1 * score2);
+
+/* Return the most that lp_2cscore can give for ccount characters.
+ * Fexp is at most one, and the arithmetic is done the same way, so
+ * the bound holds for the rounded values too.
+ */
+float	lp_2cbound(ccount)
+int		ccount;
+{
+	extern	float	score2_scale;
+	float	score2;
+
+	score2 = 1.0;
+	return((score2 * isqrt[ccount]) / score2_scale);
 }
 
-
+
 /* Select best plaintext value for a ciphertext equiv class.
  * The class is identified by the position in the block of one
  * of the characters in the class.  The plaintext value for
@@ -243,6 +348,16 @@ reg	float	sdev1, sdev2;		/* Standard Deviation for 1st and 2nd stats. */
  * one of its members.  This routine returns the best plaintext
  * value for the ciphertext character at position firstpos.
  * If there is not a clear best value, NONE is returned.
+ *
+ * The letter pair score is the expensive part, so every value is
+ * first checked and given its single letter factor, which with the
+ * most the pair factor can be bounds its score.  Pair scores are
+ * then computed from the biggest bound down, and that stops as soon
+ * as the best value is known and the bounds on the total settle
+ * whether it is accepted.  The bounds are only trusted when they
+ * clear the test by LPSLACK, so that sums taken in another order
+ * cannot round to a different answer; otherwise all the scores are
+ * computed and added up in order, as if none had been skipped.
  */
 int lp_best_char(eci, firstpos, alevel, min_prob)
 reg		ecinfo	*eci;
@@ -253,15 +368,21 @@ float	min_prob;
 #if DEBUG
 	int		pvec[BLOCKSIZE+1];
 	char	str[BLOCKSIZE+1];
+	int		class;
 #endif
 	float	total_score, score;
 	float	best_score;
 	int		best_char;
 reg	int		c;
-#if DEBUG
-	int		class;
-#endif
+	int		i, j, n;
 	float	count;
+	float	bound[MAXCHAR+1];	/* Most a value can score. */
+	float	score1[MAXCHAR+1];	/* Its first order factor. */
+	float	cscore[MAXCHAR+1];	/* Its score, once computed. */
+	int		nchars[MAXCHAR+1];	/* Chars it deduces. */
+	int		left[MAXCHAR+1];	/* Values not yet scored. */
+	int		nleft;
+	float	low, high;			/* Bounds on total_score. */
 reg	gsinfo	*gsi;
 	gsinfo	tmpgsi;
 	int		gssbuf[BLOCKSIZE+1];
@@ -269,16 +390,66 @@ reg	gsinfo	*gsi;
 	gsi = &tmpgsi;
 	gsi_init(gsi, eci->plaintext, gssbuf);
 
-	total_score = 0.0;
+	/* Check each value and bound its score. */
+	nleft = 0;
+	for (c = 0 ; c <= MAXCHAR  ; c++)  {
+		cscore[c] = 0.0;
+		gsi_clear(gsi);
+		if ((n = gsi_class_guess(gsi, eci, firstpos, c)) == 0)
+			continue;
+		if ((score1[c] = lp_1cscore(gsi, n)) == 0.0)
+			continue;
+		lpnguess++;
+		nchars[c] = n;
+		bound[c] = score1[c] * lp_2cbound(n);
+		left[nleft++] = c;
+		}
+
+	/* Score them from the biggest bound down until the answer is settled. */
 	best_score = 0.0;
-	count = 0.0;
 	best_char = NONE;
+	low = 0.0;
+	for (;;)  {
+		high = low;
+		j = NONE;
+		for (i = 0 ; i < nleft ; i++)  {
+			c = left[i];
+			high += bound[c];
+			if (j == NONE  ||  bound[c] > bound[left[j]]
+			 || (bound[c] == bound[left[j]]  &&  c < left[j]))
+				j = i;
+			}
+		if (best_char != NONE  &&  (j == NONE  ||  bound[left[j]] < best_score))  {
+			if (best_score <= min_prob)
+				return(NONE);
+			if (best_score > alevel * (high * (1.0 + LPSLACK) - best_score))
+				return(best_char);
+			if (best_score <= alevel * (low * (1.0 - LPSLACK) - best_score))
+				return(NONE);
+			}
+		if (j == NONE)
+			break;
 
-	for (c = 0 ; c <= MAXCHAR  ; c++)  {
+		c = left[j];
+		left[j] = left[--nleft];
 		gsi_clear(gsi);
-		if (gsi_class_guess(gsi, eci, firstpos, c) == 0)
-			continue;
-		score = lp_cscore(gsi);
+		gsi_class_guess(gsi, eci, firstpos, c);
+		score = score1[c] * lp_2cscore(gsi, nchars[c]);
+		cscore[c] = score;
+		if (score > 0.0)  low += score;
+		if (score > best_score  ||  (score == best_score  &&  c < best_char)) {
+			best_score = score;
+			best_char = c;
+			}
+		}
+
+	/* Too close to call, so add them up in order. */
+	total_score = 0.0;
+	count = 0.0;
+	best_score = 0.0;
+	best_char = NONE;
+	for (c = 0 ; c <= MAXCHAR  ; c++)  {
+		score = cscore[c];
 		if (score > 0.0)  {
 			count += 1.0;
 			total_score += score;
@@ -451,6 +622,43 @@ reg	clinfo	*endclassp;
 }
 
 
+/* Like lp_best_pos, but add up to LPORDERJIT of noise to each
+ * class reliability so that nearly equal classes are tried in a
+ * different order for different seeds.
+ */
+int lp_rbest_pos(eci, min_reliability, seedp)
+reg		ecinfo	*eci;
+int		min_reliability;
+unsigned int	*seedp;
+{
+	int		reliability, best_pos;
+	float	score, best_score;
+reg	clinfo	*classp;
+reg	clinfo	*endclassp;
+
+	best_score = 0.0;
+	best_pos = NONE;
+	endclassp = &(eci->classlist[eci->nclasses]);
+	for (classp = &(eci->classlist[0]) ; classp < endclassp ; classp++)  {
+		if ((classp->used) || (!(classp->changed)))
+			continue;
+		reliability = (2 * (classp->npairs)) + classp->nchars;
+		if (reliability < min_reliability)
+			continue;
+		score = reliability + LPORDERJIT * lp_rand(seedp);
+		if (score > best_score)  {
+			best_score = score;
+			best_pos = classp->firstpos;
+			}
+		}
+	if (best_pos == NONE)
+		return(NONE);
+
+	eci->classlist[eci->posclass[best_pos]].changed = FALSE;
+	return(best_pos);
+}
+
+
 /* Fill in equiv class info from given ciphertext block
  * and permutation.
  */
@@ -576,6 +784,10 @@ reg	int		pos;
 
 	if (perm_conflict(eci->perm, x, y))
 		return(nchars);
+	if (!wt_ascii(eci, x, y))  {
+		*cposp = NONE;
+		return(0);
+		}
 
 	delta = y - x;
 	for_pos_in_class(pos, firstpos)  {
@@ -0,0 +1,298 @@
+/*
+ * Password mangler for the key search.
+ *
+ * Most keys are a word changed by a simple rule, and crypt only
+ * uses the first ROTKEYLEN characters of a key, so a short list of
+ * rules applied to each word of a list finds far more keys than
+ * the list alone.  The keys are made one at a time as the search
+ * asks for them, so the expanded list is never stored.  Rules that
+ * only add characters past the end of a long word are skipped, as
+ * are rules that only see the first ROTKEYLEN characters when the
+ * word starts like the one before it.  The few duplicates left are
+ * caught by a small hash table of the keys made from each word.
+ */
+
+#include	<stdio.h>
+#include	<string.h>
+#include	"window.h"
+#include	"specs.h"
+#include	"mangle.h"
+
+
+#define	MGLBUFSZ	(2*MGLMAXWORD+10)	/* Room for a mangled word. */
+#define	MGLYEAR		1950			/* First year the year rule adds. */
+#define	toupper(c)	( lletter(c) ? ((c) - 'a' + 'A') : (c) )
+
+/* One way to change a word. */
+#define	mglrule	struct xmglrule
+mglrule	{
+		char	*name;
+		int		nvar;		/* Number of variants. */
+		int		flags;		/* MGLTAIL, MGLPREFIX. */
+		void	(*make)();	/* (*make)(word, len, var, buf) */
+		};
+
+
+/* Forward declarations */
+int mgl_open(mglinfo *mgi, char *filename);
+int mgl_next(mglinfo *mgi, char *pw);
+void mgl_close(mglinfo *mgi);
+int mgl_word(mglinfo *mgi);
+int mgl_made(mglinfo *mgi, char *pw);
+void mgl_asis(char *word, int len, int var, char *buf);
+void mgl_lower(char *word, int len, int var, char *buf);
+void mgl_upper(char *word, int len, int var, char *buf);
+void mgl_capital(char *word, int len, int var, char *buf);
+void mgl_toggle(char *word, int len, int var, char *buf);
+void mgl_leet(char *word, int len, int var, char *buf);
+void mgl_digit(char *word, int len, int var, char *buf);
+void mgl_capdigit(char *word, int len, int var, char *buf);
+void mgl_twodigit(char *word, int len, int var, char *buf);
+void mgl_year(char *word, int len, int var, char *buf);
+void mgl_first(char *word, int len, int var, char *buf);
+void mgl_reverse(char *word, int len, int var, char *buf);
+void mgl_double(char *word, int len, int var, char *buf);
+
+
+/* The rules, roughly most likely first. */
+mglrule	mglrules[] = {
+		{"as is",		1,		MGLPREFIX,			mgl_asis},
+		{"lower",		1,		MGLPREFIX,			mgl_lower},
+		{"capital",		1,		MGLPREFIX,			mgl_capital},
+		{"upper",		1,		MGLPREFIX,			mgl_upper},
+		{"digit",		10,		MGLTAIL|MGLPREFIX,	mgl_digit},
+		{"capital digit", 10,	MGLTAIL|MGLPREFIX,	mgl_capdigit},
+		{"two digits",	100,	MGLTAIL|MGLPREFIX,	mgl_twodigit},
+		{"year",		80,		MGLTAIL|MGLPREFIX,	mgl_year},
+		{"leet",		1,		MGLPREFIX,			mgl_leet},
+		{"toggle",		1,		MGLPREFIX,			mgl_toggle},
+		{"digit first",	10,		MGLPREFIX,			mgl_first},
+		{"double",		1,		MGLPREFIX,			mgl_double},
+		{"reverse",		1,		0,					mgl_reverse},
+		};
+#define	MGLNRULES	((int) (sizeof(mglrules) / sizeof(mglrules[0])))
+
+/* Leet spellings, as pairs of letter and replacement. */
+char	*mglleet = "a4e3i1o0s5t7";
+
+
+/* Start making keys from the words in filename.
+ * Returns FALSE if the file cannot be read.
+ */
+int mgl_open(mglinfo *mgi, char *filename)
+{
+	int		i;
+
+	if ((mgi->fd = fopen(filename, "r")) == NULL)  return(FALSE);
+	mgi->word[0] = '\0';
+	mgi->len = 0;
+	mgi->same = FALSE;
+	mgi->rule = MGLNRULES;
+	mgi->var = 0;
+	for (i = 0 ; i < MGLHASH ; i++)  mgi->stamp[i] = 0;
+	mgi->nwords = 0;
+	mgi->nkeys = 0;
+	mgi->ndups = 0;
+	return(TRUE);
+}
+
+
+/* Put the next key, cut to ROTKEYLEN characters, in pw.
+ * Returns FALSE when the word list is used up.
+ */
+int mgl_next(mglinfo *mgi, char *pw)
+{
+	mglrule	*r;
+	char	buf[MGLBUFSZ];
+
+	for (;;)  {
+		if (mgi->rule >= MGLNRULES)  {
+			if (!mgl_word(mgi))  return(FALSE);
+			}
+		r = &mglrules[mgi->rule];
+		if (mgi->var >= r->nvar
+		 || ((r->flags & MGLTAIL)  &&  mgi->len >= ROTKEYLEN)
+		 || ((r->flags & MGLPREFIX)  &&  mgi->same))  {
+			mgi->rule++;
+			mgi->var = 0;
+			continue;
+			}
+
+		(*(r->make))(mgi->word, mgi->len, mgi->var++, buf);
+		strncpy(pw, buf, ROTKEYLEN);
+		pw[ROTKEYLEN] = '\0';
+		if (mgl_made(mgi, pw))  {
+			mgi->ndups++;
+			continue;
+			}
+		mgi->nkeys++;
+		return(TRUE);
+		}
+}
+
+
+/* Stop reading the word list.
+ */
+void mgl_close(mglinfo *mgi)
+{
+	if (mgi->fd != NULL)  fclose(mgi->fd);
+	mgi->fd = NULL;
+}
+
+
+/* Read the next word into mgi and start on its first rule.
+ * Blank lines and repeats of the last word are skipped.
+ * Returns FALSE at the end of the list.
+ */
+int mgl_word(mglinfo *mgi)
+{
+	char	line[MGLMAXWORD+2];
+	int		c, n;
+
+	for (;;)  {
+		if (fgets(line, sizeof(line), mgi->fd) == NULL)  return(FALSE);
+		n = strlen(line);
+		if (n > 0  &&  line[n-1] == '\n')  {
+			line[--n] = '\0';
+			}
+		else  {
+			while ((c = getc(mgi->fd)) != EOF  &&  c != '\n');
+			}
+		if (n > MGLMAXWORD)  line[n = MGLMAXWORD] = '\0';
+		if (n == 0  ||  strcmp(line, mgi->word) == 0)  continue;
+
+		mgi->same = (n >= ROTKEYLEN  &&  mgi->len >= ROTKEYLEN
+		             &&  strncmp(line, mgi->word, ROTKEYLEN) == 0);
+		strcpy(mgi->word, line);
+		mgi->len = n;
+		mgi->rule = 0;
+		mgi->var = 0;
+		mgi->nwords++;
+		return(TRUE);
+		}
+}
+
+
+/* Return TRUE if key pw has already been made from the current word,
+ * otherwise remember it and return FALSE.
+ */
+int mgl_made(mglinfo *mgi, char *pw)
+{
+	unsigned	h;
+	int			i;
+
+	h = 0;
+	for (i = 0 ; i < ROTKEYLEN ; i++)  h = 31 * h + (pw[i] & 0377);
+	for (h &= MGLHASH-1 ; mgi->stamp[h] == mgi->nwords ; h = (h+1) & (MGLHASH-1))  {
+		if (memcmp(mgi->made[h], pw, ROTKEYLEN) == 0)  return(TRUE);
+		}
+	mgi->stamp[h] = mgi->nwords;
+	memcpy(mgi->made[h], pw, ROTKEYLEN);
+	return(FALSE);
+}
+
+
+/* The rules.  Each puts variant var of word in buf.
+ */
+
+void mgl_asis(char *word, int len __attribute__((unused)),
+              int var __attribute__((unused)), char *buf)
+{
+	strcpy(buf, word);
+}
+
+
+void mgl_lower(char *word, int len __attribute__((unused)),
+               int var __attribute__((unused)), char *buf)
+{
+	for ( ; *word ; word++)  *buf++ = tolower(*word);
+	*buf = '\0';
+}
+
+
+void mgl_upper(char *word, int len __attribute__((unused)),
+               int var __attribute__((unused)), char *buf)
+{
+	for ( ; *word ; word++)  *buf++ = toupper(*word);
+	*buf = '\0';
+}
+
+
+void mgl_capital(char *word, int len, int var, char *buf)
+{
+	mgl_lower(word, len, var, buf);
+	buf[0] = toupper(buf[0]);
+}
+
+
+void mgl_toggle(char *word, int len __attribute__((unused)),
+                int var __attribute__((unused)), char *buf)
+{
+	for ( ; *word ; word++)
+		*buf++ = uletter(*word) ? tolower(*word) : toupper(*word);
+	*buf = '\0';
+}
+
+
+void mgl_leet(char *word, int len, int var, char *buf)
+{
+	char	*p, *q;
+
+	mgl_lower(word, len, var, buf);
+	for (p = buf ; *p ; p++)  {
+		for (q = mglleet ; *q ; q += 2)  {
+			if (*p == q[0])  {
+				*p = q[1];
+				break;
+				}
+			}
+		}
+}
+
+
+void mgl_digit(char *word, int len, int var, char *buf)
+{
+	sprintf(buf, "%.*s%d", len, word, var);
+}
+
+
+void mgl_capdigit(char *word, int len, int var, char *buf)
+{
+	mgl_capital(word, len, var, buf);
+	sprintf(&buf[len], "%d", var);
+}
+
+
+void mgl_twodigit(char *word, int len, int var, char *buf)
+{
+	sprintf(buf, "%.*s%02d", len, word, var);
+}
+
+
+void mgl_year(char *word, int len, int var, char *buf)
+{
+	sprintf(buf, "%.*s%d", len, word, MGLYEAR + var);
+}
+
+
+void mgl_first(char *word, int len, int var, char *buf)
+{
+	sprintf(buf, "%d%.*s", var, len, word);
+}
+
+
+void mgl_reverse(char *word, int len, int var __attribute__((unused)),
+                 char *buf)
+{
+	int		i;
+
+	for (i = 0 ; i < len ; i++)  buf[i] = word[len-1-i];
+	buf[len] = '\0';
+}
+
+
+void mgl_double(char *word, int len, int var __attribute__((unused)),
+                char *buf)
+{
+	sprintf(buf, "%.*s%.*s", len, word, len, word);
+}
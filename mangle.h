@@ -0,0 +1,45 @@
+#ifndef __MANGLE_H
+#define __MANGLE_H
+
+/*
+ * Declarations for the password mangler, which expands each word
+ * of a word list into the keys people make from it (case changes,
+ * digits, years, leet spellings and so on), one key at a time.
+ * Keys are cut to ROTKEYLEN characters, as crypt cuts them, and
+ * the same key is not produced twice for one word.
+ */
+
+#include	"rotor.h"
+
+
+#define	MGLMAXWORD	100		/* Longer words are cut. */
+#define	MGLHASH		512		/* Slots in the table of keys made. */
+
+/* Flags of a rule. */
+#define	MGLTAIL		01		/* Only adds characters after the word. */
+#define	MGLPREFIX	02		/* Key only depends on the first ROTKEYLEN. */
+
+
+#define	mglinfo	struct xmglinfo
+mglinfo	{
+		FILE	*fd;			/* Word list. */
+		char	word[MGLMAXWORD+1];	/* Current word. */
+		int		len;			/* Its length. */
+		int		same;			/* TRUE if it starts like the last. */
+		int		rule;			/* Next rule to apply. */
+		int		var;			/* Next variant of the rule. */
+		/* Keys made from the current word. */
+		char	made[MGLHASH][ROTKEYLEN];
+		long	stamp[MGLHASH];
+		/* Counts. */
+		long	nwords;
+		long	nkeys;
+		long	ndups;			/* Duplicate keys skipped. */
+		};
+
+
+extern	int		mgl_open(/* mgi, filename */);	/* FALSE if can't. */
+extern	int		mgl_next(/* mgi, pw */);	/* FALSE at the end. */
+extern	void	mgl_close(/* mgi */);
+
+#endif /* __MANGLE_H */
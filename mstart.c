@@ -0,0 +1,241 @@
+/*
+ * Multi-start bigram guessing.
+ *
+ * The bigram guesser is greedy, so the order in which it visits
+ * classes decides which mistakes it makes.  This runs several
+ * randomized variants of it in parallel, each with a fixed seed,
+ * scores every resulting block as a whole and keeps the best one,
+ * or the wires that most of the best few agree on.  Blocks are
+ * scored by their letter pairs, and by their words if there is a
+ * dictionary.
+ */
+
+#include	<stdio.h>
+#include	<math.h>
+#include	"window.h"
+#include	"terminal.h"
+#include	"layout.h"
+#include	"specs.h"
+#include	"cipher.h"
+#include	"wordscore.h"
+#include	"dblock.h"
+#include	"fanout.h"
+
+
+#define	MSLABEL1	"Multi-start, %d starts, level %4.2f, prob %4.2f -- Wait"
+#define	MSLABEL2	"Multi-start, best is start %d, score %6.1f -- Done"
+#define	MSLABEL3	"Multi-start, consensus of %d best, score %6.1f -- Done"
+#define	MSMAXSTARTS	FANMAX
+
+
+/* Result of one start. */
+#define	msresult	struct xmsresult
+msresult	{
+		float	score;
+		int		perm[BLOCKSIZE+1];
+		};
+
+#define	msinfo	struct xmsinfo
+msinfo	{
+		/* The chosen guess. */
+		ecinfo	eci;
+		/* Snapshot of the block the starts begin from. */
+		char	*cbuf;
+		int		baseperm[BLOCKSIZE+1];
+		/* Parameters. */
+		float	level;
+		float	prob;
+		int		nstarts;
+		int		ntop;
+		/* Outcome. */
+		int		best;			/* Start that scored best. */
+		float	score;			/* Score of the chosen guess. */
+		};
+
+
+extern	char	mcbuf[];
+extern	ecinfo	gecinfo;
+extern	keyer	lpbktab[];
+extern	void	lpbdraw();
+extern	void	lpbfirst();
+extern	void	lp_init();
+extern	void	lp_rautoguess();
+
+/* Forward declarations */
+void ms_solve(msinfo *msi, char *cbuf, int *perm);
+int ms_autoguess(char *cbuf, int *perm, float level, float prob,
+                 int nstarts, int ntop);
+void ms_start(int k, char *arg, char *result, int size);
+void ms_consensus(msinfo *msi, msresult *results, int *order);
+
+/* Global state. */
+msinfo	gmsinfo;
+msresult	msresults[MSMAXSTARTS];
+
+
+/* Routine invoked by user to run the multi-start bigram guesser.
+ * The window is drawn empty, and then filled in with the guess.
+ * Return NULL if command completes ok.
+ */
+char	*msguess(str)
+char	*str;			/* Command line */
+{
+	msinfo	*msi;
+	gwindow	*msb;
+
+	msb = &gbstore;
+	msi = &gmsinfo;
+
+	if (sscanf(str, "%*[^:]: %f %*[^:]: %f %*[^:]: %d %*[^:]: %d",
+			&msi->level, &msi->prob, &msi->nstarts, &msi->ntop) != 4)  {
+		return("Could not parse all four arguments.");
+		}
+	if (msi->nstarts < 1  ||  msi->nstarts > MSMAXSTARTS)  {
+		sprintf(statmsg, "The number of starts must be 1 to %d.",
+		        MSMAXSTARTS);
+		return(statmsg);
+		}
+	if (msi->ntop < 1  ||  msi->ntop > msi->nstarts)  {
+		return("The consensus size must be 1 to the number of starts.");
+		}
+
+	gbsswitch(msb, ((char *) &msi->eci), lpbktab, lpbfirst, wl_noop, lpbdraw);
+
+	sprintf(statmsg, MSLABEL1, msi->nstarts, msi->level, msi->prob);
+	gblset(&gblabel, statmsg);
+	gbsclear(msb);
+	fflush(stdout);
+
+	ms_solve(msi, mcbuf, refperm(dbsgetblk(&dbstore)));
+
+	if (msi->ntop > 1)
+		sprintf(statmsg, MSLABEL3, msi->ntop, msi->score);
+	else
+		sprintf(statmsg, MSLABEL2, msi->best, msi->score);
+	gblset(&gblabel, statmsg);
+	lpbdraw(msb);
+
+	return(NULL);
+}
+
+
+/* Run msi->nstarts randomized bigram guessers on the block cbuf
+ * with partial permutation perm and leave the best guess, or the
+ * consensus of the msi->ntop best, in msi->eci.
+ * Start zero is the ordinary deterministic guesser.
+ */
+void ms_solve(msinfo *msi, char *cbuf, int *perm)
+{
+	int		order[MSMAXSTARTS];
+	int		i, j, t;
+
+	msi->cbuf = cbuf;
+	for (i = 0 ; i < BLOCKSIZE ; i++)
+		msi->baseperm[i] = perm[i];
+	ws_ready();			/* Load the words once, not in each start. */
+
+	fanout(msi->nstarts, ms_start, (char *) msi,
+	       (char *) msresults, sizeof(msresults[0]));
+
+	/* Rank the starts, best score first, lowest start on ties. */
+	for (i = 0 ; i < msi->nstarts ; i++)  {
+		t = i;
+		for (j = i ; j > 0 ; j--)  {
+			if (msresults[order[j-1]].score >= msresults[t].score)  break;
+			order[j] = order[j-1];
+			}
+		order[j] = t;
+		}
+	msi->best = order[0];
+
+	if (msi->ntop > 1)  {
+		ms_consensus(msi, msresults, order);
+		}
+	else  {
+		ec_init(cbuf, msresults[msi->best].perm, &msi->eci);
+		}
+	msi->score = pbuf_wscore(msi->eci.plaintext);
+}
+
+
+/* Run the multi-start guesser on the block cbuf without a display
+ * and add the chosen wires to perm.  Used by the automatic solver.
+ * Returns the number of wires added.
+ */
+int ms_autoguess(char *cbuf, int *perm, float level, float prob,
+                 int nstarts, int ntop)
+{
+	msinfo	*msi;
+	int		x, y, added;
+
+	msi = &gmsinfo;
+	msi->level = level;
+	msi->prob = prob;
+	msi->nstarts = nstarts;
+	msi->ntop = ntop;
+
+	ms_solve(msi, cbuf, perm);
+
+	added = 0;
+	for (x = 0 ; x < BLOCKSIZE ; x++)  {
+		y = msi->eci.perm[x];
+		if (y == NONE  ||  y <= x  ||  perm[x] != NONE  ||  perm[y] != NONE)
+			continue;
+		perm[x] = y;
+		perm[y] = x;
+		added++;
+		}
+	return(added);
+}
+
+
+/* Run start k, leaving its permutation and score in result.
+ * Called through fanout, possibly in a child process.
+ */
+void ms_start(int k, char *arg, char *result, int size)
+{
+	msinfo		*msi;
+	msresult	*msr;
+	int			i;
+
+	msi = ((msinfo *) arg);
+	msr = ((msresult *) result);
+	if (size < (int) sizeof(*msr))  return;
+
+	lp_init(msi->cbuf, msi->baseperm, &gecinfo);
+	lp_rautoguess(&gecinfo, msi->level, msi->prob, (unsigned int) k);
+	decode(gecinfo.ciphertext, gecinfo.plaintext, gecinfo.perm);
+
+	msr->score = pbuf_wscore(gecinfo.plaintext);
+	for (i = 0 ; i < BLOCKSIZE ; i++)
+		msr->perm[i] = gecinfo.perm[i];
+}
+
+
+/* Fill in msi->eci with the wires of the best start that more
+ * than half of the msi->ntop best starts agree on.
+ * Order lists the starts best first.
+ */
+void ms_consensus(msinfo *msi, msresult *results, int *order)
+{
+	int		perm[BLOCKSIZE+1];
+	int		i, k, x, y, votes;
+
+	for (x = 0 ; x < BLOCKSIZE ; x++)
+		perm[x] = msi->baseperm[x];
+
+	for (x = 0 ; x < BLOCKSIZE ; x++)  {
+		y = results[order[0]].perm[x];
+		if (y == NONE  ||  perm[x] != NONE)  continue;
+		votes = 0;
+		for (i = 0 ; i < msi->ntop ; i++)  {
+			k = order[i];
+			if (results[k].perm[x] == y)  votes++;
+			}
+		if (2 * votes > msi->ntop)  {
+			perm[x] = y;
+			perm[y] = x;
+			}
+		}
+	ec_init(msi->cbuf, perm, &msi->eci);
+}
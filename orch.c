@@ -0,0 +1,348 @@
+/*
+ * Automatic solver for a whole file.
+ *
+ * Breaking a file by hand is a cycle: guess wires in each block,
+ * knit the blocks to learn Zee, propagate what one block knows to
+ * the others through Zee, and look for blocks that disagree.  This
+ * runs that cycle without the user.  Each pass guesses every block
+ * that changed since it was last guessed, extends Zee with the
+ * entries the blocks force, propagates every block into every other
+ * block and removes the wires of the block that disagrees most with
+ * the others.  When a pass gains nothing the guessing moves on to
+ * the next stage, with looser thresholds and then more engines; a
+ * pass that gains something stays at its stage, as the blocks it
+ * changed were already guessed at the stricter ones.  Only
+ * entries of Zee that the blocks force are added, since one wrong
+ * entry spoils every block it is propagated into.  The loop stops
+ * when every block is solved, the loosest stage gains nothing, or
+ * the time is up.
+ */
+
+#include	<stdio.h>
+#include	<string.h>
+#include	<time.h>
+#include	"window.h"
+#include	"specs.h"
+#include	"cipher.h"
+#include	"dblock.h"
+#include	"orch.h"
+
+
+#define	ORLABEL		"Pass %d stage %d: wires %d, Zee %d, +%d guessed, +%d knit, " \
+					"+%d propagated, %d conflicts, -%d cleared"
+#define	ORDONEMSG	"Auto-solve %s after %d passes: %d wires, Zee %d of 256."
+#define	ORNOWORDS	"-"		/* Pwords file name for no pwords. */
+
+/* Multi-start settings for the stages that use it. */
+#define	ORMSLEVEL	1.5
+#define	ORMSPROB	0.6
+#define	ORMSTOP		4
+
+/* One step of escalation. */
+#define	orstage	struct xorstage
+orstage	{
+		int		votes;		/* Ensemble votes to accept a wire. */
+		float	lone;		/* Ensemble lone level. */
+		int		nstarts;	/* Multi-start runs, 0 for none. */
+		};
+
+
+extern	int		kzee[];
+extern	void	pgate_perm();
+extern	int		knt_autoknit();
+extern	int		pwd_harvest();
+extern	char	*pwd_load();
+extern	void	kntsetup();
+extern	int		en_autoguess(char *cbuf, int *perm, int min_votes,
+				             float lone_level, char *pwfile);
+extern	int		ms_autoguess(char *cbuf, int *perm, float level, float prob,
+				             int nstarts, int ntop);
+
+/* Forward declarations */
+int orch_run(orchinfo *ori);
+int orch_guess(orchinfo *ori, orstage *st, time_t deadline);
+int orch_propagate(orchinfo *ori);
+int orch_verify(orchinfo *ori);
+int orch_wires(orchinfo *ori);
+int orch_steps(char *name);
+void orch_status(char *str);
+
+/* Named sets of steps. */
+#define	orpipe	struct xorpipe
+orpipe	{
+		char	*name;
+		int		steps;
+		};
+
+/* Global state. */
+orstage	orstages[] = {
+		{3, 50.0, 0},
+		{2, 20.0, 0},
+		{2, 5.0, 0},
+		{2, 5.0, 8},
+		};
+#define	ORNSTAGES	((int) (sizeof(orstages) / sizeof(orstages[0])))
+
+orpipe	orpipes[] = {
+		{"auto", ORGUESS | ORKNIT | ORPROP},
+		{"guess", ORGUESS},
+		{"knit", ORKNIT | ORPROP},
+		{NULL, 0},
+		};
+
+char	*ornames[] = {"solved the file", "reached a fixpoint", "ran out of time"};
+orchinfo	gorchinfo;
+ecinfo	orecinfo;
+
+
+/* Routine invoked by user to run the automatic solver on the
+ * whole file.  Progress is shown on the status line.
+ * Return NULL if command completes ok.
+ */
+char	*orchcmd(str)
+char	*str;			/* Command line */
+{
+	orchinfo	*ori;
+	int			result;
+	char		pwfile[MAXWIDTH+1];
+
+	ori = &gorchinfo;
+	if (sscanf(str, "%*[^:]: %ld %*[^:]: %s", &ori->budget, pwfile) != 2)  {
+		return("Could not parse both arguments.");
+		}
+	ori->pwfile = pwfile;
+	ori->report = orch_status;
+	ori->steps = ORGUESS | ORKNIT | ORPROP;
+	ori->first = 0;
+	ori->last = NONE;
+
+	result = orch_run(ori);
+
+	dbssetblk(&dbstore, dbsgetblk(&dbstore));	/* Show new wires. */
+	sprintf(statmsg, ORDONEMSG, ornames[result], ori->pass,
+	        orch_wires(ori), permcount(kzee));
+	usrstatus(&user, statmsg);
+	wl_rcursor(&user);
+	return(NULL);
+}
+
+
+/* Return the steps of the pipeline called name, or 0 if there is
+ * no such pipeline.
+ */
+int orch_steps(char *name)
+{
+	orpipe	*p;
+
+	for (p = orpipes ; p->name != NULL ; p++)  {
+		if (strcmp(p->name, name) == 0)  return(p->steps);
+		}
+	return(0);
+}
+
+
+/* Show a progress line on the status line right away.
+ */
+void orch_status(char *str)
+{
+	usrstatus(&user, str);
+	fflush(stdout);
+}
+
+
+/* Run the loop on blocks first through last of cipherfile, doing
+ * the steps in ori->steps, and leave the wires in the block
+ * permutations and Zee.  A last of NONE means the end of the file.
+ * Returns ORSOLVED, ORFIXPOINT or ORBUDGET.
+ */
+int orch_run(orchinfo *ori)
+{
+	int		b, before, after;
+	time_t	deadline;
+	orstage	*st;
+	char	line[2*MAXWIDTH];
+
+	deadline = (ori->budget > 0) ? time(NULL) + ori->budget : 0;
+	kntsetup();
+	if (ori->first < 0)  ori->first = 0;
+	if (ori->last == NONE  ||  ori->last >= NPERMS)  ori->last = NPERMS - 1;
+	for (b = ori->first ; b <= ori->last ; b++)  {
+		if (!fillcbuf(b, ori->cbufs[b]))  break;
+		ori->gwires[b] = NONE;
+		ori->gstage[b] = NONE;
+		}
+	ori->last = b - 1;
+	ori->nblocks = b - ori->first;
+	ori->pass = 0;
+	ori->stage = 0;
+	if (ori->nblocks <= 0)  return(ORFIXPOINT);
+	pwd_load(strcmp(ori->pwfile, ORNOWORDS) == 0 ? NULL : ori->pwfile);
+
+	for (ori->pass = 1 ; ori->pass <= ORMAXPASS ; ori->pass++)  {
+		st = &orstages[ori->stage];
+		before = orch_wires(ori) + permcount(kzee);
+
+		ori->guessed = ori->knitted = 0;
+		ori->propagated = ori->conflicts = ori->cleared = 0;
+		pwd_harvest(ori->cbufs, ori->first, ori->last);
+		if (ori->steps & ORGUESS)
+			ori->guessed = orch_guess(ori, st, deadline);
+		if ((ori->steps & ORKNIT)  &&  ori->nblocks > 1)
+			ori->knitted = knt_autoknit(ori->first, ori->last);
+		if (ori->steps & ORPROP)  {
+			ori->propagated = orch_propagate(ori);
+			ori->cleared = orch_verify(ori);
+			}
+
+		after = orch_wires(ori) + permcount(kzee);
+		if (ori->guessed + ori->knitted + ori->propagated + ori->cleared > 0)
+			permchgflg = TRUE;
+
+		sprintf(line, ORLABEL, ori->pass, ori->stage, orch_wires(ori),
+		        permcount(kzee), ori->guessed, ori->knitted,
+		        ori->propagated, ori->conflicts, ori->cleared);
+		if (ori->report != NULL)  (*(ori->report))(line);
+
+		if (orch_wires(ori) == ori->nblocks * (BLOCKSIZE/2)
+		 && ori->conflicts == 0)
+			return(ORSOLVED);
+		if (deadline != 0  &&  time(NULL) >= deadline)
+			return(ORBUDGET);
+
+		if (after <= before
+		 && (!(ori->steps & ORGUESS)  ||  ++(ori->stage) >= ORNSTAGES))  {
+			ori->stage = ORNSTAGES - 1;
+			return(ORFIXPOINT);
+			}
+		}
+
+	ori->pass = ORMAXPASS;
+	return(ORFIXPOINT);
+}
+
+
+/* Run the guessing engines of stage st on every block that is not
+ * solved and has changed, or has only been guessed at a stricter
+ * stage, since it was last guessed.
+ * Returns the number of wires added.
+ */
+int orch_guess(orchinfo *ori, orstage *st, time_t deadline)
+{
+	int		b, n, added;
+	int		*perm;
+
+	added = 0;
+	for (b = ori->first ; b <= ori->last ; b++)  {
+		if (deadline != 0  &&  time(NULL) >= deadline)  break;
+		perm = refperm(b);
+		n = permwcount(perm);
+		if (n >= BLOCKSIZE/2)  continue;
+		if (n == ori->gwires[b]  &&  ori->gstage[b] >= ori->stage)  continue;
+
+		added += en_autoguess(ori->cbufs[b], perm, st->votes, st->lone,
+		                      ori->pwfile);
+		if (st->nstarts > 0)
+			added += ms_autoguess(ori->cbufs[b], perm, ORMSLEVEL, ORMSPROB,
+			                      st->nstarts, ORMSTOP);
+
+		ori->gwires[b] = permwcount(perm);
+		ori->gstage[b] = ori->stage;
+		}
+	return(added);
+}
+
+
+/* Propagate the wires of every block into every other block using
+ * Zee.  A deduced wire is added if it decodes to acceptable
+ * characters and does not disagree with the target block.  Each
+ * disagreement marks the target wire it contradicts.
+ * Returns the number of wires added.
+ */
+int orch_propagate(orchinfo *ori)
+{
+	int		s, t, x, y, added;
+	int		*perm;
+	int		res[BLOCKSIZE+1];
+	int		pvec[BLOCKSIZE+1];
+
+	added = 0;
+	ori->conflicts = 0;
+	for (t = ori->first ; t <= ori->last ; t++)  {
+		for (x = 0 ; x < BLOCKSIZE ; x++)  ori->marks[t][x] = 0;
+		}
+	if (permcount(kzee) == 0)  return(0);
+
+	for (t = ori->first ; t <= ori->last ; t++)  {
+		perm = refperm(t);
+		ec_init(ori->cbufs[t], perm, &orecinfo);
+		for (s = ori->first ; s <= ori->last ; s++)  {
+			if (s == t  ||  permwcount(refperm(s)) == 0)  continue;
+			pgate_perm(s, t, res);
+			for (x = 0 ; x < BLOCKSIZE ; x++)  {
+				y = res[x];
+				if (y == NONE  ||  perm[x] == y)  continue;
+				if (perm[x] != NONE  ||  perm[y] != NONE)  {
+					ori->marks[t][(perm[x] != NONE) ? x : y]++;
+					ori->conflicts++;
+					continue;
+					}
+				if (decode_wire(&orecinfo, x, y, pvec) < 0)  {
+					ori->conflicts++;
+					continue;
+					}
+				perm[x] = orecinfo.perm[x] = y;
+				perm[y] = orecinfo.perm[y] = x;
+				added++;
+				}
+			}
+		}
+	return(added);
+}
+
+
+/* Remove the marked wires of the block that the propagation
+ * contradicted most often.  A wrong wire in one block is
+ * contradicted by every other block, while the wires it
+ * contradicts elsewhere are marked only once each.
+ * Returns the number of wires removed.
+ */
+int orch_verify(orchinfo *ori)
+{
+	int		t, x, y, n;
+	int		worst, worstn, cleared;
+	int		*perm;
+
+	worst = NONE;
+	worstn = 0;
+	for (t = ori->first ; t <= ori->last ; t++)  {
+		n = 0;
+		for (x = 0 ; x < BLOCKSIZE ; x++)  n += ori->marks[t][x];
+		if (n > worstn)  {
+			worstn = n;
+			worst = t;
+			}
+		}
+	if (worst == NONE)  return(0);
+
+	cleared = 0;
+	perm = refperm(worst);
+	for (x = 0 ; x < BLOCKSIZE ; x++)  {
+		if (ori->marks[worst][x] == 0  ||  (y = perm[x]) == NONE)  continue;
+		perm[x] = NONE;
+		perm[y] = NONE;
+		cleared++;
+		}
+	return(cleared);
+}
+
+
+/* Return the number of wires known in all the blocks.
+ */
+int orch_wires(orchinfo *ori)
+{
+	int		b, n;
+
+	n = 0;
+	for (b = ori->first ; b <= ori->last ; b++)  n += permwcount(refperm(b));
+	return(n);
+}
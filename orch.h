@@ -0,0 +1,56 @@
+#ifndef __ORCH_H
+#define __ORCH_H
+
+/*
+ * Declarations for the automatic solver, which repeats block
+ * guessing, knitting, propagation through Zee and a consistency
+ * check until none of them makes progress.
+ */
+
+
+#define	ORMAXPASS	50		/* Max passes of the loop. */
+
+/* Values returned by orch_run. */
+#define	ORSOLVED	0		/* Every block is fully wired. */
+#define	ORFIXPOINT	1		/* No stage of the loop made progress. */
+#define	ORBUDGET	2		/* Ran out of time. */
+
+/* Steps of the loop, for the steps field. */
+#define	ORGUESS		01		/* Run the guessing engines. */
+#define	ORKNIT		02		/* Add the Zee entries the blocks force. */
+#define	ORPROP		04		/* Propagate through Zee and check. */
+
+
+#define	orchinfo	struct xorchinfo
+orchinfo	{
+		/* Parameters. */
+		int		first;		/* First block to work on. */
+		int		last;		/* Last block, NONE for end of file. */
+		int		steps;		/* ORGUESS, ORKNIT and ORPROP bits. */
+		long	budget;		/* Seconds allowed, 0 for no limit. */
+		char	*pwfile;	/* Pwords file for the ensemble, or "-". */
+		void	(*report)();	/* Called with a progress line. */
+		/* Snapshot of the cipher blocks. */
+		int		nblocks;
+		char	cbufs[NPERMS][BLOCKSIZE+1];
+		/* Wire count and stage when each block was last guessed. */
+		int		gwires[NPERMS];
+		int		gstage[NPERMS];
+		/* Number of propagations that disagree with each wire. */
+		int		marks[NPERMS][BLOCKSIZE];
+		/* Progress of the current pass. */
+		int		pass;
+		int		stage;
+		int		guessed;	/* Wires added by the guessing engines. */
+		int		knitted;	/* Entries added to Zee. */
+		int		propagated;	/* Wires added through Zee. */
+		int		conflicts;	/* Disagreements found by propagation. */
+		int		cleared;	/* Wires removed because of them. */
+		};
+
+
+extern	int	orch_run(/* ori */);	/* Returns ORSOLVED, ... */
+extern	int	orch_wires(/* ori */);	/* Wires known in all blocks. */
+extern	int	orch_steps(/* name */);	/* Steps of a pipeline, 0 if none. */
+
+#endif /* __ORCH_H */
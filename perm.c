@@ -8,15 +8,37 @@
 
 #include	<stdlib.h>
 #include	<stdio.h>
+#include	<string.h>
+#include	<time.h>
+#include	<unistd.h>
+#include	<signal.h>
+#include	<sys/types.h>
+#include	<sys/wait.h>
 #include	"window.h"
 #include	"specs.h"
+#include	"arena.h"
+#include	"tparse.h"
 
 
 #define	NPERLINE	10		/* How many values per line in save file. */
 #define	FROMSTART	0		/* For fseek call, how offset measured. */
-
-extern void loadzee(FILE *fd);
+#define	AUTOSUFFIX	".auto"	/* Added to permfile for the autosave file. */
+#define	AUTOTMP		".tmp"	/* Added to that while it is written. */
+#define	AUTOVAR		"CBWAUTOSAVE"	/* Shell variable with the seconds between */
+#define	AUTOSECS	30		/* autosaves, 0 for none, and its default. */
+#define	AUTOFNVBASIS	0xcbf29ce484222325ULL
+#define	AUTOFNVPRIME	0x100000001b3ULL
+
+extern void loadzee(int *zee);
 extern void storezee(FILE *fd);
+extern int	kzee[];
+
+/* Forward declarations */
+int permwrite(char *filename);
+char *permautosave(void);
+int permautosecs(void);
+int permreap(int hang);
+unsigned long long permsum(void);
 
 /* Input file name for permutations. */
 char	*permfile;
@@ -26,6 +48,16 @@ char	*permfile;
 int		permchgflg = FALSE;	/* True if perms changed since last save. */
 int		*permtab[NPERMS];	/* Table of saved permutations or null. */
 int		perminit = FALSE;	/* Initialization flag. */
+arena	permarena;			/* Space for all the permutations. */
+
+/* Autosave state. */
+char	*autofile = NULL;		/* Permfile with AUTOSUFFIX. */
+char	*autotmpfile = NULL;	/* Autofile with AUTOTMP. */
+int		autosecs = NONE;		/* Seconds between autosaves, NONE if not set. */
+pid_t	autopid = 0;			/* Process writing autofile, or 0. */
+time_t	autotime = 0;			/* When the last autosave started. */
+int		autosumok = FALSE;		/* TRUE if autosum is what was last autosaved. */
+unsigned long long	autosum;
 
 
 /* Allocate and clear a permutation.
@@ -35,11 +67,9 @@ int	*permalloc(void)
 	int		i;
 	int		*perm;
 
-	perm = ((int *) malloc((BLOCKSIZE+1)*sizeof(int)));
-	if (perm == NULL)  {
-		printf("\nNo room to allocate permutation.\n");
-		exit(0);
-		}
+	if (permarena.chunksize == 0)
+		ar_init(&permarena, NPERMS*(BLOCKSIZE+1)*sizeof(int), 0);
+	perm = ((int *) ar_alloc(&permarena, (BLOCKSIZE+1)*sizeof(int)));
 
 	for (i = 0 ; i < BLOCKSIZE ; i++)  {
 		perm[i] = -1;
@@ -82,13 +112,31 @@ int	*refperm(int blocknum)
  */
 char	*permsave(char *str __attribute__((unused)))
 {
-	FILE	*fd;
-	int		i;
-
-	if ((fd = fopen(permfile, "w")) == NULL)  {
+	if (!permwrite(permfile))  {
 		sprintf(statmsg, "Could not open %s to write permutations.", permfile);
 		return(statmsg);
 		}
+	permchgflg = FALSE;
+
+	/* The autosave file is only kept while it holds unsaved work. */
+	if (autofile != NULL)  {
+		permreap(TRUE);
+		unlink(autofile);
+		autosumok = FALSE;
+		}
+	return(NULL);
+}
+
+
+/* Write Zee and the permutations to filename.
+ * Return FALSE if it could not be written.
+ */
+int permwrite(char *filename)
+{
+	FILE	*fd;
+	int		i;
+
+	if ((fd = fopen(filename, "w")) == NULL)  return(FALSE);
 
 	storezee(fd);
 	
@@ -96,12 +144,119 @@ char	*permsave(char *str __attribute__((unused)))
 		writeperm(fd, refperm(i));
 		}
 
-	fclose(fd);
-	permchgflg = FALSE;
+	return(fclose(fd) == 0);
+}
+
+
+/* Save the permutations and Zee in permfile with AUTOSUFFIX if they
+ * have changed since they were last saved, and the last autosave
+ * was at least autosecs ago.  Called while waiting for a key.
+ * The saving is done by a child process, which gets a copy on write
+ * snapshot of the permutations from fork, so cbw does not wait
+ * however large the file.  The child writes a temporary file and
+ * renames it, so the autosave file is always whole.
+ * Return NULL, or a message if the last autosave failed.
+ */
+char	*permautosave(void)
+{
+	unsigned long long	sum;
+	int		n;
+
+	if (permautosecs() <= 0)  return(NULL);
+	if (autofile == NULL)  {
+		n = strlen(permfile) + strlen(AUTOSUFFIX) + strlen(AUTOTMP) + 1;
+		autofile = malloc(n);
+		autotmpfile = malloc(n);
+		if (autofile == NULL  ||  autotmpfile == NULL)  {
+			autosecs = 0;
+			return(NULL);
+			}
+		sprintf(autofile, "%s%s", permfile, AUTOSUFFIX);
+		sprintf(autotmpfile, "%s%s", autofile, AUTOTMP);
+		}
+
+	if (!permreap(FALSE))  {
+		sprintf(statmsg, "Could not autosave the permutations in %s.", autofile);
+		return(statmsg);
+		}
+	if (autopid != 0  ||  !permchgflg)  return(NULL);
+	if (time(NULL) - autotime < autosecs)  return(NULL);
+	sum = permsum();
+	if (autosumok  &&  sum == autosum)  return(NULL);
+
+	autotime = time(NULL);
+	if ((autopid = fork()) < 0)  {
+		autopid = 0;
+		return(NULL);
+		}
+	if (autopid == 0)  {
+		signal(SIGINT, SIG_IGN);
+		signal(SIGTSTP, SIG_IGN);
+		if (!permwrite(autotmpfile)  ||  rename(autotmpfile, autofile) != 0)  {
+			unlink(autotmpfile);
+			_exit(1);
+			}
+		_exit(0);
+		}
+	autosum = sum;
+	autosumok = TRUE;
 	return(NULL);
 }
 
 
+/* Return the seconds between autosaves, 0 for none.
+ */
+int	permautosecs(void)
+{
+	char	*var;
+
+	if (autosecs == NONE)  {
+		autosecs = AUTOSECS;
+		if ((var = getenv(AUTOVAR)) != NULL)  autosecs = atoi(var);
+		}
+	return(autosecs);
+}
+
+
+/* Collect the autosave process if it has finished, waiting for it
+ * if hang is TRUE.  Return FALSE if it finished and failed.
+ */
+int	permreap(int hang)
+{
+	int		status;
+
+	if (autopid == 0)  return(TRUE);
+	if (waitpid(autopid, &status, hang ? 0 : WNOHANG) == 0)  return(TRUE);
+	autopid = 0;
+	if (WIFEXITED(status)  &&  WEXITSTATUS(status) == 0)  return(TRUE);
+	autosumok = FALSE;
+	return(FALSE);
+}
+
+
+/* Return a 64 bit FNV-1a hash of Zee and the permutations, so an
+ * autosave can be skipped if nothing changed since the last one.
+ */
+unsigned long long permsum(void)
+{
+	unsigned long long	h;
+	int		i, j;
+
+	h = AUTOFNVBASIS;
+	for (j = 0 ; j < BLOCKSIZE ; j++)
+		h = (h ^ (unsigned) kzee[j]) * AUTOFNVPRIME;
+	for (i = 0 ; i < NPERMS ; i++)  {
+		if (!perminit  ||  permtab[i] == NULL)  {
+			h = (h ^ 0xff) * AUTOFNVPRIME;
+			continue;
+			}
+		for (j = 0 ; j < BLOCKSIZE ; j++)
+			h = (h ^ (unsigned) permtab[i][j]) * AUTOFNVPRIME;
+		}
+	return(h);
+}
+
+
 /* Restore all the permutations by reading them from a file.
  * This can be invoked as a command.
  * For now, the are no arguments, the filename is fixed.
@@ -110,21 +265,9 @@ char	*permsave(char *str __attribute__((unused)))
  */
 char	*permload(char *str __attribute__((unused)))
 {
-	FILE	*fd;
-	int		i;
-
-	if ((fd = fopen(permfile, "r")) == NULL)  {
-		sprintf(statmsg, "Could not open %s to read permutations.", permfile);
-		return(statmsg);
-		}
-
-	loadzee(fd);
-
-	for (i = 0 ; i < NPERMS ; i++) {
-		readperm(fd, refperm(i));
-		}
+	char	*msg;
 
-	fclose(fd);
+	if ((msg = permread(permfile)) != NULL)  return(msg);
 	permchgflg = FALSE;
 
 	dbssetblk(&dbstore, dbsgetblk(&dbstore));	/* Update perm and cbuf. */
@@ -194,17 +337,32 @@ void copyperm(int src[], int dst[])
 }
 
 
-/* Read a permutation from the given stream into the given buffer.
+/* Read the Zee and all the permutations saved in filename by
+ * permsave.  Nothing is changed unless the whole file parses.
+ * Returns NULL or an error message.
  */
-void readperm(FILE *fd, int perm[])
+char	*permread(char *filename)
 {
-	int		j;
+	tpfile	tpf;
+	int		zee[BLOCKSIZE+1];
+	int		perms[NPERMS][BLOCKSIZE+1];
+	int		i;
+	char	*msg;
 
-	for (j = 0 ; j < BLOCKSIZE ; j++)  {
-		fscanf(fd, "%3d", &perm[j]);
+	if (tp_open(&tpf, filename) != NULL)  {
+		sprintf(statmsg, "Could not open %s to read permutations.", filename);
+		return(statmsg);
 		}
-
-	fscanf(fd,"\n");
+	msg = tp_perm(&tpf, zee);
+	for (i = 0 ; msg == NULL  &&  i < NPERMS ; i++)
+		msg = tp_perm(&tpf, perms[i]);
+	tp_close(&tpf);
+	if (msg != NULL)  return(msg);
+
+	loadzee(zee);
+	for (i = 0 ; i < NPERMS ; i++)
+		copyperm(perms[i], refperm(i));
+	return(NULL);
 }
 
 
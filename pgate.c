@@ -14,24 +14,19 @@ extern	int	kzee[];
 extern	int	kzeeinv[];
 
 
+/* Forward declarations */
+void pgate_perm(int from, int to, int *result);
+
+
 /* User command to propage info from Ai to Aj using Zee**(j-i).
  * Returns NULL if sucessful.
  */
 char *pgate(char *str)
 {
 	int		i;
-	int		k;
 	int		from, to;
-	int		*zeek, *zeeinvk;	/* Zee ** k */
-	int		*tmp1perm, *tmp2perm;
-	int		kexp[BLOCKSIZE+1], kexpinv[BLOCKSIZE+1];
-	int		ktmp1perm[BLOCKSIZE+1];
 	int		ktmp2perm[BLOCKSIZE+1];
 
-	tmp1perm = ktmp1perm;
-	tmp2perm = ktmp2perm;
-	zeek = kexp;
-	zeeinvk = kexpinv;
 	from = to = 0;
 
 	if ((i = sscanf(str,"%*[^:]: %d %*[^:]: %d", &from, &to)) != 2) {
@@ -41,6 +36,33 @@ char *pgate(char *str)
 	if (dbsgetblk(&dbstore) != to)
 		dbssetblk(&dbstore, to);
 
+	pgate_perm(from, to, ktmp2perm);
+
+	if (!dbsmerge(&dbstore, ktmp2perm))  {
+		wl_rcursor(&user);
+		return("Merge conflicts with current plaintext.");
+		}
+
+	wl_rcursor(&user);
+	return(NULL);
+}
+
+
+/* Fill in result with what Zee**(to-from) deduces about the
+ * permutation of block to from the permutation of block from.
+ */
+void pgate_perm(int from, int to, int *result)
+{
+	int		k;
+	int		*zeek, *zeeinvk;	/* Zee ** k */
+	int		*tmp1perm;
+	int		kexp[BLOCKSIZE+1], kexpinv[BLOCKSIZE+1];
+	int		ktmp1perm[BLOCKSIZE+1];
+
+	tmp1perm = ktmp1perm;
+	zeek = kexp;
+	zeeinvk = kexpinv;
+
 	k = to - from;
 	if (k >= 0) {
 		expperm(kzee, zeek, k);
@@ -52,13 +74,5 @@ char *pgate(char *str)
 		}
 
 	multperm(refperm(from), zeek, tmp1perm);
-	multperm(zeeinvk, tmp1perm, tmp2perm);
-
-	if (!dbsmerge(&dbstore, tmp2perm))  {
-		wl_rcursor(&user);
-		return("Merge conflicts with current plaintext.");
-		}
-
-	wl_rcursor(&user);
-	return(NULL);
+	multperm(zeeinvk, tmp1perm, result);
 }
@@ -0,0 +1,337 @@
+/*
+ * Automatic guessing based on probable phrases.
+ *
+ * Each line of the phrase file is tried at every position, like
+ * the pwords guesser, and so is every pair of its one word lines
+ * with a space between them.  A table of the characters that can
+ * stand at each position of the block (the per-position masks)
+ * throws out most candidates before any wiring is built.  Pairs are
+ * built a word at a time: the wires of the first word and the space
+ * are found once, and each second word only adds its own, so a
+ * first word that does not fit rules out all of its pairs.
+ */
+
+#include	<stdio.h>
+#include	<string.h>
+#include	<math.h>
+#include	"window.h"
+#include	"terminal.h"
+#include	"layout.h"
+#include	"specs.h"
+#include	"cipher.h"
+#include	"autotri.h"
+#include	"wiretab.h"
+
+
+#define	DEBUG	FALSE
+
+#define	NPHRASES	200
+#define	PHBUFSZ		(16*NPHRASES)
+#define	PHMAXLEN	(PERMSZ-1)		/* Each char adds at most one wire. */
+#define	PHMASKSZ	((MAXCHAR+1)/8)
+#define	PHRLABEL1	"Probable phrase search -- Please Wait"
+#define	PHRLABEL2	"Probable phrase search -- Done"
+
+
+extern	char	mcbuf[];
+extern	ecinfo	gecinfo;
+extern	atrinfo gatrinfo;
+extern	keyer	pwdktab[];
+extern	char	*wtab_load_from();
+extern	long	wtab_stamp();
+extern	void atrdraw();
+extern	void atrfirst();
+extern	void pwd_guess_init();
+
+/* Forward declarations */
+char *phr_init();
+void phr_masks();
+int phr_fits();
+float phr_score();
+void phr_note();
+char *phr_best();
+void phr_autoguess();
+
+/* Global State. */
+char	*phrase_tab[NPHRASES];
+char	phrase_buf[PHBUFSZ];
+char	phrase_file[MAXWIDTH+1];	/* File in phrase_tab, so it stays loaded. */
+long	phrase_stamp;
+char	*phword_tab[NPHRASES];		/* Lines of phrase_tab with no space. */
+int		phword_len[NPHRASES];
+char	phbest[PHMAXLEN+1];			/* Text of the best guess so far. */
+long	phnpairs;					/* Pairs that got to scoring. */
+
+/* Bit c&07 of phmask[pos][c>>3] is set if plaintext c can be at pos. */
+unsigned char	phmask[BLOCKSIZE][PHMASKSZ];
+
+
+/* Routine invoked by user to search a list of probable phrases.
+ * The window is drawn empty, and then filled in with the guess.
+ * Return NULL if command completes ok.
+ */
+char	*phrguess(str)
+char	*str;			/* Command line */
+{
+	gwindow	*phr;
+	atrinfo	*phri;
+	ecinfo	*ecbi;
+	int		*dbsperm;
+	float	max_score;
+	char	*errmsg;
+	int		i;
+	char	filename[MAXWIDTH+1];
+
+	if ((i = sscanf(str, "%*[^:]: %s %*[^:]: %f",
+		filename, &max_score)) != 2)  {
+			return("Could not parse both arguments.");
+		}
+
+	phr = &gbstore;
+	phri = &gatrinfo;
+	dbsperm = refperm(dbsgetblk(&dbstore));
+	errmsg = phr_init(filename, mcbuf, dbsperm, phri);
+	if (errmsg != NULL)  return(errmsg);
+
+	ecbi = phri->eci;
+	phri->min_total_chars = 1;
+	phri->max_score = max_score;
+	phri->min_wire_chars = 0;
+
+	gbsswitch(phr, ((char *) phri), pwdktab, atrfirst, wl_noop, atrdraw);
+
+	gblset(&gblabel, PHRLABEL1);
+	atrdraw(phr);
+	fflush(stdout);
+
+	phr_autoguess(phri);
+	decode(ecbi->ciphertext, ecbi->plaintext, ecbi->perm);
+
+	gblset(&gblabel, PHRLABEL2);
+	atrdraw(phr);
+
+	return(NULL);
+}
+
+
+/* Fill in probable phrase info from given ciphertext block.
+ * The filter parameters are not set by this routine.
+ */
+char *phr_init(filename, cipher, perm, phri)
+char	*filename;
+char	cipher[];
+int		perm[];
+atrinfo	*phri;
+{
+	char	*errmsg;
+	char	*p;
+	int		i, n;
+	long	stamp;
+
+	phri->eci = &gecinfo;
+	if ((stamp = wtab_stamp(filename)) == 0  ||  stamp != phrase_stamp
+	 || strcmp(filename, phrase_file) != 0)  {
+		phrase_file[0] = 0;
+		errmsg = wtab_load_from(filename, phrase_buf, PHBUFSZ, phrase_tab, NPHRASES);
+		if (errmsg != NULL)  return(errmsg);
+
+		n = 0;
+		for (i = 0 ; phrase_tab[i] != NULL ; i++)  {
+			for (p = phrase_tab[i] ; *p != 0  &&  *p != ' ' ; p++);
+			if (*p != 0  ||  p - phrase_tab[i] > PHMAXLEN)  continue;
+			phword_len[n] = p - phrase_tab[i];
+			phword_tab[n++] = phrase_tab[i];
+			}
+		phword_tab[n] = NULL;
+		if (strlen(filename) <= MAXWIDTH)  strcpy(phrase_file, filename);
+		phrase_stamp = stamp;
+		}
+
+	ec_init(cipher, perm, phri->eci);
+	pwd_guess_init(phri);
+	return(NULL);
+}
+
+
+/* Fill in phmask from the wiring of eci.  A plaintext char can be
+ * at a position if it is already deduced there, or if wiring its
+ * ciphertext to it neither conflicts with the perm nor deduces a
+ * non-ascii char elsewhere in the block.
+ */
+void phr_masks(eci)
+ecinfo	*eci;
+{
+	int		pos, c, x, y;
+	unsigned char	*mask;
+
+	for (pos = 0 ; pos < BLOCKSIZE ; pos++)  {
+		mask = phmask[pos];
+		for (c = 0 ; c < PHMASKSZ ; c++)  mask[c] = 0;
+		x = eci->scipher[pos];
+		if (eci->perm[x] != NONE)  {
+			c = MODMASK & (eci->perm[x] - pos);
+			if (c <= MAXCHAR)  mask[c >> 3] |= 1 << (c & 07);
+			continue;
+			}
+		for (c = 0 ; c <= MAXCHAR ; c++)  {
+			y = MODMASK & (c + pos);
+			if (perm_conflict(eci->perm, x, y))  continue;
+			if (!wt_ascii(eci, x, y))  continue;
+			mask[c >> 3] |= 1 << (c & 07);
+			}
+		}
+}
+
+
+/* Return TRUE if every char of str passes the masks when str is
+ * placed at pos.
+ */
+int phr_fits(str, pos)
+char	*str;
+int		pos;
+{
+	int		c;
+
+	for ( ; (c = (*str & MODMASK)) != 0 ; str++, pos++)  {
+		if (pos >= BLOCKSIZE  ||  c > MAXCHAR)  return(FALSE);
+		if ((phmask[pos][c >> 3] & (1 << (c & 07))) == 0)  return(FALSE);
+		}
+	return(TRUE);
+}
+
+
+/* Score the wires of permvec for a guess covering first to last.
+ * Fills in pvec with the chars deduced outside the guess.
+ * Returns -1.0 if the guess is unacceptable.
+ */
+float phr_score(phri, permvec, first, last, pvec)
+atrinfo		*phri;
+perment		permvec[];
+int			first, last;
+int			pvec[];
+{
+	int		i, added, ccount;
+
+	ccount = 0;
+	for (i = 0 ; i < PERMSZ  &&  permvec[i].x != NONE ; i++)  {
+		if (ccount >= BLOCKSIZE-1)  break;
+		added = decode_wire_but(phri->eci, permvec[i].x, permvec[i].y,
+		                        &pvec[ccount], first, last);
+		if (added < 0  ||  added < phri->min_wire_chars)  return(-1.0);
+		ccount += added;
+		}
+	pvec[ccount] = NONE;
+
+	if (ccount <= 0  ||  ccount < phri->min_total_chars)  return(-1.0);
+	return(pvec_1score(pvec));
+}
+
+
+/* Keep the guess in phri if it beats the best so far.
+ * Str2 is the second word of a pair, or NULL.
+ */
+void phr_note(phri, score, str1, str2, permvec, pvec)
+atrinfo		*phri;
+float		score;
+char		*str1, *str2;
+perment		permvec[];
+int			pvec[];
+{
+	if (score < 0.0)  return;
+	phri->gcount++;
+	phri->total_score += score;
+	if (score >= phri->best_score)  return;
+
+	phri->best_score = score;
+	if (str2 == NULL)
+		sprintf(phbest, "%s", str1);
+	else
+		sprintf(phbest, "%s %s", str1, str2);
+	phri->best_trigram = phbest;
+	pvec_copy(pvec, phri->best_pvec);
+	permvec_copy(permvec, phri->best_permvec, PERMSZ);
+}
+
+
+/* Select the best phrase or word pair for a given position.
+ * Returns pointer to the text, or NULL.
+ * Fills in phri with additional information.
+ * Filtering parameters are passed in phri.
+ */
+char	*phr_best(phri, pos)
+atrinfo	*phri;
+int		pos;
+{
+	int		i, j;
+	int		len1, len2, pos2;
+	int		n1, n;
+	float	score;
+	ecinfo	*eci;
+	perment	permvec[PERMSZ];
+	int		pvec[BLOCKSIZE+1];
+
+	pwd_guess_init(phri);
+	eci = phri->eci;
+
+	for (i = 0 ; phrase_tab[i] != NULL ; i++)  {
+		for (len1 = 0 ; phrase_tab[i][len1] != 0 ; len1++);
+		if (len1 > PHMAXLEN  ||  !phr_fits(phrase_tab[i], pos))  continue;
+		n = permvec_from_string(eci, phrase_tab[i], pos, permvec);
+		if (n == ERROR)  continue;
+		score = phr_score(phri, permvec, pos, pos + len1 - 1, pvec);
+		phr_note(phri, score, phrase_tab[i], NULL, permvec, pvec);
+		}
+
+	for (i = 0 ; phword_tab[i] != NULL ; i++)  {
+		len1 = phword_len[i];
+		pos2 = pos + len1 + 1;
+		if (pos2 >= BLOCKSIZE  ||  !phr_fits(phword_tab[i], pos))  continue;
+		if (!phr_fits(" ", pos2 - 1))  continue;
+		n1 = permvec_add_string(eci, phword_tab[i], pos, permvec, 0);
+		if (n1 == ERROR)  continue;
+		n1 = permvec_add_string(eci, " ", pos2 - 1, permvec, n1);
+		if (n1 == ERROR)  continue;
+
+		for (j = 0 ; phword_tab[j] != NULL ; j++)  {
+			len2 = phword_len[j];
+			if (len1 + 1 + len2 > PHMAXLEN)  continue;
+			if (!phr_fits(phword_tab[j], pos2))  continue;
+			n = permvec_add_string(eci, phword_tab[j], pos2, permvec, n1);
+			if (n == ERROR)  continue;
+			phnpairs++;
+			score = phr_score(phri, permvec, pos, pos2 + len2 - 1, pvec);
+			phr_note(phri, score, phword_tab[i], phword_tab[j], permvec, pvec);
+			}
+		}
+
+#if DEBUG
+	if (phri->best_score < phri->max_score)
+		printf("Phrase '%s' at %d scores %f\n", phbest, pos, phri->best_score);
+#endif
+
+	if (phri->best_score < phri->max_score)
+		{return(phri->best_trigram);}
+	else
+		{return(NULL);}
+}
+
+
+/* Perform automatic guessing given a set of
+ * filter parameters in an atrinfo structure.
+ */
+void phr_autoguess(phri)
+atrinfo	*phri;
+{
+	int		pos;
+	char	*phrase;
+
+	phnpairs = 0;
+	phr_masks(phri->eci);
+	for (pos = 0 ; pos < BLOCKSIZE ; pos++) {
+		phrase = phr_best(phri, pos);
+		if (phrase != NULL) {
+			accept_permvec(phri, phri->best_permvec);
+			phr_masks(phri->eci);
+			}
+		}
+}
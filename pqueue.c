@@ -33,6 +33,18 @@ pqueue_hdr	*pque_hdr;
 }
 
 
+/* Return the score an entry needs to get into the queue.
+ * Only entries scoring less than this are added.
+ */
+float	pque_worst(pque_hdr)
+pqueue_hdr	*pque_hdr;
+{
+	if (pque_full(pque_hdr))
+		return(pque_hdr->pque_tab[pque_hdr->pque_size - 1].score);
+	return(pque_hdr->max_score);
+}
+
+
 /* Add an entry to the priority queue.  Sorted lowest score first.
  * The queue header indicates the next free slot, the maximum
  * score (all scores in queue < max), and the size of the table.
@@ -54,7 +66,7 @@ int			value2;
 	pqueue_ent	*pque;
 	pqueue_ent	new_ent;
 
-	if (score >= pque_hdr->max_score)  return;
+	if (score >= pque_worst(pque_hdr))  return;
 
 	new_ent.score = score;
 	new_ent.value1 = value1;
@@ -65,7 +77,9 @@ int			value2;
 		if (pque[k].score > score)  break;
 		}
 
-	for (i = pque_hdr->next_index ; i > k ; i--)  {
+	i = pque_hdr->next_index;
+	if (i >= pque_hdr->pque_size)  i = pque_hdr->pque_size - 1;
+	for ( ; i > k ; i--)  {
 		pque[i] = pque[i-1];
 		}
 	if (pque_hdr->next_index < pque_hdr->pque_size)
@@ -8,6 +8,7 @@
  */
 
 extern	int		pque_full(/* pque_hdr */);
+extern	float		pque_worst(/* pque_hdr */);
 extern	void		pque_add(/* pque_hdr */);
 extern	void		pque_init(/* pque_hdr, min_score, pque_tab, pque_size */);
 
@@ -2,27 +2,44 @@
  * Automatic guessing based on probable words.
  *
  * Bob Baldwin, February 1985.
+ *
+ * Besides the words from the file there is a hot vocabulary of words
+ * already decoded in well solved blocks of the same file, so that
+ * names and jargon that are in no word list are tried in the other
+ * blocks.  It is made again from the current permutations each time,
+ * so the words of wires that were cleared drop out.  Hot words and
+ * the file's words are tried together and the best score wins.
  */
 
 #include	<stdio.h>
+#include	<string.h>
 #include	<math.h>
+#include	<sys/types.h>
+#include	<sys/stat.h>
 #include	"window.h"
 #include	"terminal.h"
 #include	"layout.h"
 #include	"specs.h"
 #include	"cipher.h"
 #include	"autotri.h"
+#include	"tparse.h"
 
 
 #define	DEBUG	FALSE
 
 #define	NWORDS		100
 #define WDBUFSZ		(8*NWORDS)
-#define	WDPERMSZ	40
+#define	WDPERMSZ	PERMSZ
 #define	PWDLABEL1	"Probable word search -- Please Wait"
 #define	PWDLABEL2	"Probable word search -- Done"
 #define	PWDHELP		"F3 enters guess, ^G undoes it."
 
+#define	NHOTWORDS	100
+#define	NHOTCANDS	(4*NHOTWORDS)	/* Words a harvest can find. */
+#define	HOTMINLEN	4			/* Shorter words are too easy to fit. */
+#define	HOTMAXLEN	20
+#define	HOTMINWIRES	(3*BLOCKSIZE/8)	/* Wires a block needs to be harvested. */
+
 
 extern	char	mcbuf[];
 extern	ecinfo	gecinfo;
@@ -34,12 +51,25 @@ extern	void atrundo();
 
 /* Forward declarations */
 char *pwd_init();
+char *pwd_load();
 void pwd_autoguess();
 void pwd_guess_init();
+void pwd_try();
+int pwd_harvest();
+void pwd_harvest1();
+int pwd_known();
+long wtab_stamp();
 
 /* Gloabal State. */
 char	*word_tab[NWORDS];
 char	word_buf[WDBUFSZ];
+char	word_file[MAXWIDTH+1];		/* File in word_tab, so it stays loaded. */
+long	word_stamp;
+char	*hot_tab[NHOTWORDS+1];		/* Hot vocabulary, NULL terminated. */
+int		nhot = 0;
+char	hot_cand[NHOTCANDS][HOTMAXLEN+1];	/* Words found by a harvest, */
+int		hot_count[NHOTCANDS];		/* and how often each was. */
+int		ncand = 0;
 
 keyer	pwdktab[] = {
 		{CACCEPT, atrenter},
@@ -66,6 +96,7 @@ char	*str;			/* Command line */
 	char	*errmsg;
 	int		i;
 	char	filename[MAXWIDTH+1];
+	char	cbufs[NPERMS][BLOCKSIZE+1];
 
 	if ((i = sscanf(str, "%*[^:]: %s %*[^:]: %f",
 		filename, &max_score)) != 2)  {
@@ -74,6 +105,9 @@ char	*str;			/* Command line */
 
 	pwd = &gbstore;
 	pwdi = &gatrinfo;
+	if ((errmsg = pwd_load(filename)) != NULL)  return(errmsg);
+	for (i = 0 ; i < NPERMS  &&  fillcbuf(i, cbufs[i]) ; i++);
+	pwd_harvest(cbufs, 0, i-1);
 	dbsperm = refperm(dbsgetblk(&dbstore));
 	errmsg = pwd_init(filename, mcbuf, dbsperm, pwdi);
 	if (errmsg != NULL)  return(errmsg);
@@ -108,12 +142,12 @@ int		buffree, tabsize;
 char	*filename, *charbuf;
 char	*wtab[];
 {
-	FILE	*inp;
+	tpfile	tpf;
 	char	*wordstart;
 	int		wordindex, wordlength;
 	int		c;
 
-	if ((inp = fopen(filename, "r"))== NULL)  {
+	if (tp_open(&tpf, filename) != NULL)  {
 		return("Cannot open file to read probable words.");
 		}
 
@@ -121,7 +155,12 @@ char	*wtab[];
 	while(wordindex < tabsize-1)  {
 		wordstart = charbuf;
 		wordlength = 0;
-		while ((c = read_char(inp)) != EOL) {
+		while ((c = tp_char(&tpf)) != TPEOL  &&  c != TPEOF) {
+			if (c == TPBAD)  {
+				wtab[wordindex] = NULL;
+				tp_close(&tpf);
+				return(tperrmsg);
+				}
 			*charbuf++ = c;
 			wordlength++;
 			buffree--;
@@ -135,13 +174,28 @@ char	*wtab[];
 
 	wtab[wordindex] = NULL;
 
-	fclose(inp);
+	tp_close(&tpf);
 	return(NULL);
 }
 
 
+/* Return the time filename was last changed, or 0 if it can't be
+ * found.  A table loaded from a file need not be loaded again while
+ * the file keeps its name and stamp.
+ */
+long wtab_stamp(filename)
+char	*filename;
+{
+	struct	stat	st;
+
+	if (stat(filename, &st) != 0)  return(0);
+	return((long) st.st_mtime);
+}
+
+
 
 /* Fill in probable word info from given ciphertext block.
+ * A NULL filename leaves only the hot vocabulary.
  * The filter parameters are not set by this routine.
  */
 char *pwd_init(filename, cipher, perm, pwdi)
@@ -153,14 +207,39 @@ atrinfo	*pwdi;
 	char	*errmsg;
 
 	pwdi->eci = &gecinfo;
-	errmsg = wtab_load_from(filename, word_buf, WDBUFSZ, word_tab, NWORDS);
-	if (errmsg != NULL)  return(errmsg);
+	if ((errmsg = pwd_load(filename)) != NULL)  return(errmsg);
 	ec_init(cipher, perm, pwdi->eci);
 	pwd_guess_init(pwdi);
 	return(NULL);
 }
 
 
+/* Load the word file into word_tab, unless it is already there and
+ * has not changed.  A NULL filename empties word_tab.
+ * Returns NULL or an error message.
+ */
+char *pwd_load(filename)
+char	*filename;
+{
+	char	*errmsg;
+	long	stamp;
+
+	if (filename == NULL)  {
+		word_tab[0] = NULL;
+		word_file[0] = 0;
+		}
+	else if ((stamp = wtab_stamp(filename)) == 0  ||  stamp != word_stamp
+	      || strcmp(filename, word_file) != 0)  {
+		word_file[0] = 0;
+		errmsg = wtab_load_from(filename, word_buf, WDBUFSZ, word_tab, NWORDS);
+		if (errmsg != NULL)  return(errmsg);
+		if (strlen(filename) <= MAXWIDTH)  strcpy(word_file, filename);
+		word_stamp = stamp;
+		}
+	return(NULL);
+}
+
+
 /* Per guess initialization.
  */
 void pwd_guess_init(pwdi)
@@ -213,13 +292,11 @@ int			pvec[];
 }
 
 
-/* Select the best probable word for a given position.
- * Returns pointer to the word, or NULL.
- * Fills in pwdi with additional information.
- * Filtering parameters are passed in pwdi.
+/* Try each word of wtab at pos, keeping the best in pwdi.
  */
-char	*pwd_best(pwdi, pos)
+void	pwd_try(pwdi, wtab, pos)
 atrinfo	*pwdi;
+char	*wtab[];
 int		pos;
 {
 	int		windex;
@@ -227,20 +304,34 @@ int		pos;
 	perment	permvec[WDPERMSZ];
 	int		pvec[BLOCKSIZE+1];
 
-	pwd_guess_init(pwdi);
-
-	for (windex = 0 ; word_tab[windex] != NULL ; windex++)  {
-		score = pwd_score(pwdi, word_tab[windex], pos, permvec, pvec);
+	for (windex = 0 ; wtab[windex] != NULL ; windex++)  {
+		score = pwd_score(pwdi, wtab[windex], pos, permvec, pvec);
 		if (score < 0.0)  continue;
 		pwdi->gcount++;
 		pwdi->total_score += score;
 		if (score < pwdi->best_score) {
 			pwdi->best_score = score;
-			pwdi->best_trigram = word_tab[windex];
+			pwdi->best_trigram = wtab[windex];
 			pvec_copy(pvec, pwdi->best_pvec);
 			permvec_copy(permvec, pwdi->best_permvec, WDPERMSZ);
 			}
 		}
+}
+
+
+/* Select the best probable word for a given position.
+ * Returns pointer to the word, or NULL.
+ * Fills in pwdi with additional information.
+ * Filtering parameters are passed in pwdi.
+ */
+char	*pwd_best(pwdi, pos)
+atrinfo	*pwdi;
+int		pos;
+{
+	pwd_guess_init(pwdi);
+
+	pwd_try(pwdi, hot_tab, pos);
+	pwd_try(pwdi, word_tab, pos);
 	if (pwdi->best_score < pwdi->max_score)
 		{return(pwdi->best_trigram);}
 	else
@@ -265,3 +356,91 @@ atrinfo	*pwdi;
 			}
 		}
 }
+
+
+
+/* Make the hot vocabulary again from the words decoded in blocks
+ * first through last, whose cipher text is in cbufs.  If more than
+ * NHOTWORDS are found, the ones decoded most often are kept, the
+ * first found first on ties.  Words in word_tab are left out, so
+ * the word file should be loaded by pwd_load first.
+ * Returns the number of hot words.
+ */
+int pwd_harvest(cbufs, first, last)
+char	cbufs[][BLOCKSIZE+1];
+int		first, last;
+{
+	int		b, i, j, best;
+	int		taken[NHOTCANDS];
+
+	ncand = 0;
+	for (b = first ; b <= last ; b++)
+		pwd_harvest1(cbufs[b], refperm(b));
+
+	for (i = 0 ; i < ncand ; i++)  taken[i] = FALSE;
+	for (nhot = 0 ; nhot < NHOTWORDS  &&  nhot < ncand ; nhot++)  {
+		best = NONE;
+		for (j = 0 ; j < ncand ; j++)  {
+			if (taken[j])  continue;
+			if (best == NONE  ||  hot_count[j] > hot_count[best])  best = j;
+			}
+		taken[best] = TRUE;
+		hot_tab[nhot] = hot_cand[best];
+		}
+	hot_tab[nhot] = NULL;
+	return(nhot);
+}
+
+
+/* Add the words decoded in a block to the harvest.  Only blocks
+ * with HOTMINWIRES wires are used, and only words that are all
+ * letters, have a known non-letter on either side, and are not in
+ * the word file.  A word already found is counted again.
+ */
+void pwd_harvest1(cbuf, perm)
+char	cbuf[];
+int		perm[];
+{
+	int		pbuf[BLOCKSIZE+1];
+	char	word[HOTMAXLEN+1];
+	int		first, last, len, i;
+
+	if (permwcount(perm) < HOTMINWIRES)  return;
+	decode(cbuf, pbuf, perm);
+
+	for (first = 1 ; first < BLOCKSIZE-1 ; first = last + 1)  {
+		if (!isletter(pbuf[first])  ||  pbuf[first-1] == NONE
+		 || isletter(pbuf[first-1]))  {
+			last = first;
+			continue;
+			}
+		for (last = first ; last < BLOCKSIZE-1  &&  isletter(pbuf[last+1]) ; last++);
+		len = last - first + 1;
+		if (last >= BLOCKSIZE-1  ||  pbuf[last+1] == NONE)  continue;
+		if (len < HOTMINLEN  ||  len > HOTMAXLEN)  continue;
+		for (i = 0 ; i < len ; i++)  word[i] = pbuf[first+i];
+		word[len] = 0;
+		if (pwd_known(word))  continue;
+		for (i = 0 ; i < ncand  &&  strcmp(hot_cand[i], word) != 0 ; i++);
+		if (i < ncand)  {
+			hot_count[i]++;
+			continue;
+			}
+		if (ncand >= NHOTCANDS)  continue;
+		strcpy(hot_cand[ncand], word);
+		hot_count[ncand++] = 1;
+		}
+}
+
+
+/* Return TRUE if word is in the word file.
+ */
+int pwd_known(word)
+char	*word;
+{
+	int		i;
+
+	for (i = 0 ; word_tab[i] != NULL ; i++)
+		if (strcmp(word_tab[i], word) == 0)  return(TRUE);
+	return(FALSE);
+}
@@ -0,0 +1,138 @@
+/*
+ * The rotor of crypt(1), computed from a key.
+ *
+ * This follows setup() in enigma.c, with two differences.  The
+ * makekey program is replaced by a call to crypt(3), and the seed
+ * arithmetic is done in 32 bits as it was on the machines crypt
+ * was written for, so that a key found here also decrypts files
+ * made by the original program.
+ */
+
+#include	<stdio.h>
+#include	<string.h>
+#include	<stdint.h>
+#include	<crypt.h>
+#include	"rotor.h"
+
+
+#define	ROTSEED		123		/* Initial seed in crypt. */
+#define	ROTMOD		65521		/* Modulus of the random numbers. */
+
+/* Salt characters of crypt(3), in order of their six bit value. */
+char	rotsaltchars[] =
+	"./0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+/* Forward declarations */
+void rot_setup(char *key, rotor *rot);
+void rot_build(char *buf, rotor *rot);
+void rot_makekey(char *key, char *buf);
+void rot_blockperm(rotor *rot, int blknum, int *perm);
+void rot_zee(rotor *rot, int *zee);
+
+
+/* Fill in rot with the rotor and reflector crypt makes from key.
+ * Only the first ROTKEYLEN characters of key matter.
+ */
+void rot_setup(char *key, rotor *rot)
+{
+	char	buf[ROTCRYPTLEN+1];
+
+	rot_makekey(key, buf);
+	rot_build(buf, rot);
+}
+
+
+/* Fill in rot from buf, the makekey output for a key.  This is the
+ * cheap half of rot_setup, for callers that compute makekey
+ * themselves.
+ */
+void rot_build(char *buf, rotor *rot)
+{
+	int			i, k, ic, temp;
+	int32_t		seed;
+	uint32_t	random;
+
+	seed = ROTSEED;
+	for (i = 0 ; i < ROTCRYPTLEN ; i++)
+		seed = (int32_t) ((uint32_t) seed * (uint32_t) buf[i] + i);
+	for (i = 0 ; i < ROTORSZ ; i++)  {
+		rot->t1[i] = i;
+		rot->t3[i] = 0;
+		}
+	for (i = 0 ; i < ROTORSZ ; i++)  {
+		seed = (int32_t) (5 * (uint32_t) seed + (uint32_t) buf[i%ROTCRYPTLEN]);
+		random = (uint32_t) (seed % ROTMOD);
+		k = ROTORSZ-1 - i;
+		ic = (random & ROTMASK) % (k+1);
+		random >>= 8;
+		temp = rot->t1[k];
+		rot->t1[k] = rot->t1[ic];
+		rot->t1[ic] = temp;
+		if (rot->t3[k] != 0)  continue;
+		ic = (random & ROTMASK) % k;
+		while (rot->t3[ic] != 0)  if (++ic >= k)  ic = 0;
+		rot->t3[k] = ic;
+		rot->t3[ic] = k;
+		}
+	for (i = 0 ; i < ROTORSZ ; i++)
+		rot->t2[rot->t1[i]] = i;
+}
+
+
+/* Put the ROTCRYPTLEN characters that makekey prints for key in buf.
+ * Makekey encrypts the key with the salt taken from its first two
+ * characters.  The old crypt(3) used the low six bits of any salt
+ * character, so the salt is mapped onto the characters modern
+ * versions accept, and the original characters are put back in
+ * the output, where makekey had them.
+ */
+void rot_makekey(char *key, char *buf)
+{
+	char	kbuf[ROTKEYLEN+1];
+	char	salt[ROTSALTLEN+1];
+	char	*res;
+	int		i, c;
+
+	strncpy(kbuf, key, ROTKEYLEN);
+	kbuf[ROTKEYLEN] = '\0';
+	for (i = 0 ; i < ROTSALTLEN ; i++)  {
+		c = kbuf[i];
+		if (c > 'Z')  c -= 6;
+		if (c > '9')  c -= 7;
+		c -= '.';
+		salt[i] = rotsaltchars[c & 077];
+		}
+	salt[ROTSALTLEN] = '\0';
+
+	res = crypt(kbuf, salt);
+	for (i = 0 ; i < ROTCRYPTLEN ; i++)
+		buf[i] = (res != NULL  &&  (int) strlen(res) > i) ? res[i] : '\0';
+	for (i = 0 ; i < ROTSALTLEN ; i++)
+		buf[i] = kbuf[i];
+	buf[ROTCRYPTLEN] = '\0';
+}
+
+
+/* Fill in perm with the permutation of block blknum.
+ */
+void rot_blockperm(rotor *rot, int blknum, int *perm)
+{
+	int		x;
+
+	for (x = 0 ; x < ROTORSZ ; x++)
+		perm[x] = rot_wire(rot, blknum, x);
+	perm[ROTORSZ] = -1;
+}
+
+
+/* Fill in zee with the permutation that takes the permutation of
+ * each block to that of the next, as pgate uses it.
+ */
+void rot_zee(rotor *rot, int *zee)
+{
+	int		x;
+
+	for (x = 0 ; x < ROTORSZ ; x++)
+		zee[x] = rot->t2[(rot->t1[x] + 1) & ROTMASK];
+	zee[ROTORSZ] = -1;
+}
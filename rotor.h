@@ -0,0 +1,40 @@
+#ifndef __ROTOR_H
+#define __ROTOR_H
+
+/*
+ * Declarations for the rotor of crypt(1).
+ *
+ * Crypt turns its key into a rotor (t1, its inverse t2) and a
+ * reflector (t3).  Block b of the file is then enciphered by the
+ * permutation x -> t2[t3[t1[x]+b]-b], which is what the workbench
+ * calls the permutation of block b.  Knowing the key gives every
+ * block permutation and Zee at once.
+ */
+
+
+#define	ROTORSZ		256
+#define	ROTMASK		0377
+#define	ROTKEYLEN	8		/* Crypt only uses this many key chars. */
+#define	ROTSALTLEN	2		/* Makekey salt taken from the key. */
+#define	ROTCRYPTLEN	13		/* Length of the makekey output. */
+
+
+#define	rotor	struct xrotor
+rotor	{
+		int		t1[ROTORSZ];	/* The rotor. */
+		int		t2[ROTORSZ];	/* Its inverse. */
+		int		t3[ROTORSZ];	/* The reflector. */
+		};
+
+
+extern	void	rot_setup(/* key, rot */);	/* Rotor for a key. */
+extern	void	rot_build(/* buf, rot */);	/* Rotor for a makekey output. */
+extern	void	rot_makekey(/* key, buf */);	/* Makekey output. */
+extern	void	rot_blockperm(/* rot, blknum, perm */);
+extern	void	rot_zee(/* rot, zee */);
+
+/* Wire of x in block blknum of the rotor pointed to by r. */
+#define	rot_wire(r, blknum, x) \
+	((r)->t2[((r)->t3[((r)->t1[(x)] + (blknum)) & ROTMASK] - (blknum)) & ROTMASK])
+
+#endif /* __ROTOR_H */
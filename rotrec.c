@@ -0,0 +1,325 @@
+/*
+ * Recover the rotor and reflector of crypt(1) from a .perm file.
+ *
+ * Zee is the rotor's step by one seen through the rotor,
+ * zee[x] = t2[t1[x]+1], so following the cycle of Zee from x = 0
+ * numbers the chars the way t1 does, up to a constant added to
+ * every entry.  Any constant gives the same block permutations once
+ * the reflector is shifted to match, so t1[0] = 0 is taken as the
+ * canonical rotor.  Each known wire x-y of block b then gives two
+ * entries of the reflector, t3[t1[x]+b] = t1[y]+b and back, and every
+ * wire of every block is checked against what the others gave.
+ *
+ * With the rotor known each block permutation is computed directly
+ * rather than by running pgate from block 0, so the file is decoded
+ * a buffer at a time with one table lookup per char.  The canonical
+ * rotor is hashed into a fingerprint that is the same for every key
+ * that enciphers the same way, so recovered keys can be compared.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<unistd.h>
+#include	<fcntl.h>
+#include	"window.h"
+#include	"specs.h"
+#include	"rotor.h"
+#include	"tparse.h"
+
+
+#define	ROOTLEN		1000		/* Max length of a file name root. */
+#define	RRBUFBLKS	256			/* Blocks decoded per read. */
+#define	RRMAXBAD	10			/* Disagreeing wires listed. */
+#define	RRFNVBASIS	0xcbf29ce484222325ULL
+#define	RRFNVPRIME	0x100000001b3ULL
+
+
+/* What was recovered from a .perm file. */
+#define	rrinfo	struct xrrinfo
+rrinfo	{
+		int		zee[BLOCKSIZE+1];
+		int		perms[NPERMS][BLOCKSIZE+1];
+		rotor	rot;			/* t3 entries are NONE if unknown. */
+		int		nknown;			/* Known entries of t3. */
+		int		nwires;			/* Wires in the .perm file. */
+		int		nblocks;		/* Blocks with at least one wire. */
+		int		nbad;			/* Wires that disagree. */
+		};
+
+
+/* Forward declarations */
+void rr_usage(char *prog);
+void rr_load(rrinfo *rri, char *filename);
+int rr_rotor(rrinfo *rri);
+int rr_count(int *perm);
+void rr_reflector(rrinfo *rri);
+int rr_wire(rrinfo *rri, int b, int x, int y);
+void rr_canon(rotor *in, rotor *out);
+unsigned long long rr_fingerprint(rotor *rot);
+void rr_blockperm(rotor *rot, long blknum, int *perm);
+long rr_decode(rotor *rot, char *infile, char *outfile);
+
+
+rrinfo	myrrinfo;
+char	cfilebuf[ROOTLEN+10];
+char	pfilebuf[ROOTLEN+10];
+
+
+int main(argc, argv)
+int		argc;
+char	*argv[];
+{
+	rrinfo	*rri;
+	rotor	rot, canon;
+	long	n;
+
+	if (argc == 3  &&  strcmp(argv[1], "-k") == 0)  {
+		rot_setup(argv[2], &rot);
+		rr_canon(&rot, &canon);
+		printf("Fingerprint: %016llx\n", rr_fingerprint(&canon));
+		return 0;
+		}
+	if (argc < 2  ||  argc > 3  ||  strlen(argv[1]) > ROOTLEN)
+		rr_usage(argv[0]);
+	sprintf(pfilebuf, "%s.perm", argv[1]);
+	sprintf(cfilebuf, "%s.cipher", argv[1]);
+
+	rri = &myrrinfo;
+	rr_load(rri, pfilebuf);
+	if (!rr_rotor(rri))  {
+		printf("Zee in %s is not a single cycle of 256,", pfilebuf);
+		printf(" %d of 256 entries are known.\n", rr_count(rri->zee));
+		exit(0);
+		}
+	rr_reflector(rri);
+	printf("Reflector: %d of 256 entries from %d wires in %d blocks",
+	       rri->nknown, rri->nwires, rri->nblocks);
+	printf(", %d wires disagree.\n", rri->nbad);
+	if (rri->nbad > 0)  exit(0);
+	if (rri->nknown == ROTORSZ)
+		printf("Fingerprint: %016llx\n", rr_fingerprint(&rri->rot));
+
+	if (argc == 3)  {
+		n = rr_decode(&rri->rot, cfilebuf, argv[2]);
+		printf("Decoded %ld chars of %s into %s.\n", n, cfilebuf, argv[2]);
+		}
+	return 0;
+}
+
+
+/* Explain the arguments and exit.
+ */
+void rr_usage(char *prog)
+{
+	printf("Usage: %s FileNameRoot [clear_file]\n", prog);
+	printf("   or: %s -k key\n", prog);
+	printf("\tRecovers the rotor from Zee and the wires in FileNameRoot.perm");
+	printf("\n\tand prints its fingerprint.  With clear_file the whole of");
+	printf("\n\tFileNameRoot.cipher is decoded into it.");
+	printf("\n\tWith -k the fingerprint of the key is printed.\n");
+	exit(0);
+}
+
+
+/* Read Zee and the block permutations saved in filename.
+ */
+void rr_load(rrinfo *rri, char *filename)
+{
+	tpfile	tpf;
+	char	*msg;
+	int		b;
+
+	if (tp_open(&tpf, filename) != NULL)  {
+		printf("Could not open %s to read permutations.\n", filename);
+		exit(0);
+		}
+	msg = tp_perm(&tpf, rri->zee);
+	for (b = 0 ; msg == NULL  &&  b < NPERMS ; b++)
+		msg = tp_perm(&tpf, rri->perms[b]);
+	tp_close(&tpf);
+	if (msg != NULL)  {
+		printf("%s\n", msg);
+		exit(0);
+		}
+	rri->zee[BLOCKSIZE] = NONE;
+	for (b = 0 ; b < NPERMS ; b++)  rri->perms[b][BLOCKSIZE] = NONE;
+}
+
+
+/* Number the chars along the cycle of Zee to get the canonical t1
+ * and its inverse t2.  Returns FALSE if Zee is not known to be a
+ * single cycle of length 256.
+ */
+int rr_rotor(rrinfo *rri)
+{
+	rotor	*rot;
+	int		x, k;
+
+	rot = &rri->rot;
+	for (x = 0 ; x < ROTORSZ ; x++)  rot->t1[x] = NONE;
+	x = 0;
+	for (k = 0 ; k < ROTORSZ ; k++)  {
+		if (x == NONE  ||  rot->t1[x] != NONE)  return(FALSE);
+		rot->t1[x] = k;
+		rot->t2[k] = x;
+		x = rri->zee[x];
+		}
+	return(x == 0);
+}
+
+
+/* Return the number of known entries of perm.
+ */
+int rr_count(int *perm)
+{
+	int		x, n;
+
+	n = 0;
+	for (x = 0 ; x < BLOCKSIZE ; x++)
+		if (perm[x] != NONE)  n++;
+	return(n);
+}
+
+
+/* Fill in the reflector from the wires of every block, counting the
+ * wires that disagree with what came before them.
+ */
+void rr_reflector(rrinfo *rri)
+{
+	int		b, x, y;
+	int		*perm;
+	int		inblock;
+
+	for (x = 0 ; x < ROTORSZ ; x++)  rri->rot.t3[x] = NONE;
+	rri->nknown = rri->nwires = rri->nblocks = rri->nbad = 0;
+
+	for (b = 0 ; b < NPERMS ; b++)  {
+		perm = rri->perms[b];
+		inblock = FALSE;
+		for (x = 0 ; x < BLOCKSIZE ; x++)  {
+			if ((y = perm[x]) == NONE  ||  y < x)  continue;
+			inblock = TRUE;
+			rri->nwires++;
+			if (!rr_wire(rri, b, x, y))  {
+				if (rri->nbad < RRMAXBAD)
+					printf("Block %d: wire %d-%d disagrees with the other blocks.\n",
+					       b, x, y);
+				rri->nbad++;
+				}
+			}
+		if (inblock)  rri->nblocks++;
+		}
+}
+
+
+/* Enter wire x-y of block b into the reflector.
+ * Returns FALSE if it disagrees with an entry already there.
+ */
+int rr_wire(rrinfo *rri, int b, int x, int y)
+{
+	int		*t3;
+	int		u, v;
+
+	t3 = rri->rot.t3;
+	u = (rri->rot.t1[x] + b) & ROTMASK;
+	v = (rri->rot.t1[y] + b) & ROTMASK;
+	if (u == v)  return(FALSE);				/* Crypt's reflector has no fixed points. */
+	if (t3[u] == NONE  &&  t3[v] == NONE)  {
+		t3[u] = v;
+		t3[v] = u;
+		rri->nknown += 2;
+		return(TRUE);
+		}
+	return(t3[u] == v  &&  t3[v] == u);
+}
+
+
+/* Put the rotor in in canonical form, with t1[0] = 0, in out.
+ */
+void rr_canon(rotor *in, rotor *out)
+{
+	int		c, x;
+
+	c = in->t1[0];
+	for (x = 0 ; x < ROTORSZ ; x++)  {
+		out->t1[x] = (in->t1[x] - c) & ROTMASK;
+		out->t2[out->t1[x]] = x;
+		out->t3[x] = (in->t3[(x + c) & ROTMASK] - c) & ROTMASK;
+		}
+}
+
+
+/* Return a 64 bit FNV-1a hash of the canonical rotor rot.
+ */
+unsigned long long rr_fingerprint(rotor *rot)
+{
+	unsigned long long	h;
+	int		x;
+
+	h = RRFNVBASIS;
+	for (x = 0 ; x < ROTORSZ ; x++)  {
+		h = (h ^ (rot->t1[x] & ROTMASK)) * RRFNVPRIME;
+		h = (h ^ (rot->t3[x] & ROTMASK)) * RRFNVPRIME;
+		}
+	return(h);
+}
+
+
+/* Fill in perm with the permutation of block blknum, leaving NONE
+ * where the reflector is not known.
+ */
+void rr_blockperm(rotor *rot, long blknum, int *perm)
+{
+	int		x, b, v;
+
+	b = blknum & ROTMASK;
+	for (x = 0 ; x < ROTORSZ ; x++)  {
+		v = rot->t3[(rot->t1[x] + b) & ROTMASK];
+		perm[x] = (v == NONE) ? NONE : rot->t2[(v - b) & ROTMASK];
+		}
+}
+
+
+/* Decode infile into outfile, a buffer at a time.  The permutation
+ * of each block is computed when the block starts, so each char
+ * takes one lookup.  Chars whose wire is unknown come out as '?',
+ * as in zeecode.
+ * Returns the number of chars decoded.
+ */
+long rr_decode(rotor *rot, char *infile, char *outfile)
+{
+	unsigned char	buf[RRBUFBLKS*BLOCKSIZE];
+	int		perm[BLOCKSIZE];
+	int		in, out;
+	int		pos, w;
+	long	n, i, total;
+
+	if ((in = open(infile, O_RDONLY)) < 0)  {
+		printf("Could not open %s to read the cipher.\n", infile);
+		exit(0);
+		}
+	if ((out = open(outfile, O_WRONLY|O_CREAT|O_TRUNC, 0666)) < 0)  {
+		printf("Could not open %s to write the clear text.\n", outfile);
+		exit(0);
+		}
+
+	total = 0;
+	while ((n = read(in, buf, sizeof(buf))) > 0)  {
+		for (i = 0 ; i < n ; i++)  {
+			pos = (total + i) & MODMASK;
+			if (pos == 0  ||  i == 0)
+				rr_blockperm(rot, (total + i) / BLOCKSIZE, perm);
+			w = perm[(buf[i] + pos) & MODMASK];
+			buf[i] = (w == NONE) ? '?' : (w - pos) & MODMASK;
+			}
+		if (write(out, buf, n) != n)  {
+			printf("Error writing %s.\n", outfile);
+			exit(0);
+			}
+		total += n;
+		}
+	close(in);
+	close(out);
+	return(total);
+}
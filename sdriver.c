@@ -31,8 +31,10 @@ int main(void)
 
 	printf("\nStatistics Test driver.  Type a line to see its score.\n\n");
 
-	load_1stats_from("mss.stats");
-	load_2stats_from("mss-bigram.stats");
+	letterstats = "mss.stats";
+	need_1stats();
+	bigramstats = "mss-bigram.stats";
+	need_2stats();
 
 	gsi = &mygsi;
 	gsi->cknown = kwnbuf;
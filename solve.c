@@ -0,0 +1,263 @@
+/*
+ * Batch program that runs the automatic solver on a file and
+ * saves the permutations and Zee it finds, without the workbench.
+ * It can also queue solver jobs in a spool directory, or work
+ * through the jobs queued there (see spool.c).
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<unistd.h>
+#include	"window.h"
+#include	"specs.h"
+#include	"orch.h"
+#include	"wordscore.h"
+#include	"arena.h"
+
+
+/* Shell variable names. */
+#define	LETTERSTATS	"LETTERSTATS"
+#define	BIGRAMSTATS	"BIGRAMSTATS"
+#define	TRIGRAMSTATS	"TRIGRAMSTATS"
+
+#define	NOWORDS		"-"		/* Pwords file name for no pwords. */
+#define	QUEUEFLAG	"-q"		/* First argument to queue a job. */
+#define	WORKFLAG	"-w"		/* First argument to work on the queue. */
+#define	ROOTLEN		1000		/* Max length of a file name root. */
+
+
+extern	int	kzee[];
+extern	arena	permarena;
+extern	char	*getenv();
+extern	char	*spool_submit(char *dir, char *root, int first, int last,
+			              char *pipeline, long seconds, char *pwfile);
+extern	int		spool_work(char *dir, long linger);
+
+/* Forward declarations */
+void solve_usage(char *prog);
+void solve_queue(int argc, char *argv[]);
+void solve_setroot(char *root);
+void solve_loadstats(void);
+char *solve_stats(char *var);
+void solve_resume(char *filename);
+void solve_report(char *str);
+
+orchinfo	myorchinfo;
+char		cfilebuf[ROOTLEN+10];
+char		pfilebuf[ROOTLEN+10];
+char		*solve_result[] = {"Solved", "Fixpoint", "Out of time"};
+
+
+int main(argc, argv)
+int		argc;
+char	*argv[];
+{
+	int		result;
+	long	linger;
+	orchinfo	*ori;
+
+	if (argc >= 2  &&  strcmp(argv[1], QUEUEFLAG) == 0)  {
+		solve_queue(argc, argv);
+		return 0;
+		}
+	if (argc >= 2  &&  strcmp(argv[1], WORKFLAG) == 0)  {
+		if (argc < 3 || argc > 4)  solve_usage(argv[0]);
+		linger = 0;
+		if (argc == 4  &&  sscanf(argv[3], "%ld", &linger) != 1)  {
+			printf("Could not parse the linger time from %s.\n", argv[3]);
+			exit(0);
+			}
+		solve_loadstats();
+		result = spool_work(argv[2], linger);
+		printf("Worker finished after %d jobs.\n", result);
+		return 0;
+		}
+
+	if (argc < 2 || argc > 4)  solve_usage(argv[0]);
+	solve_setroot(argv[1]);
+
+	ori = &myorchinfo;
+	ori->budget = 0;
+	if (argc >= 3  &&  sscanf(argv[2], "%ld", &ori->budget) != 1)  {
+		printf("Could not parse the number of seconds from %s.\n", argv[2]);
+		exit(0);
+		}
+	ori->pwfile = (argc == 4) ? argv[3] : NOWORDS;
+	ori->report = solve_report;
+	ori->steps = ORGUESS | ORKNIT | ORPROP;
+	ori->first = 0;
+	ori->last = NONE;
+
+	solve_loadstats();
+	solve_resume(permfile);
+	permchgflg = FALSE;
+
+	result = orch_run(ori);
+
+	printf("%s after %d passes: %d of %d wires, Zee %d of 256.\n",
+	       solve_result[result], ori->pass, orch_wires(ori),
+	       ori->nblocks * (BLOCKSIZE/2), permcount(kzee));
+	if (permsave(NULL) != NULL)  {
+		printf("%s\n", statmsg);
+		exit(1);
+		}
+	printf("Permutations saved in %s.\n", permfile);
+	ar_report(stdout, "Permutation space", &permarena);
+
+	return 0;
+}
+
+
+/* Explain the arguments and exit.
+ */
+void solve_usage(char *prog)
+{
+	printf("Usage: %s FileNameRoot [seconds [pwords_file]]\n", prog);
+	printf("   or: %s %s spooldir FileNameRoot", prog, QUEUEFLAG);
+	printf(" [first last [pipeline [seconds [pwords_file]]]]\n");
+	printf("   or: %s %s spooldir [linger_seconds]\n", prog, WORKFLAG);
+	printf("\tReads FileNameRoot.cipher and writes FileNameRoot.perm.");
+	printf("\n\tIf FileNameRoot.perm exists, the solver starts from it.");
+	printf("\n\tSeconds limits the running time, 0 means no limit.");
+	printf("\n\t%s queues a job on blocks first to last,", QUEUEFLAG);
+	printf(" the pipeline is auto, guess or knit.");
+	printf("\n\t%s runs queued jobs until none has been seen", WORKFLAG);
+	printf(" for linger_seconds.");
+	printf("\n\tThe shell variables");
+	printf(" %s, %s and %s", LETTERSTATS, BIGRAMSTATS, TRIGRAMSTATS);
+	printf("\n\tmust be defined to solve.\n");
+	exit(0);
+}
+
+
+/* Queue a job as described by the arguments after QUEUEFLAG.
+ */
+void solve_queue(int argc, char *argv[])
+{
+	int		first, last;
+	long	seconds;
+	char	*pipeline, *pwfile, *msg;
+
+	if (argc < 4  ||  argc == 5  ||  argc > 9)  solve_usage(argv[0]);
+	first = 0;
+	last = NONE;
+	pipeline = "auto";
+	seconds = 0;
+	pwfile = NOWORDS;
+	if (argc >= 6  &&  (sscanf(argv[4], "%d", &first) != 1
+	                 || sscanf(argv[5], "%d", &last) != 1))  {
+		printf("Could not parse the block range %s %s.\n", argv[4], argv[5]);
+		exit(0);
+		}
+	if (argc >= 7)  pipeline = argv[6];
+	if (argc >= 8  &&  sscanf(argv[7], "%ld", &seconds) != 1)  {
+		printf("Could not parse the number of seconds from %s.\n", argv[7]);
+		exit(0);
+		}
+	if (argc >= 9)  pwfile = argv[8];
+
+	msg = spool_submit(argv[2], argv[3], first, last, pipeline, seconds, pwfile);
+	if (msg != NULL)  {
+		printf("%s\n", msg);
+		exit(1);
+		}
+}
+
+
+/* Set cipherfile and permfile from the file name root.
+ */
+void solve_setroot(char *root)
+{
+	char	*q, *pp, *pc;
+
+	if (strlen(root) > ROOTLEN)  {
+		printf("The file name root %s is too long.\n", root);
+		exit(0);
+		}
+	q = root;
+	pc = cipherfile = cfilebuf;
+	pp = permfile = pfilebuf;
+	while ((*pp++ = *pc++ = *q++));
+	pp--;
+	pc--;
+	q = ".cipher";
+	while ((*pc++ = *q++));
+	q = ".perm";
+	while ((*pp++ = *q++));
+}
+
+
+/* Load the statistics the guessing engines use, and the word list
+ * if WSVAR names one.
+ */
+void solve_loadstats(void)
+{
+	char	*msg;
+
+	letterstats = solve_stats(LETTERSTATS);
+	need_1stats();
+	bigramstats = solve_stats(BIGRAMSTATS);
+	need_2stats();
+	trigramstats = solve_stats(TRIGRAMSTATS);
+	need_tri();
+	if ((msg = ws_load()) != NULL)  {
+		printf("%s\n", msg);
+		exit(0);
+		}
+}
+
+
+/* Return the value of the shell variable naming a statistics file.
+ */
+char *solve_stats(char *var)
+{
+	char	*name;
+
+	if ((name = getenv(var)) == NULL)  {
+		printf("The shell variable %s is not defined.\n", var);
+		exit(0);
+		}
+	return(name);
+}
+
+
+/* Start from the permutations and Zee in filename, if it exists.
+ * This reads the format of permsave without touching the display
+ * as permload does.
+ */
+void solve_resume(char *filename)
+{
+	char	*msg;
+
+	if (access(filename, F_OK) != 0)  return;
+	if ((msg = permread(filename)) != NULL)  {
+		printf("%s\n", msg);
+		exit(0);
+		}
+	printf("Starting from %s.\n", filename);
+}
+
+
+/* Print the progress line for one pass.
+ */
+void solve_report(char *str)
+{
+	printf("%s\n", str);
+	fflush(stdout);
+}
+
+
+key u_getkey(void)
+{
+	return 0;
+}
+
+keyer	topktab[] ={{0, NULL}};
+
+
+char *quitcmd(char *arg __attribute__((unused)))
+{
+	printf("\n");
+	exit(1);
+}
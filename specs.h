@@ -52,11 +52,18 @@ extern	char *(atrguess(/* arg-string */));
 extern	char *(kntguess(/* arg-string */));
 extern	char *(ecbguess(/* arg-string */));
 extern	char *(pwdguess(/* arg-string */));
+extern	char *(phrguess(/* arg-string */));
+extern	char *(wwguess(/* arg-string */));
 extern	char *(permsave(/* arg-string */));
 extern	char *(permload(/* arg-string */));
+extern	char *(permautosave());		/* NULL or error of last autosave. */
+extern	int	permautosecs();			/* Seconds between autosaves, 0 if none. */
 extern	char *(webmatch(/* arg-string */));
 extern	char *(clearzee(/* arg-string */));
 extern	char *(pgate(/* arg-string */));
+extern	char *(ensguess(/* arg-string */));
+extern	char *(msguess(/* arg-string */));
+extern	char *(orchcmd(/* arg-string */));
 
 extern	char *(cmddo(/* cmdtab, string */));
 extern	char *(cmdcomplete(/* cmdtab, string */));
@@ -85,11 +92,18 @@ extern	float	gsi_2score(/* gsi */);		/* Uses 2nd order stats. */
 extern	float	var_1score(/* pvec */);		/* Uses first order stats. */
 extern	float	prob_1score(/* pvec */);	/* Uses first order stats. */
 extern	float	pvec_1score(/* pvec */);	/* Uses first order stats. */
-extern	void	load_1stats();			/* Loads first order stats. */
+extern	float	sum_1score(float sum, float count);	/* Score of a logprob sum. */
+extern	float	pbuf_2score(/* pbuf */);	/* Whole block, 2nd order stats. */
+extern	char	*load_1stats();			/* Parses first order stats. */
 extern	void	print_1stats();
-extern	void load_1stats_from(/* statfname */);
-extern	void load_2stats_from(/* statfname */);
-extern	void load_tri_from(/* filename */);
+extern	char	*load_1stats_from(/* statfname */);	/* NULL or error msg. */
+extern	char	*load_2stats_from(/* statfname */);
+extern	char	*load_tri_from(/* filename */);
+extern	void	need_1stats();		/* Load letterstats or exit. */
+extern	void	need_2stats();
+extern	void	need_tri();
+extern	void	need_exit(/* msg */);	/* Puts the terminal back, exits. */
+extern	void	(*need_cleanup)();	/* How need_exit puts it back. */
 
 extern void ec_init(/* char cipher[], int perm[], ecinfo *eci */);
 
@@ -116,9 +130,11 @@ extern	void	str2pvec(/* string, pvec */);		/* Fills in pvec. */
 extern	void	pvec2str(/* string, pvec */);		/* Fills in string. */
 
 extern	int	fillcbuf(/* blocknum, *cbuf */);   /* Ret TRUE if sucessful. */
+/* Returns best start offset of crypt output in file, or -1. */
+extern	long	align_detect(/* filename, maxstart, *confp */);
 extern	int	*refperm(/* blocknum */);	   /* Ret NULL if fails. */
 extern	void copyperm(/* src, dst */);
-extern	void readperm(/* fd, permbuffer */);	/* Gets chars from fd to fill perm. */
+extern	char	*permread(/* filename */);	/* Zee and perms, NULL or error. */
 extern	void writeperm(/* fd, permbuffer */);	   /* Writes perm to file. */
 extern	void multperm(/* left, right, result = (left)(right) */);
 extern	void expperm(/* src, dst, k */);		   /* dst = src ** k. */
@@ -132,6 +148,7 @@ extern	float	isqrt[];		/* Sqrts of integers < BLOCKSIZE */
 
 /* Globals State */
 extern	char	*cipherfile;		/* Ciphertext file name. */
+extern	long	cipheroffset;		/* Where block 0 starts in cipherfile. */
 extern	char	*permfile;		/* Permutation save file name. */
 extern	char	*letterstats;		/* Single letter stat file name. */
 extern	char	*bigramstats;		/* Letter pair statistics file name. */
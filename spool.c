@@ -0,0 +1,408 @@
+/*
+ * Job spool for running the automatic solver on many machines.
+ *
+ * The only thing the machines need to share is a directory.  A job
+ * is a small text file naming a file root, a block range and a
+ * pipeline.  It is queued by renaming it into new/ and claimed by
+ * renaming it from new/ into work/; rename is atomic, so exactly one
+ * worker gets each job.  The worker runs the job in a child process
+ * and touches the claimed file every few seconds while the child is
+ * alive.  A claimed file that has not been touched for SPSTALE
+ * seconds belongs to a worker that died, and any worker renames it
+ * back into new/.  After every pass the child saves its permutations
+ * in out/, so the next worker to claim the job starts from there.
+ * Finished jobs are moved to done/, and each job keeps a log of its
+ * passes in out/.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<unistd.h>
+#include	<errno.h>
+#include	<time.h>
+#include	<dirent.h>
+#include	<utime.h>
+#include	<sys/types.h>
+#include	<sys/stat.h>
+#include	<sys/wait.h>
+#include	"window.h"
+#include	"specs.h"
+#include	"orch.h"
+
+
+#define	SPPATHLEN	1200	/* Max length of a path in the spool. */
+#define	SPNAMELEN	200		/* Max length of a job name. */
+#define	SPBEAT		5		/* Seconds between heartbeats. */
+#define	SPSTALE		120		/* Seconds without one before requeueing. */
+#define	SPEXT		".job"	/* Extension of job files. */
+
+/* Subdirectories of the spool. */
+#define	SPNEW		"new"	/* Jobs waiting for a worker. */
+#define	SPWORK		"work"	/* Jobs claimed by a worker. */
+#define	SPDONE		"done"	/* Finished jobs. */
+#define	SPOUT		"out"	/* Permutations and logs of each job. */
+#define	SPTMP		"tmp"	/* Files being written. */
+
+
+#define	spjob	struct xspjob
+spjob	{
+		char	root[SPPATHLEN];	/* File name root of the cipher. */
+		int		first;			/* Block range. */
+		int		last;
+		char	pipeline[SPNAMELEN];	/* Name known to orch_steps. */
+		long	seconds;		/* Time budget, 0 for none. */
+		char	pwfile[SPPATHLEN];	/* Pwords file or "-". */
+		};
+
+
+extern	int	kzee[];
+extern	void	solve_setroot(char *root);
+
+/* Forward declarations */
+char *spool_submit(char *dir, char *root, int first, int last,
+                   char *pipeline, long seconds, char *pwfile);
+int spool_work(char *dir, long linger);
+int spool_claim(char *dir, char *name);
+void spool_requeue(char *dir);
+int spool_runjob(char *dir, char *name);
+void spool_child(char *dir, char *name, spjob *job);
+void spool_report(char *str);
+int spool_readjob(char *filename, spjob *job);
+void spool_mkdirs(char *dir);
+void spool_path(char *buf, char *dir, char *sub, char *name, char *ext);
+
+/* Global state of a job's child process. */
+FILE	*splog;					/* Log of passes. */
+char	spperm[SPPATHLEN];		/* Checkpoint file. */
+char	sptmp[SPPATHLEN];		/* Where the checkpoint is written. */
+orchinfo	sporchinfo;
+
+
+/* Queue a job to run pipeline on blocks first to last of root.
+ * A last of NONE means the last whole block of the cipher.
+ * Prints the name of the job.
+ * Returns NULL if sucessful, else an error message.
+ */
+char *spool_submit(char *dir, char *root, int first, int last,
+                   char *pipeline, long seconds, char *pwfile)
+{
+	FILE	*fd;
+	struct stat	st;
+	char	*base;
+	char	name[SPNAMELEN];
+	char	cwd[SPPATHLEN];
+	char	tmp[SPPATHLEN], new[SPPATHLEN];
+
+	if (orch_steps(pipeline) == 0)  {
+		sprintf(statmsg, "There is no pipeline called %s.", pipeline);
+		return(statmsg);
+		}
+	if (strlen(root) + SPNAMELEN > SPPATHLEN)  return("File name too long.");
+
+	/* Name the job by the blocks it will really run on. */
+	sprintf(tmp, "%s.cipher", root);
+	if (access(tmp, R_OK) != 0  ||  stat(tmp, &st) != 0)  {
+		sprintf(statmsg, "Could not read %.1000s.", tmp);
+		return(statmsg);
+		}
+	if (last == NONE)  last = st.st_size / BLOCKSIZE - 1;
+	if (last >= NPERMS)  last = NPERMS - 1;
+	if (first < 0  ||  first > last)  {
+		sprintf(statmsg, "%.1000s has no blocks %d to %d.", tmp, first, last);
+		return(statmsg);
+		}
+	spool_mkdirs(dir);
+
+	/* Workers may run elsewhere, so make the root absolute. */
+	cwd[0] = 0;
+	if (root[0] != '/'  &&  getcwd(cwd, SPPATHLEN - SPNAMELEN) != NULL)
+		strcat(cwd, "/");
+
+	base = strrchr(root, '/');
+	base = (base == NULL) ? root : base + 1;
+	sprintf(name, "%.100s.%d-%d.%s.%ld.%d", base, first, last, pipeline,
+	        (long) time(NULL), (int) getpid());
+
+	spool_path(tmp, dir, SPTMP, name, SPEXT);
+	spool_path(new, dir, SPNEW, name, SPEXT);
+	if ((fd = fopen(tmp, "w")) == NULL)  {
+		sprintf(statmsg, "Could not create %s.", tmp);
+		return(statmsg);
+		}
+	fprintf(fd, "root %s%s\n", cwd, root);
+	fprintf(fd, "first %d\n", first);
+	fprintf(fd, "last %d\n", last);
+	fprintf(fd, "pipeline %s\n", pipeline);
+	fprintf(fd, "seconds %ld\n", seconds);
+	fprintf(fd, "pwords %s\n", pwfile);
+	if (fclose(fd) != 0  ||  rename(tmp, new) != 0)  {
+		sprintf(statmsg, "Could not queue %s.", new);
+		return(statmsg);
+		}
+	printf("Queued %s.\n", name);
+	return(NULL);
+}
+
+
+/* Run jobs from the spool until no job has been waiting for linger
+ * seconds.  Returns the number of jobs run.
+ */
+int spool_work(char *dir, long linger)
+{
+	int		njobs;
+	time_t	idle;
+	char	name[SPNAMELEN];
+
+	spool_mkdirs(dir);
+	njobs = 0;
+	idle = time(NULL);
+	while (TRUE)  {
+		spool_requeue(dir);
+		if (spool_claim(dir, name))  {
+			spool_runjob(dir, name);
+			njobs++;
+			idle = time(NULL);
+			continue;
+			}
+		if (time(NULL) - idle >= linger)  break;
+		sleep(1);
+		}
+	return(njobs);
+}
+
+
+/* Claim a waiting job, leaving its name in name.
+ * Returns TRUE if one was claimed.
+ */
+int spool_claim(char *dir, char *name)
+{
+	DIR		*dp;
+	struct dirent	*de;
+	char	from[SPPATHLEN], to[SPPATHLEN];
+	int		len, claimed;
+
+	spool_path(from, dir, SPNEW, "", "");
+	if ((dp = opendir(from)) == NULL)  return(FALSE);
+
+	claimed = FALSE;
+	while (!claimed  &&  (de = readdir(dp)) != NULL)  {
+		len = strlen(de->d_name) - strlen(SPEXT);
+		if (len <= 0  ||  len >= SPNAMELEN)  continue;
+		if (strcmp(&de->d_name[len], SPEXT) != 0)  continue;
+		strncpy(name, de->d_name, len);
+		name[len] = 0;
+		spool_path(from, dir, SPNEW, name, SPEXT);
+		spool_path(to, dir, SPWORK, name, SPEXT);
+		if (rename(from, to) == 0)  {
+			utime(to, NULL);		/* First heartbeat. */
+			claimed = TRUE;
+			}
+		}
+	closedir(dp);
+	return(claimed);
+}
+
+
+/* Put back in new/ every claimed job whose worker has stopped
+ * sending heartbeats.
+ */
+void spool_requeue(char *dir)
+{
+	DIR		*dp;
+	struct dirent	*de;
+	struct stat	st;
+	char	from[SPPATHLEN], to[SPPATHLEN];
+
+	spool_path(from, dir, SPWORK, "", "");
+	if ((dp = opendir(from)) == NULL)  return;
+
+	while ((de = readdir(dp)) != NULL)  {
+		if (de->d_name[0] == '.')  continue;
+		if (strlen(de->d_name) >= SPNAMELEN)  continue;
+		spool_path(from, dir, SPWORK, de->d_name, "");
+		if (stat(from, &st) != 0)  continue;
+		if (time(NULL) - st.st_mtime <= SPSTALE)  continue;
+		spool_path(to, dir, SPNEW, de->d_name, "");
+		if (rename(from, to) == 0)
+			printf("Requeued stale job %s.\n", de->d_name);
+		}
+	closedir(dp);
+}
+
+
+/* Run the claimed job called name in a child process, sending
+ * heartbeats until it exits, then move it to done/.
+ * Returns TRUE if the child finished the job.
+ */
+int spool_runjob(char *dir, char *name)
+{
+	spjob	job;
+	pid_t	pid;
+	int		status, ok;
+	long	waited;
+	char	work[SPPATHLEN], done[SPPATHLEN];
+
+	spool_path(work, dir, SPWORK, name, SPEXT);
+	spool_path(done, dir, SPDONE, name, SPEXT);
+	if (!spool_readjob(work, &job))  {
+		printf("Job %s is not readable, moved to %s.\n", name, SPDONE);
+		rename(work, done);
+		return(FALSE);
+		}
+
+	printf("Starting job %s.\n", name);
+	fflush(stdout);
+	if ((pid = fork()) < 0)  {
+		printf("Could not fork to run job %s.\n", name);
+		rename(work, done);
+		return(FALSE);
+		}
+	if (pid == 0)  {
+		spool_child(dir, name, &job);
+		fflush(stdout);
+		_exit(0);
+		}
+
+	for (waited = 0 ; ; waited++)  {
+		if (waitpid(pid, &status, WNOHANG) == pid)  break;
+		if (waited % SPBEAT == 0)  utime(work, NULL);
+		sleep(1);
+		}
+
+	ok = WIFEXITED(status)  &&  WEXITSTATUS(status) == 0;
+	if (rename(work, done) != 0)
+		printf("Job %s was requeued while it ran.\n", name);
+	printf("Job %s %s.\n", name, ok ? "finished" : "failed");
+	return(ok);
+}
+
+
+/* Body of the child process that runs a job.
+ * Starts from the job's checkpoint if a previous worker left one,
+ * else from the .perm file of the root.  Exits with status 1 if the
+ * cipher or the starting permutations cannot be read, so the job is
+ * reported as failed.
+ */
+void spool_child(char *dir, char *name, spjob *job)
+{
+	orchinfo	*ori;
+	int		result;
+	char	*start, *msg;
+	char	logname[SPPATHLEN];
+
+	spool_path(logname, dir, SPOUT, name, ".log");
+	spool_path(spperm, dir, SPOUT, name, ".perm");
+	spool_path(sptmp, dir, SPTMP, name, ".perm");
+	if ((splog = fopen(logname, "a")) == NULL)  _exit(1);
+
+	solve_setroot(job->root);
+	if (access(cipherfile, R_OK) != 0)  {
+		fprintf(splog, "Could not read %s.\n", cipherfile);
+		fclose(splog);
+		_exit(1);
+		}
+	start = (access(spperm, R_OK) == 0) ? spperm : permfile;
+	if (access(start, F_OK) == 0)  {
+		if ((msg = permread(start)) != NULL)  {
+			fprintf(splog, "%s\n", msg);
+			fclose(splog);
+			_exit(1);
+			}
+		fprintf(splog, "Starting from %s.\n", start);
+		}
+	permfile = sptmp;
+
+	ori = &sporchinfo;
+	ori->first = job->first;
+	ori->last = job->last;
+	ori->steps = orch_steps(job->pipeline);
+	ori->budget = job->seconds;
+	ori->pwfile = job->pwfile;
+	ori->report = spool_report;
+
+	fprintf(splog, "Job %s on blocks %d to %d, pipeline %s.\n",
+	        name, job->first, job->last, job->pipeline);
+	result = orch_run(ori);
+	spool_report("");
+	fprintf(splog, "Result %d after %d passes: %d of %d wires, Zee %d of 256.\n",
+	        result, ori->pass, orch_wires(ori),
+	        ori->nblocks * (BLOCKSIZE/2), permcount(kzee));
+	fclose(splog);
+}
+
+
+/* Log the progress line for one pass and save a checkpoint.
+ * The checkpoint is written beside the old one and renamed over
+ * it so that a worker that dies never leaves half a file.
+ */
+void spool_report(char *str)
+{
+	if (*str != 0)  fprintf(splog, "%s\n", str);
+	fflush(splog);
+	if (permsave(NULL) == NULL)
+		rename(sptmp, spperm);
+}
+
+
+/* Read the job file filename into job.
+ * Returns TRUE if all the fields were found.
+ */
+int spool_readjob(char *filename, spjob *job)
+{
+	FILE	*fd;
+	int		found;
+	char	field[SPNAMELEN];
+
+	if ((fd = fopen(filename, "r")) == NULL)  return(FALSE);
+	found = 0;
+	while (fscanf(fd, "%199s", field) == 1)  {
+		if (strcmp(field, "root") == 0)
+			found |= (fscanf(fd, " %1199[^\n]", job->root) == 1) << 0;
+		else if (strcmp(field, "first") == 0)
+			found |= (fscanf(fd, "%d", &job->first) == 1) << 1;
+		else if (strcmp(field, "last") == 0)
+			found |= (fscanf(fd, "%d", &job->last) == 1) << 2;
+		else if (strcmp(field, "pipeline") == 0)
+			found |= (fscanf(fd, "%199s", job->pipeline) == 1) << 3;
+		else if (strcmp(field, "seconds") == 0)
+			found |= (fscanf(fd, "%ld", &job->seconds) == 1) << 4;
+		else if (strcmp(field, "pwords") == 0)
+			found |= (fscanf(fd, " %1199[^\n]", job->pwfile) == 1) << 5;
+		}
+	fclose(fd);
+	return(found == 077  &&  orch_steps(job->pipeline) != 0);
+}
+
+
+/* Create the spool directory and its subdirectories if needed.
+ */
+void spool_mkdirs(char *dir)
+{
+	char	path[SPPATHLEN];
+
+	if (strlen(dir) + SPNAMELEN + 10 > SPPATHLEN)  {
+		printf("The spool directory name %s is too long.\n", dir);
+		exit(0);
+		}
+	mkdir(dir, 0777);
+	spool_path(path, dir, SPNEW, "", "");
+	mkdir(path, 0777);
+	spool_path(path, dir, SPWORK, "", "");
+	mkdir(path, 0777);
+	spool_path(path, dir, SPDONE, "", "");
+	mkdir(path, 0777);
+	spool_path(path, dir, SPOUT, "", "");
+	mkdir(path, 0777);
+	spool_path(path, dir, SPTMP, "", "");
+	mkdir(path, 0777);
+}
+
+
+/* Fill in buf with the path of name with extension ext in the
+ * subdirectory sub of the spool dir.
+ */
+void spool_path(char *buf, char *dir, char *sub, char *name, char *ext)
+{
+	sprintf(buf, "%s/%s/%s%s", dir, sub, name, ext);
+}
@@ -19,6 +19,7 @@
 #include	"terminal.h"
 #include	"layout.h"
 #include	"specs.h"
+#include	"wordscore.h"
 
 
 /* Shell variable names. */
@@ -27,6 +28,7 @@
 #define	TRIGRAMSTATS	"TRIGRAMSTATS"
 
 #define	QUITMSG	"Permutations not saved.  Type 'y' if you want to quit."
+#define	AUTOOFFSET	"auto"	/* Offset argument that asks for detection. */
 
 
 /* Keystroke behavior that is the same in all windows.
@@ -37,13 +39,23 @@ extern	char	*getenv();
 extern	void setup_term(void);
 extern	void unset_term(void);
 extern	int getcmd(void);
+extern	void kntbackground(void);
+extern	int keywaiting(void);
+extern	int keywait(int secs);
+extern	int	stats1loaded;
+extern	int	stats2loaded;
+extern	int	trig_loaded;
 
 /* Forward declarations */
 void load_tables(void);
+char *load_name(char *var);
+void load_background(void);
+void set_offset(char *arg);
 void stop_handler(int sig);
 void kill_handler(int sig);
 void initwindows(void);
 void done(int status);
+void need_restore(void);
 
 keyer	topktab[] = {
 		{CREFRESH, alldraw},
@@ -62,6 +74,14 @@ char		pfilebuf[100];
  */
 jmp_buf		saved_stack;
 
+/* TRUE once the word list of wordscore.c has been looked for.
+ */
+int			wschecked = FALSE;
+
+/* TRUE if a table could not be loaded in the background.
+ */
+int			ldfailed = FALSE;
+
 
 int main(argc, argv)
 int		argc;
@@ -69,9 +89,12 @@ char	*argv[];
 {
 	char	*q, *pp, *pc;
 
-	if (argc < 2)  {
-		printf("Usage: %s FileNameRoot\n", argv[0]);
+	if (argc < 2 || argc > 3)  {
+		printf("Usage: %s FileNameRoot [offset | %s]\n", argv[0], AUTOOFFSET);
 		printf("\tThe extensions .cipher and .perm will be used.");
+		printf("\n\tThe ciphertext starts offset bytes into the .cipher file,");
+		printf("\n\tor where the alignment detector finds it if %s is given.",
+		       AUTOOFFSET);
 		printf("\n\tThe shell variables");
 		printf(" %s, %s, %s,", LETTERSTATS, TRIGRAMSTATS, BIGRAMSTATS);
 		printf("\n\tand TERM must be defined.");
@@ -93,8 +116,12 @@ char	*argv[];
 	while ((*pp++ = *q++)); 
 
 	load_tables();
+	if (argc == 3)
+		set_offset(argv[2]);
 
+	setvbuf(stdin, NULL, _IONBF, 0);	/* So keywait sees every key. */
 	setup_term();
+	need_cleanup = need_restore;
 	signal(SIGTSTP, stop_handler);
 	signal(SIGINT, kill_handler);
 
@@ -147,38 +174,106 @@ void kill_handler(int sig __attribute__((unused)))
 }
 
 
-/* Load stat tables.
+/* Find the stat tables.  They are not loaded here, so the windows
+ * come up at once: load_background reads them while the user has
+ * not typed anything, and any command that needs one before then
+ * loads it itself.  Missing files, including the word list named
+ * by WSVAR if it is set, are still caught before the terminal is
+ * set up.  A table that does not parse is reported on the status
+ * line by load_background, and a command that needs it then puts
+ * the terminal back and exits (see need_exit).
  */
 void load_tables(void)
 {
-	printf("\n\nLoading letter statistics ...");
-	fflush(stdout);
-	if ((letterstats = getenv(LETTERSTATS)) == NULL)  {
-		printf("The shell variable %s is not defined.\n", LETTERSTATS);
+	char	*name;
+
+	letterstats = load_name(LETTERSTATS);
+	bigramstats = load_name(BIGRAMSTATS);
+	trigramstats = load_name(TRIGRAMSTATS);
+	if ((name = getenv(WSVAR)) != NULL  &&  access(name, R_OK) != 0)  {
+		printf("\nCan't open %s to read words.\n", name);
 		exit(0);
 		}
-	load_1stats_from(letterstats);
-	printf(" done.\n");
+	permchgflg = FALSE;
+}
 
-	printf("\n\nLoading bigram statistics ...");
-	fflush(stdout);
-	if ((bigramstats = getenv(BIGRAMSTATS)) == NULL)  {
-		printf("The shell variable %s is not defined.\n", BIGRAMSTATS);
+
+/* Return the file named by the shell variable var, which must
+ * be readable.
+ */
+char *load_name(char *var)
+{
+	char	*name;
+
+	if ((name = getenv(var)) == NULL)  {
+		printf("The shell variable %s is not defined.\n", var);
+		exit(0);
+		}
+	if (access(name, R_OK) != 0)  {
+		printf("\nCan't open %s to read statistics.\n", name);
 		exit(0);
 		}
-	load_2stats_from(bigramstats);
-	printf(" done.\n");
+	return(name);
+}
 
-	printf("\n\nLoading trigram statistics ...");
-	fflush(stdout);
-	if ((trigramstats = getenv(TRIGRAMSTATS)) == NULL)  {
-		printf("The shell variable %s is not defined.\n",TRIGRAMSTATS);
+
+/* Load the tables that have not been loaded yet, stopping as
+ * soon as a key is typed.  The word list of wordscore.c is
+ * loaded last.  A table that does not parse is reported on the
+ * status line and not tried again here.
+ */
+void load_background(void)
+{
+	char	*msg;
+
+	while (!ldfailed  &&  !keywaiting())  {
+		msg = NULL;
+		if (!stats1loaded)
+			msg = load_1stats_from(letterstats);
+		else if (!stats2loaded)
+			msg = load_2stats_from(bigramstats);
+		else if (!trig_loaded)
+			msg = load_tri_from(trigramstats);
+		else if (!wschecked)  {
+			msg = ws_load();
+			wschecked = TRUE;
+			}
+		else
+			break;
+		if (msg != NULL)  {
+			usrstatus(&user, msg);
+			ldfailed = TRUE;
+			}
+		}
+}
+
+
+/* Set the offset of the ciphertext within the cipher file.
+ * The argument is either a byte count or AUTOOFFSET.
+ */
+void set_offset(char *arg)
+{
+	float	conf;
+	char	*p, *q;
+
+	p = AUTOOFFSET;
+	for (q = arg ; *p != 0  &&  *p == *q ; p++, q++);
+	if (*p == 0  &&  *q == 0)  {
+		printf("\n\nDetecting block alignment ...");
+		fflush(stdout);
+		cipheroffset = align_detect(cipherfile, (long) BLOCKSIZE-1, &conf);
+		if (cipheroffset < 0)  {
+			printf("\n%s is shorter than one block.\n", cipherfile);
+			exit(0);
+			}
+		printf(" offset %ld, confidence %5.3f.\n", cipheroffset, conf);
+		return;
+		}
+
+	if (sscanf(arg, "%ld", &cipheroffset) != 1  ||  cipheroffset < 0)  {
+		printf("\nCould not parse the offset from %s.\n", arg);
 		exit(0);
 		}
-	load_tri_from(trigramstats);
-	printf(" done.\n");
-	
-	permchgflg = FALSE;
 }
 
 
@@ -213,6 +308,17 @@ int	status;
 }
 
 
+/* Put the terminal back before need_exit reports a table that a
+ * command needs but that does not parse.
+ */
+void need_restore(void)
+{
+	setcursor(MAXHEIGHT, 1);
+	fflush(stdout);
+	unset_term();
+}
+
+
 /* (re)Draw all the windows.
  */
 void alldraw()
@@ -260,11 +366,23 @@ void initwindows(void)
 
 /* Get keystroke routine.
  * Responsible for clearing the status area before every keystroke.
+ * While waiting, let the background knitter look at any new wires,
+ * load any tables still to be loaded, and autosave the permutations,
+ * again every time no key comes for the autosave interval.
  */
 key	u_getkey()
 {
 	key	k;
-
+	int		secs;
+	char	*msg;
+
+	kntbackground();
+	load_background();
+	secs = permautosecs();
+	do  {
+		if ((msg = permautosave()) != NULL)
+			usrstatus(&user, msg);
+		} while (secs > 0  &&  !keywait(secs));
 	k = getcmd();
 	usrstatus(&user, "");
 
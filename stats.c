@@ -13,10 +13,12 @@
 #include	"specs.h"
 #include	"cipher.h"
 #include	"terminal.h"
+#include	"tparse.h"
 
 
 /* Globals */
 int		stats1loaded = FALSE;	/* True if letter stats loaded. */
+int		stats1gen = 0;			/* Bumped each time they are loaded. */
 char	*letterstats;			/* Filename to find single letter counts. */
 int		stats2loaded = FALSE;	/* True if letter pair stats loaded. */
 char	*bigramstats;			/* Filename to find letter pair counts. */
@@ -100,18 +102,34 @@ float	sllogprob[MXBIINDEX];
 float	score2_mean, score2_var, score2_sd, score2_scale;
 float	score1_mean, score1_var, score1_sd, score1_scale;
 
+/* Parameters for scoring whole blocks, see pbuf_2score. */
+#define	PBRANDOM	2.107		/* -log10 of the chance of a random ascii char. */
+#define	PBBAD		4.0		/* Cost of an impossible char or pair. */
+
 
 /* Forward declarations */
 void stats2(void);
-void load_2stats(FILE *inp);
+char *load_1stats(tpfile *tpf);
+char *load_2stats(tpfile *tpf);
 void print_2stats(FILE *out);
 void print_stat_tab(FILE *out, float table[], int maxindex);
+void need_exit(char *msg);
+
+/* Called before a routine that can't go on without a table exits,
+ * so cbw can put the terminal back.  NULL if there is nothing to do.
+ */
+void	(*need_cleanup)() = NULL;
 
 #ifdef STATS_STANDALONE
 #define	filename		"/usr/baldwin/Ecrypt/mss-bigram.stats"
 int main(void)
 {
-	load_2stats_from(filename);
+	char	*msg;
+
+	if ((msg = load_2stats_from(filename)) != NULL)  {
+		printf("%s\n", msg);
+		exit(0);
+		}
  	print_2stats(stdout);
 
 	return 0;
@@ -157,10 +175,10 @@ float	score(int pblock[])
 float	pvec_1score(int *pvec)
 {
 	int		c;
-	float	tmp, sum, count, score;
+	float	tmp, sum, count;
 
 	if (!stats1loaded)  {
-		load_1stats_from(letterstats);
+		need_1stats();
 		}
 
 	count = 0.0;
@@ -174,6 +192,17 @@ float	pvec_1score(int *pvec)
 		sum += tmp;
 		}
 
+	return(sum_1score(sum, count));
+}
+
+
+/* Return the score pvec_1score gives count characters whose
+ * logprob values add up to sum.
+ */
+float	sum_1score(float sum, float count)
+{
+	float	tmp, score;
+
 	if (count == 0.0)  return(-1.0);
 	tmp = (sum / count) - logmean;
 	tmp = tmp > 0 ? tmp : 0.0 - tmp;
@@ -200,7 +229,7 @@ float	var_1score(int *pvec)
 	float	tmp, sum, count, score;
 
 	if (!stats1loaded)  {
-		load_1stats_from(letterstats);
+		need_1stats();
 		}
 
 	count = 0.0;
@@ -234,7 +263,7 @@ float	prob_1score(int *pvec)
 	float	product, count, score;
 
 	if (!stats1loaded)  {
-		load_1stats_from(letterstats);
+		need_1stats();
 		}
 
 	count = 0.0;
@@ -273,7 +302,7 @@ reg	int		center_letter;
 	float	pair_score;
 
 	if (!stats2loaded)  {
-		load_2stats_from(bigramstats);
+		need_2stats();
 		}
 
 	nchars = 0;
@@ -352,7 +381,7 @@ reg	int		pos;
 reg	float	tmp;
 
 	if (!stats1loaded)  {
-		load_1stats_from(letterstats);
+		need_1stats();
 		}
 
 	nchars = 0;
@@ -376,6 +405,54 @@ reg	float	tmp;
 }
 
 
+/* Score a whole block of plaintext (a pbuf), so that different
+ * guesses for the same block can be compared.  The score is the log
+ * (base 10) of how much more likely the known characters are to be
+ * english than random ascii: each character adds its single letter
+ * log probability ratio, and each pair of adjacent known characters
+ * adds the log ratio of the pair probability to the product of the
+ * single letter probabilities.  Impossible characters and pairs cost
+ * PBBAD.  Bigger is better; correct characters add to the score and
+ * wrong ones usually subtract from it.
+ */
+float	pbuf_2score(int *pbuf)
+{
+	int		pos, c, left, center;
+	float	total, tmp;
+
+	if (!stats1loaded)  {
+		need_1stats();
+		}
+	if (!stats2loaded)  {
+		need_2stats();
+		}
+
+	total = 0.0;
+	left = NONE;
+	for (pos = 0 ; pos < BLOCKSIZE ; pos++)  {
+		if ((c = pbuf[pos]) == NONE)  {
+			left = NONE;
+			continue;
+			}
+		c = c & CHARMASK;
+		tmp = logprob[c];
+		total += (tmp == 0.0) ? (0.0 - PBBAD) : tmp + PBRANDOM;
+
+		center = char_bimap[c];
+		if (left != NONE)  {
+			tmp = bilogprob[left][center];
+			if (tmp == 0.0  ||  sllogprob[left] == 0.0
+			 || sllogprob[center] == 0.0)
+				total -= PBBAD;
+			else
+				total += tmp - sllogprob[left] - sllogprob[center];
+			}
+		left = center;
+		}
+	return(total);
+}
+
+
 /* Compute expected value of a scoring function given
  * a vector of probabilities for values and a vector of
  * scores for each value.
@@ -413,8 +490,8 @@ float	vec_variance(float *probvec, float *scorevec, int maxindex)
 }
 
 
-/* Read from given stream to set up logprob table and constants
- * logmean and logvar.
+/* Parse tpf to set up logprob table and constants
+ * logmean and logvar.  Returns NULL or an error message.
  *
  * The table format is:
  * <Total count>
@@ -425,56 +502,49 @@ float	vec_variance(float *probvec, float *scorevec, int maxindex)
  * <Blankline>
  * <EOF>
  */
-void load_1stats(FILE *inp)
+char *load_1stats(tpfile *tpf)
 {
-	int		i,n;
+	int		i;
 	int		tmp;
 	int		c;
 	float	v, lv, fv;
 	float	etotal, ctotal;
 
-	stats1loaded = TRUE;
-
-	for (i = 0 ; i <= MAXCHAR ; i++)  logprob[i] = 0.0;
+	stats1loaded = FALSE;
+	for (i = 0 ; i <= MAXCHAR ; i++)  prob[i] = logprob[i] = 0.0;
 
-	if (fscanf(inp, "%d", &tmp) != 1)  {
-		printf("Error while getting total");
-		return;
-		}
+	if (!tp_int(tpf, &tmp))
+		return(tp_error(tpf, "expected the total count"));
 	etotal = tmp;
 	ctotal = 0.0;
 
-	if (fscanf(inp, "\n") != 0)  {
-		printf("Error while skipping blank line");
-		return;
-		}
-
-	while (TRUE) {
-		if ((n = fscanf(inp, "%d", &tmp)) != 1)  {
-			if (n == 0) break;
-			if (n == EOF) break;
-			printf("Error while getting character count");
-			return;
-			}
+	while (tp_int(tpf, &tmp))  {
 		v = tmp;
 		ctotal += v;
 		fv = v/etotal;
 		if (fv != 0.0)  {lv = log10(fv);}
 		else {lv = 0.0;}
 
-		c = read_char(inp);		/* Skip the space. */
-		while (TRUE) {
-			c = read_char(inp);
-			if (c == EOL)  break;
+		if (!tp_sep(tpf))
+			return(tp_error(tpf, "expected a space after the count"));
+		while ((c = tp_char(tpf)) != TPEOL  &&  c != TPEOF)  {
+			if (c == TPBAD)  return(tperrmsg);
 			prob[c&CHARMASK] = fv;
 			logprob[c&CHARMASK] = lv;
 			}
 		}
+	if (!tp_eof(tpf))
+		return(tp_error(tpf, "expected a count"));
 
 	if (etotal != ctotal) {
-		printf("Expected total is %f.  Actual total is %f.\n",etotal,ctotal);
+		sprintf(tperrmsg,
+		        "%.100s: expected total is %.0f, actual total is %.0f.",
+		        tpf->name, etotal, ctotal);
+		return(tperrmsg);
 		}
 
+	stats1loaded = TRUE;
+	stats1gen++;
 	logmean = vec_mean(prob, logprob, MAXCHAR);
 	logvar  = vec_variance(prob, logprob, MAXCHAR);
 	logsd = sqrt(logvar);
@@ -484,25 +554,38 @@ void load_1stats(FILE *inp)
 	score1_scale = sqrt(2 * PI * score1_var);
 	pmean = vec_mean(prob, prob, MAXCHAR);
 	pvar = vec_variance(prob, prob, MAXCHAR);
+	return(NULL);
 }
 
 
 /* Load the letter pair statistics from the given file name.
+ * Returns NULL or an error message.
  */
-void load_2stats_from(char *statfname)
+char *load_2stats_from(char *statfname)
 {
-	FILE	*inp;
+	tpfile	tpf;
+	char	*msg;
 
-	if ((inp = fopen(statfname, "r")) == NULL) {
-		printf("\nCan't open %s to read letter statistics\n", statfname);
-		exit(0);
-		}
-	load_2stats(inp);
-	fclose(inp);
+	if ((msg = tp_open(&tpf, statfname)) != NULL)  return(msg);
+	msg = load_2stats(&tpf);
+	tp_close(&tpf);
+	return(msg);
 }
 
 
-/* Read from given stream to set up bilogprob table and constants
+/* Load the letter pair statistics for a routine that can't go on
+ * without them.
+ */
+void need_2stats(void)
+{
+	char	*msg;
+
+	if ((msg = load_2stats_from(bigramstats)) != NULL)
+		need_exit(msg);
+}
+
+
+/* Parse tpf to set up bilogprob table and constants
  * bilogmean, bilogsd, and bilogvar.
  *
  * The format of the statistics file is: [This should be more general.]
@@ -535,17 +618,16 @@ void load_2stats_from(char *statfname)
  * For example if 'T' and 't' are treated the same, a double letter entry
  * might look like: "1247 TT" and count for Tt, tT, tt, and TT.
  */
-void load_2stats(FILE *inp)
+char *load_2stats(tpfile *tpf)
 {
 register	int		i,j;
-    int		n;
 	int		tmp;
 	int		c;
 	int		left_index, right_index;
 	float	v, lv, fv;
 	float	etotal, ctotal;
 
-	stats2loaded = TRUE;
+	stats2loaded = FALSE;
 	nbichars = 0;
 
 	for (i = 0 ; i < MXBIINDEX ; i++)  {
@@ -560,25 +642,14 @@ register	int		i,j;
 	for (i = 0 ; i < MAXCHAR+1 ; i++)
 		char_bimap[i] = 0;		/* Default index if char unknown. */
 
-	if (fscanf(inp, "%d", &tmp) != 1)  {
-		printf("Error while getting total");
-		exit(0);
-		}
+	if (!tp_int(tpf, &tmp))
+		return(tp_error(tpf, "expected the total count"));
 	etotal = tmp;
 
-	if (fscanf(inp, "\n") != 0)  {
-		printf("Error while skipping blank line before single letters");
-		exit(0);
-		}
-
 	ctotal = 0.0;
-	while (TRUE) {
-		if ((n = fscanf(inp, "%d", &tmp)) != 1)  {
-			if (n == 0) break;
-			if (n == EOF) break;
-			printf("Error while getting character count (singles)");
-			exit(0);
-			}
+	while (tp_int(tpf, &tmp))  {
+		if (nbichars >= MXBIINDEX)
+			return(tp_error(tpf, "too many letter groups"));
 		v = tmp;
 		ctotal += v;
 		fv = v/etotal;
@@ -587,10 +658,10 @@ register	int		i,j;
 		else
 			lv = log10(fv);
 
-		c = read_char(inp);		/* Skip the space. */
-		while (TRUE) {
-			c = read_char(inp);
-			if (c == EOL)  break;
+		if (!tp_sep(tpf))
+			return(tp_error(tpf, "expected a space after the count"));
+		while ((c = tp_char(tpf)) != TPEOL  &&  c != TPEOF)  {
+			if (c == TPBAD)  return(tperrmsg);
 			char_bimap[c & CHARMASK] = nbichars;
 			slbiprob[nbichars] = fv;
 			sllogprob[nbichars] = lv;
@@ -599,25 +670,16 @@ register	int		i,j;
 		}
 
 	if (etotal != ctotal) {
-		printf("Expected total is %f.  Actual total is %f for singles.\n",
-				etotal, ctotal);
-		exit(0);
+		sprintf(tperrmsg, "%.100s: expected total is %.0f, actual total is %.0f for singles.",
+		        tpf->name, etotal, ctotal);
+		return(tperrmsg);
 		}
 
-
-	if (fscanf(inp, "***\n") != 0)  {
-		printf("Error on delimiter before letter pairs");
-		exit(0);
-		}
+	if (!tp_literal(tpf, "***"))
+		return(tp_error(tpf, "expected *** before the letter pairs"));
 
 	ctotal = 0.0;
-	while (TRUE) {
-		if ((n = fscanf(inp, "%d", &tmp)) != 1)  {
-			if (n == 0) break;
-			if (n == EOF) break;
-			printf("Error while getting character count (pairs)");
-			exit(0);
-			}
+	while (tp_int(tpf, &tmp))  {
 		v = tmp;
 		ctotal += v;
 		fv = v/etotal;
@@ -626,18 +688,17 @@ register	int		i,j;
 		else
 			lv = log10(fv);
 
-		c = read_char(inp);		/* Skip the space. */
-		c = read_char(inp);		/* First letter. */
-		if (c == EOL)  {
-			printf("Line ends before letter pair");
-			exit(0);
-			}
+		if (!tp_sep(tpf))
+			return(tp_error(tpf, "expected a space after the count"));
+		c = tp_char(tpf);		/* First letter. */
+		if (c == TPBAD)  return(tperrmsg);
+		if (c == TPEOL  ||  c == TPEOF)
+			return(tp_error(tpf, "line ends before letter pair"));
 		left_index = char_bimap[c & CHARMASK];
-		c = read_char(inp);		/* Second letter. */
-		if (c == EOL)  {
-			printf("Line ends in middle of letter pair");
-			exit(0);
-			}
+		c = tp_char(tpf);		/* Second letter. */
+		if (c == TPBAD)  return(tperrmsg);
+		if (c == TPEOL  ||  c == TPEOF)
+			return(tp_error(tpf, "line ends in middle of letter pair"));
 		right_index = char_bimap[c & CHARMASK];
 
 		biprob[left_index][right_index] = fv;
@@ -645,31 +706,26 @@ register	int		i,j;
 		}
 
 	if (etotal != ctotal) {
-		printf("Expected total is %f.  Actual total is %f for pairs.\n",
-				etotal, ctotal);
-		exit(0);
+		sprintf(tperrmsg, "%.100s: expected total is %.0f, actual total is %.0f for pairs.",
+		        tpf->name, etotal, ctotal);
+		return(tperrmsg);
 		}
 
-	if (fscanf(inp, "***\n") == 0)  {
-		if (fscanf(inp, "%f", &score2_mean) != 1)  {
-			printf("Error reading mean.");
-			exit(0);
-			}
-		if (fscanf(inp, "%f", &score2_var) != 1)  {
-			printf("Error reading variance.");
-			exit(0);
-			}
-		if (fscanf(inp, "%f", &score2_sd) != 1)  {
-			printf("Error reading standard deviations.");
-			exit(0);
-			}
+	stats2loaded = TRUE;
+	if (tp_literal(tpf, "***"))  {
+		if (!tp_float(tpf, &score2_mean))
+			return(tp_error(tpf, "expected the mean"));
+		if (!tp_float(tpf, &score2_var))
+			return(tp_error(tpf, "expected the variance"));
+		if (!tp_float(tpf, &score2_sd))
+			return(tp_error(tpf, "expected the standard deviation"));
 		score2_scale = sqrt(2 * PI * score2_var);
 		approx_init();
-		return;
+		return(NULL);
 		}
 
 	stats2();
-	printf("Mean: %f, Var: %f, SD: %f\n", score2_mean, score2_var, score2_sd);
+	return(NULL);
 }
 
 
@@ -762,16 +818,38 @@ void print_stat_tab(FILE *out, float table[], int maxindex)
 
 
 /* Load the first order statistics from the given file name.
+ * Returns NULL or an error message.
  */
-void load_1stats_from(char *statfname)
+char *load_1stats_from(char *statfname)
 {
-	FILE	*inp;
+	tpfile	tpf;
+	char	*msg;
 
-	if ((inp = fopen(statfname, "r")) == NULL) {
-		printf("\nCan't open %s to read letter statistics\n", statfname);
-		exit(0);
-		}
-	load_1stats(inp);
-	fclose(inp);
+	if ((msg = tp_open(&tpf, statfname)) != NULL)  return(msg);
+	msg = load_1stats(&tpf);
+	tp_close(&tpf);
+	return(msg);
+}
+
+
+/* Load the first order statistics for a routine that can't go on
+ * without them.
+ */
+void need_1stats(void)
+{
+	char	*msg;
+
+	if ((msg = load_1stats_from(letterstats)) != NULL)
+		need_exit(msg);
 }
 
+
+/* Report that a table could not be loaded and exit, after putting
+ * the terminal back if need_cleanup says how.
+ */
+void need_exit(char *msg)
+{
+	if (need_cleanup != NULL)  (*need_cleanup)();
+	printf("\n%s\n", msg);
+	exit(0);
+}
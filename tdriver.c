@@ -1,5 +1,7 @@
 /*
  * Test driver for automated trigram guessing.
+ * The blocks go through a pipeline, so that reading the next
+ * blocks and printing the last ones overlap with the guessing.
  */
 
 #include	<stdio.h>
@@ -9,6 +11,7 @@
 #include	"specs.h"
 #include	"cipher.h"
 #include	"autotri.h"
+#include	"fanout.h"
 
 
 extern	char	*atr_best();
@@ -17,13 +20,31 @@ extern	float	atr_score();
 extern void ec_autoguess(ecinfo *ecbi, float alevel);
 extern void ec_dplain(FILE *out, ecinfo *eci);
 
+/* One block on its way through the pipeline. */
+#define	tdblock	struct xtdblock
+tdblock	{
+		char	plain[BLOCKSIZE+1];
+		char	cipher[BLOCKSIZE+1];
+		};
+
+/* What guessing found in a block. */
+#define	tdresult	struct xtdresult
+tdresult	{
+		char	cipher[BLOCKSIZE+1];
+		int		perm[BLOCKSIZE+1];
+		int		nright, nwrong;		/* Trigram guesses right / wrong. */
+		};
+
 /* Forward declarations */
-void do_block(int blknum, char *cfile, char *pfile, atrinfo *atri);
+int td_read(int blknum, char *arg, char *in, int insize);
+void td_work(int blknum, char *arg, char *in, int insize, char *out, int outsize);
+void td_write(int blknum, char *arg, char *out, int outsize);
 int wrong_guess(char *plaintext, int position, char *trigram);
 
 atrinfo	myatrinfo;
-char	plainbuf[BLOCKSIZE+1];
-int		naccepted, nwrong, nright;		/* Number of wires accepted / wrong. */
+ecinfo	tdecinfo;
+char	*plainfile;
+int		nblocks;
 
 extern	char	mcbuf[];
 
@@ -33,9 +54,6 @@ int		argc;
 char	*argv[];
 {
 	FILE	*inp;
-	int		i, blknum;
-	int		nblocks;
-	int		*saveperm;
 	long	filelength;
 	atrinfo	*atri;
 	char	permfbuf[100];
@@ -59,7 +77,7 @@ char	*argv[];
 	q = code;
 	while ((*p++ = *q++));
 
-	p = plainfbuf;
+	p = plainfile = plainfbuf;
 	q = argv[1];
 	while ((*p++ = *q++));
 	--p;
@@ -94,8 +112,8 @@ char	*argv[];
 
 	letterstats = "mss.stats";
 	trigramstats = "trigrams.stats";
-	load_1stats_from(letterstats);
-	load_tri_from(trigramstats);
+	need_1stats();
+	need_tri();
 
 	if ((inp = fopen(cipherfile, "r")) == NULL) {
 		printf("\nCannot open %s for reading.\n", cipherfile);
@@ -114,12 +132,8 @@ char	*argv[];
 	printf(".  Min total chars = %d", atri->min_total_chars);
 	printf(".  Min per wire chars = %d", atri->min_wire_chars);
 	printf("\n\n");
-	for (blknum = 0 ; blknum < nblocks ; blknum++) {
-		do_block(blknum, cipherfile, plainfbuf, atri);
-		saveperm = refperm(blknum);
-		for (i = 0 ; i < BLOCKSIZE ; i++)
-			saveperm[i] = atri->eci->perm[i];
-		}
+	fan_pipeline(td_read, td_work, td_write, (char *) atri,
+	             sizeof(tdblock), sizeof(tdresult));
 
 	permsave();
 
@@ -127,70 +141,58 @@ char	*argv[];
 }
 
 
-void do_block(int blknum, char *cfile, char *pfile, atrinfo *atri)
+/* Read the plaintext and ciphertext of block blknum.
+ * Returns FALSE if there is no such block.
+ */
+int td_read(int blknum, char *arg __attribute__((unused)), char *in,
+            int insize __attribute__((unused)))
 {
-	int		i,y;
-	int		pos;
-	char	*trigram;
-	int		charcount;				/* Number of characters deduced. */
-	int		*dbsperm;
-/*
-	perment	permvector[PERMSZ];
-	int		pvec[BLOCKSIZE+1];
-	char	str[BLOCKSIZE+1];
-*/
-	cipherfile = pfile;
-	fillcbuf(blknum, plainbuf);
+	tdblock	*tdb;
+	char	*cfile;
+
+	tdb = (tdblock *) in;
+	if (blknum >= nblocks)  return(FALSE);
+	cfile = cipherfile;
+	cipherfile = plainfile;
+	fillcbuf(blknum, tdb->plain);
 	cipherfile = cfile;
-	fillcbuf(blknum, mcbuf);
+	fillcbuf(blknum, tdb->cipher);
+	return(TRUE);
+}
 
-	dbsperm = refperm(blknum);
-	atr_init(mcbuf, dbsperm, atri);
 
-	ec_autoguess(atri->eci, 1.7);
-/*	decode(atri->eci->ciphertext, atri->eci->plaintext, atri->eci->perm);
+/* Guess the trigrams of one block and count the right guesses.
+ */
+void td_work(int blknum, char *arg, char *in, int insize __attribute__((unused)),
+             char *out, int outsize __attribute__((unused)))
+{
+	int		i, pos;
+	char	*trigram;
+	atrinfo	*atri;
+	tdblock	*tdb;
+	tdresult	*tdr;
 
-	naccepted = 0;
-	nwrong = 0;
-	nright = 0;
-	charcount = 0;
-	for (i = 0 ; i < BLOCKSIZE ; i++)  {
-		if (atri->eci->plaintext[i] != NONE)  charcount++;
-		if (((y=atri->eci->perm[i]) != NONE) && (i < y))  naccepted++;
-		}
+	atri = (atrinfo *) arg;
+	tdb = (tdblock *) in;
+	tdr = (tdresult *) out;
 
-	printf("\n\nEquiv Guessing for block %d yields %d wires",blknum,naccepted);
-	printf(" and %d characters.\n\n", charcount);
-	ec_dplain(stdout, atri->eci);
-*/
+	atr_init(tdb->cipher, refperm(blknum), atri);
 
-	naccepted = 0;
-	nwrong = 0;
-	nright = 0;
+	ec_autoguess(atri->eci, 1.7);
+
+	tdr->nwrong = 0;
+	tdr->nright = 0;
 
-	printf("\n\nStarting block %d.\n", blknum);
 #if TRUE
 	for (pos = 0 ; pos < BLOCKSIZE ; pos++) {
 		trigram = atr_best(atri, pos);
 		if (trigram != NULL) {
 			accept_permvec(atri, atri->best_permvec);
-/*			printf("\n");
-			printf("Best trigram at %d is '%s'", pos, atri->best_trigram);
-			pvec2str(str, atri->best_pvec);
-			printf(" which deduced '%s'", str);
-			printf(" with a score of %f", atri->best_score);
-			printf(".\n");
-			printf("There were %d guesses", atri->gcount);
-			printf(" yeilding a total score of %f", atri->total_score);
-			printf(".\n");
-*/
-			if (wrong_guess(plainbuf, pos, atri->best_trigram))  {
-				nwrong++;
-/*				printf("WRONG\n");*/
+			if (wrong_guess(tdb->plain, pos, atri->best_trigram))  {
+				tdr->nwrong++;
 				}
 			else {
-				nright++;
-/*				printf("CORRECT\n");*/
+				tdr->nright++;
 				}
 			}
 		}
@@ -198,21 +200,52 @@ void do_block(int blknum, char *cfile, char *pfile, atrinfo *atri)
 	atr_autoguess(atri);
 #endif
 
-	decode(atri->eci->ciphertext, atri->eci->plaintext, atri->eci->perm);
+	for (i = 0 ; i < BLOCKSIZE ; i++)  {
+		tdr->cipher[i] = tdb->cipher[i];
+		tdr->perm[i] = atri->eci->perm[i];
+		}
+}
+
+
+/* Print the plaintext a block decodes to and save its permutation.
+ */
+void td_write(int blknum, char *arg __attribute__((unused)), char *out,
+              int outsize __attribute__((unused)))
+{
+	int		i, y;
+	int		naccepted;				/* Number of wires accepted. */
+	int		charcount;				/* Number of characters deduced. */
+	int		*saveperm;
+	ecinfo	*eci;
+	tdresult	*tdr;
+
+	tdr = (tdresult *) out;
+	eci = &tdecinfo;
 
+	printf("\n\nStarting block %d.\n", blknum);
+
+	ec_init(tdr->cipher, tdr->perm, eci);
+	decode(eci->ciphertext, eci->plaintext, eci->perm);
+
+	naccepted = 0;
 	charcount = 0;
 	for (i = 0 ; i < BLOCKSIZE ; i++)  {
-		if (atri->eci->plaintext[i] != NONE)  charcount++;
-		if (((y=atri->eci->perm[i]) != NONE) && (i < y))  naccepted++;
+		if (eci->plaintext[i] != NONE)  charcount++;
+		if (((y=eci->perm[i]) != NONE) && (i < y))  naccepted++;
 		}
 
 	printf("\n\nPlaintext for block %d using %d wires", blknum, naccepted);
 	printf(" yields %d characters.", charcount);
 #if TRUE
-	printf("\nThere were %d right guesses and %d wrong ones.",nright, nwrong);
+	printf("\nThere were %d right guesses and %d wrong ones.",
+	       tdr->nright, tdr->nwrong);
 #endif
 	printf("\n\n");
-	ec_dplain(stdout, atri->eci);
+	ec_dplain(stdout, eci);
+
+	saveperm = refperm(blknum);
+	for (i = 0 ; i < BLOCKSIZE ; i++)
+		saveperm[i] = tdr->perm[i];
 }
 
 
@@ -24,6 +24,12 @@
  *		Reads stdin for a keystroke and returns
  *		a command integer.
  *
+ *	keywaiting()
+ *		Return TRUE if a keystroke has been typed but not read.
+ *
+ *	keywait(secs)
+ *		Same, waiting up to secs seconds for one.
+ *
  *	beep()
  *		Cause the terminal to beep or flash.
  */
@@ -103,6 +109,8 @@
 #include	<stdlib.h>
 #include	<string.h>
 #include	<strings.h>
+#include	<unistd.h>
+#include	<sys/select.h>
 #include	"window.h"
 #include	"terminal.h"
 #include	"specs.h"
@@ -223,6 +231,7 @@ int read_varlabel(char **strp, labelv *labeltab, int *valp);
 int read_varval(char **strp, char **valp);
 void read_graphics(char *var);
 void term_beep(void);
+int keywait(int secs);
 
 
 /* Set up the terminal. This package now makes calls to both curses
@@ -827,6 +836,34 @@ int getcmd(void)
 }
 
 
+/* Return TRUE if a keystroke is waiting to be read, without
+ * waiting for one.
+ */
+int keywaiting(void)
+{
+	return(keywait(0));
+}
+
+
+/* Return TRUE if a keystroke is waiting to be read, waiting up to
+ * secs seconds for one.  The screen is brought up to date first if
+ * there is any wait.  Stdin is unbuffered, so there are never
+ * characters in the stdio buffer that select does not see.
+ */
+int keywait(int secs)
+{
+	fd_set	fds;
+	struct	timeval	tv;
+
+	if (secs > 0)  fflush(stdout);
+	FD_ZERO(&fds);
+	FD_SET(0, &fds);
+	tv.tv_sec = secs;
+	tv.tv_usec = 0;
+	return(select(1, &fds, NULL, NULL, &tv) > 0);
+}
+
+
 /* Cause the terminal to beep.
  */
 void term_beep(void)
@@ -0,0 +1,321 @@
+/*
+ * Parse the text formats of the statistics, trigram, word and
+ * permutation files.
+ *
+ * The file is mapped and scanned in place.  Slashified characters
+ * (see char-io.c) are decoded through a table of what each char after
+ * a backslash stands for, so read_char's chain of tests is one lookup.
+ * Numbers are read as fscanf reads them, so files that loaded before
+ * load the same way, but anything that does not parse is reported
+ * with its line and column rather than skipped or fatal.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<limits.h>
+#include	<unistd.h>
+#include	<fcntl.h>
+#include	<sys/types.h>
+#include	<sys/stat.h>
+#include	<sys/mman.h>
+#include	"window.h"
+#include	"specs.h"
+#include	"tparse.h"
+
+
+#define	TPREADSZ	(64*1024)	/* First buffer for files that can't be mapped. */
+#define	TPNUMLEN	60			/* Longest floating point number. */
+#define	TPOCTAL		(-2)		/* Escape starts three octal digits. */
+
+
+/* Forward declarations */
+void tp_tables(void);
+char *tp_open(tpfile *tpf, char *filename);
+void tp_close(tpfile *tpf);
+char *tp_error(tpfile *tpf, char *msg);
+int tp_eof(tpfile *tpf);
+void tp_space(tpfile *tpf);
+int tp_sep(tpfile *tpf);
+int tp_literal(tpfile *tpf, char *str);
+int tp_int(tpfile *tpf, int *valp);
+int tp_float(tpfile *tpf, float *valp);
+int tp_char(tpfile *tpf);
+char *tp_perm(tpfile *tpf, int perm[]);
+
+
+/* Global state. */
+char	tperrmsg[TPMSGLEN+1];
+int		tpready = FALSE;		/* TRUE once the tables are filled in. */
+int		tpescape[256];			/* What a char after a backslash stands for. */
+char	tpwhite[256];			/* TRUE for the chars fscanf skips. */
+
+
+/* Fill in the tables.  As in read_char, an escape that is not
+ * known stands for the char itself, so \\ is a backslash.
+ */
+void tp_tables(void)
+{
+	int		c;
+
+	for (c = 0 ; c < 256 ; c++)  {
+		tpescape[c] = c;
+		tpwhite[c] = FALSE;
+		}
+	tpescape['n'] = '\n';
+	tpescape['t'] = '\t';
+	tpescape['p'] = '\f';
+	tpescape['b'] = '\b';
+	tpescape['r'] = '\r';
+	for (c = '0' ; c <= '7' ; c++)  tpescape[c] = TPOCTAL;
+
+	tpwhite[' '] = tpwhite['\t'] = tpwhite['\n'] = TRUE;
+	tpwhite['\r'] = tpwhite['\f'] = tpwhite['\v'] = TRUE;
+	tpready = TRUE;
+}
+
+
+/* Get ready to parse filename.
+ * Returns NULL or an error message.
+ */
+char *tp_open(tpfile *tpf, char *filename)
+{
+	struct	stat	st;
+	int		fd;
+	long	n, size;
+	char	*p;
+
+	if (!tpready)  tp_tables();
+	tpf->name = filename;
+	tpf->buf = NULL;
+	tpf->len = tpf->pos = 0;
+	tpf->mapped = FALSE;
+
+	if ((fd = open(filename, O_RDONLY)) < 0)  {
+		sprintf(tperrmsg, "Cannot open %.*s to read.", TPMSGLEN-40, filename);
+		return(tperrmsg);
+		}
+	if (fstat(fd, &st) == 0  &&  S_ISREG(st.st_mode)  &&  st.st_size > 0)  {
+		p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p != MAP_FAILED)  {
+			tpf->buf = p;
+			tpf->len = st.st_size;
+			tpf->mapped = TRUE;
+			close(fd);
+			return(NULL);
+			}
+		}
+
+	/* Pipes and the like are read to the end. */
+	size = 0;
+	while (TRUE)  {
+		if (tpf->len == size)  {
+			size = (size == 0) ? TPREADSZ : 2*size;
+			if ((p = realloc(tpf->buf, size)) == NULL)  {
+				close(fd);
+				tp_close(tpf);
+				sprintf(tperrmsg, "No room to read %.*s.", TPMSGLEN-40, filename);
+				return(tperrmsg);
+				}
+			tpf->buf = p;
+			}
+		if ((n = read(fd, tpf->buf + tpf->len, size - tpf->len)) <= 0)  break;
+		tpf->len += n;
+		}
+	close(fd);
+	if (n < 0)  {
+		tp_close(tpf);
+		sprintf(tperrmsg, "Error reading %.*s.", TPMSGLEN-40, filename);
+		return(tperrmsg);
+		}
+	return(NULL);
+}
+
+
+/* Give back the contents of the file.
+ */
+void tp_close(tpfile *tpf)
+{
+	if (tpf->mapped)
+		munmap(tpf->buf, tpf->len);
+	else
+		free(tpf->buf);
+	tpf->buf = NULL;
+	tpf->len = tpf->pos = 0;
+	tpf->mapped = FALSE;
+}
+
+
+/* Put msg in tperrmsg with the file name, line and column of the
+ * next char, and return tperrmsg.  The place is only worked out
+ * here, so parsing does not count lines.
+ */
+char *tp_error(tpfile *tpf, char *msg)
+{
+	long	i, line, col;
+
+	line = col = 1;
+	for (i = 0 ; i < tpf->pos  &&  i < tpf->len ; i++)  {
+		if (tpf->buf[i] == '\n')  {
+			line++;
+			col = 1;
+			}
+		else  {
+			col++;
+			}
+		}
+	sprintf(tperrmsg, "%.*s:%ld:%ld: %.*s", TPMSGLEN/2, tpf->name,
+	        line, col, TPMSGLEN/2 - 30, msg);
+	return(tperrmsg);
+}
+
+
+/* Return TRUE if there is nothing left to parse.
+ */
+int tp_eof(tpfile *tpf)
+{
+	return(tpf->pos >= tpf->len);
+}
+
+
+/* Skip white space, including newlines.
+ */
+void tp_space(tpfile *tpf)
+{
+	while (tpf->pos < tpf->len  &&  tpwhite[(unsigned char) tpf->buf[tpf->pos]])
+		tpf->pos++;
+}
+
+
+/* Skip the one space or tab between a count and what it counts.
+ * Returns FALSE if it is not there.
+ */
+int tp_sep(tpfile *tpf)
+{
+	if (tpf->pos >= tpf->len)  return(FALSE);
+	if (tpf->buf[tpf->pos] != ' '  &&  tpf->buf[tpf->pos] != '\t')  return(FALSE);
+	tpf->pos++;
+	return(TRUE);
+}
+
+
+/* Skip white space and then str, if str is next.
+ * Returns FALSE, having only skipped the white space, if it is not.
+ */
+int tp_literal(tpfile *tpf, char *str)
+{
+	long	n;
+
+	tp_space(tpf);
+	n = strlen(str);
+	if (tpf->len - tpf->pos < n  ||  strncmp(tpf->buf + tpf->pos, str, n) != 0)
+		return(FALSE);
+	tpf->pos += n;
+	return(TRUE);
+}
+
+
+/* Skip white space and read a decimal integer into *valp.
+ * Returns FALSE, having only skipped the white space, if there is
+ * no number.  Numbers too big for an int are cut to fit.
+ */
+int tp_int(tpfile *tpf, int *valp)
+{
+	char	*p, *end;
+	long	v;
+	int		neg;
+
+	tp_space(tpf);
+	p = tpf->buf + tpf->pos;
+	end = tpf->buf + tpf->len;
+	neg = FALSE;
+	if (p < end  &&  (*p == '-'  ||  *p == '+'))  {
+		neg = (*p == '-');
+		p++;
+		}
+	if (p >= end  ||  *p < '0'  ||  *p > '9')  return(FALSE);
+	for (v = 0 ; p < end  &&  *p >= '0'  &&  *p <= '9' ; p++)  {
+		v = 10*v + (*p - '0');
+		if (v > INT_MAX)  v = INT_MAX;
+		}
+	tpf->pos = p - tpf->buf;
+	*valp = neg ? -v : v;
+	return(TRUE);
+}
+
+
+/* Skip white space and read a floating point number into *valp.
+ * Returns FALSE, having only skipped the white space, if there is
+ * no number.
+ */
+int tp_float(tpfile *tpf, float *valp)
+{
+	char	num[TPNUMLEN+1];
+	char	*p, *end;
+	int		n;
+	double	v;
+
+	tp_space(tpf);
+	p = tpf->buf + tpf->pos;
+	for (n = 0 ; n < TPNUMLEN  &&  tpf->pos + n < tpf->len ; n++)  {
+		if (tpwhite[(unsigned char) p[n]])  break;
+		num[n] = p[n];
+		}
+	num[n] = 0;
+	v = strtod(num, &end);
+	if (end == num)  return(FALSE);
+	tpf->pos += end - num;
+	*valp = v;
+	return(TRUE);
+}
+
+
+/* Read a slashified char.  Returns it, or TPEOL at the end of a
+ * line, TPEOF at the end of the file, or TPBAD with tperrmsg set if
+ * an octal escape does not have three digits.
+ */
+int tp_char(tpfile *tpf)
+{
+	unsigned char	*p;
+	int		c;
+
+	if (tpf->pos >= tpf->len)  return(TPEOF);
+	p = (unsigned char *) tpf->buf + tpf->pos++;
+	if (*p == '\n')  return(TPEOL);
+	if (*p != '\\')  return(*p);
+
+	if (tpf->pos >= tpf->len)  return(TPEOF);
+	tpf->pos++;
+	if ((c = tpescape[p[1]]) != TPOCTAL)  return(c);
+	if (tpf->pos + 2 > tpf->len
+	 || tpescape[p[2]] != TPOCTAL  ||  tpescape[p[3]] != TPOCTAL)  {
+		tpf->pos -= 2;
+		tp_error(tpf, "octal escape needs three digits");
+		return(TPBAD);
+		}
+	tpf->pos += 2;
+	return(64*(p[1] - '0') + 8*(p[2] - '0') + (p[3] - '0'));
+}
+
+
+/* Read a permutation in the format of writeperm.
+ * Returns NULL or an error message.
+ */
+char *tp_perm(tpfile *tpf, int perm[])
+{
+	int		j, v;
+	long	start;
+
+	for (j = 0 ; j < BLOCKSIZE ; j++)  {
+		tp_space(tpf);
+		start = tpf->pos;
+		if (!tp_int(tpf, &v))
+			return(tp_error(tpf, "expected a permutation entry"));
+		if (v < NONE  ||  v >= BLOCKSIZE)  {
+			tpf->pos = start;
+			return(tp_error(tpf, "permutation entry out of range"));
+			}
+		perm[j] = v;
+		}
+	return(NULL);
+}
@@ -0,0 +1,45 @@
+#ifndef __TPARSE_H
+#define __TPARSE_H
+
+/*
+ * Declarations for parsing the text formats of the statistics,
+ * trigram, word and permutation files.
+ *
+ * A file is mapped into memory, or read whole if it can't be mapped,
+ * and scanned with a pointer instead of through stdio.  Errors do
+ * not exit: the routine that finds one returns a message that gives
+ * the file, line and column, which is kept in tperrmsg.
+ */
+
+
+#define	TPEOL		(-37)		/* End of line, as read_char gives it. */
+#define	TPEOF		(-1)		/* End of file. */
+#define	TPBAD		(-38)		/* Malformed slashified character. */
+#define	TPMSGLEN	200
+
+
+#define	tpfile	struct xtpfile
+tpfile	{
+		char	*name;
+		char	*buf;			/* Contents of the file. */
+		long	len;
+		long	pos;			/* Next char to look at. */
+		int		mapped;			/* TRUE if buf is mapped. */
+		};
+
+
+extern	char	tperrmsg[];			/* Last error message. */
+
+extern	char	*tp_open(/* tpf, filename */);	/* NULL or error message. */
+extern	void	tp_close(/* tpf */);
+extern	char	*tp_error(/* tpf, msg */);	/* Message with the place. */
+extern	int		tp_eof(/* tpf */);			/* TRUE at end of file. */
+extern	void	tp_space(/* tpf */);		/* Skip white space. */
+extern	int		tp_sep(/* tpf */);			/* Skip a space or tab. */
+extern	int		tp_literal(/* tpf, str */);	/* Skip str if it is next. */
+extern	int		tp_int(/* tpf, valp */);	/* FALSE if no number. */
+extern	int		tp_float(/* tpf, valp */);	/* FALSE if no number. */
+extern	int		tp_char(/* tpf */);			/* Slashified char. */
+extern	char	*tp_perm(/* tpf, perm */);	/* NULL or error message. */
+
+#endif /* __TPARSE_H */
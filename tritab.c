@@ -10,9 +10,10 @@
 #include	"cipher.h"
 #include	"autotri.h"
 #include	"terminal.h"
+#include	"tparse.h"
 
 /* Forward declarations */
-void load_tri(FILE *inp);
+char *load_tri(tpfile *tpf);
 
 #define	DEFAULTTRIGLIST	"trigrams.txt"
 int		trig_loaded = FALSE;
@@ -42,22 +43,33 @@ char	trig_buf[TRIGBUFSZ];
 
 
 /* Load the trigram table from the named file.
+ * Returns NULL or an error message.
  */
-void load_tri_from(filename)
+char *load_tri_from(filename)
 char	*filename;
 {
-	FILE	*inp;
+	tpfile	tpf;
+	char	*msg;
 
-	if ((inp = fopen(filename, "r")) == NULL)  {
-		printf("\nCannot open %s to read trigram stats.\n", filename);
-		exit(0);
-		}
-	load_tri(inp);
-	fclose(inp);
+	if ((msg = tp_open(&tpf, filename)) != NULL)  return(msg);
+	msg = load_tri(&tpf);
+	tp_close(&tpf);
+	return(msg);
+}
+
+
+/* Load the trigram table for a routine that can't go on without it.
+ */
+void need_tri(void)
+{
+	char	*msg;
+
+	if ((msg = load_tri_from(trigramstats)) != NULL)
+		need_exit(msg);
 }
 
 
-/* Load trigram table from the given stream.
+/* Parse the trigram table from tpf.
  * Input format:
  * <Total number of trigrams>
  * <blank line>
@@ -66,69 +78,57 @@ char	*filename;
  * <Count for a particular trigram><space><Chars in the particular trigram>
  * <blank line>
  * <End of file>
+ * Returns NULL or an error message.
  */
-void load_tri(FILE *inp)
+char *load_tri(tpfile *tpf)
 {
-	int		n;
 	int		tmp;
 	int		c;
 	float	v, trigram_prob;
 	float	etotal, ctotal;
 	char	*trigram_start;
 
-	trig_loaded = TRUE;
+	trig_loaded = FALSE;
 	trig_tab_next = 0;
 	trig_buf_next = trig_buf;
 	trig_other_prob = 1.0;
 	trig_tab[0].trigram = NULL;
 
-	if (fscanf(inp, "%d", &tmp) != 1)  {
-		printf("\nError while getting total trigram count.\n");
-		exit(0);
-		}
+	if (!tp_int(tpf, &tmp))
+		return(tp_error(tpf, "expected the total trigram count"));
 	etotal = tmp;
 	ctotal = 0.0;
 
-	if (fscanf(inp, "\n") != 0)  {
-		printf("\nError while skipping blank line in trigram file.\n");
-		return;
-		}
-
-	while (TRUE) {
-		if ((n = fscanf(inp, "%d", &tmp)) != 1)  {
-			if (n == 0) break;
-			if (n == EOF) break;
-			printf("\nError getting character count from trigram file.\n ");
-			return;
-			}
+	while (tp_int(tpf, &tmp))  {
+		if (trig_tab_next >= TRIGTABSZ-1)
+			return(tp_error(tpf, "too many trigrams"));
 		v = tmp;
 		ctotal += v;
 		trigram_prob = v/etotal;
 		trig_other_prob -= trigram_prob;
 
-		c = read_char(inp);		/* Skip the space. */
+		if (!tp_sep(tpf))
+			return(tp_error(tpf, "expected a space after the count"));
 		trigram_start = trig_buf_next;
-		while (TRUE) {
-			c = read_char(inp);
-			if (c == EOL)  break;
-			if (trig_buf_next >= &trig_buf[TRIGBUFSZ-1]) {
-				printf("\nOverflowed Trigram buffer.\n");
-				exit(0);
-				}
+		while ((c = tp_char(tpf)) != TPEOL  &&  c != TPEOF)  {
+			if (c == TPBAD)  return(tperrmsg);
+			if (trig_buf_next >= &trig_buf[TRIGBUFSZ-1])
+				return(tp_error(tpf, "overflowed the trigram buffer"));
 			*trig_buf_next++ = c & CHARMASK;
 			}
-		if (trig_buf_next >= &trig_buf[TRIGBUFSZ-1]) {
-			printf("\nOverflowed Trigram buffer.\n");
-			exit(0);
-			}
 		*trig_buf_next++ = 0;
 
 		trig_tab[trig_tab_next].prob = trigram_prob;
 		trig_tab[trig_tab_next].trigram = trigram_start;
 		trig_tab[trig_tab_next].notused = 0;
 		trig_tab_next++;
+		trig_tab[trig_tab_next].trigram = NULL;
 		}
+	if (!tp_eof(tpf))
+		return(tp_error(tpf, "expected a count"));
 
+	trig_loaded = TRUE;
+	return(NULL);
 }
 
 
@@ -11,6 +11,7 @@
 
 
 #include	<stdio.h>
+#include	<string.h>
 #include	"window.h"
 #include	"terminal.h"
 #include	"layout.h"
@@ -19,7 +20,8 @@
 
 
 #define	DONEMSG	 "Command completed."
-#define	USRHLP	1		/* Offset for help line. */
+#define	USRHLP	0		/* Offset for help line. */
+#define	USRHLP2	1		/* Offset for the rest of a long help. */
 #define	USRSTAT	2		/* Offset for status line. */
 #define	USRCMD	3		/* Offset for command line. */
 
@@ -37,7 +39,8 @@ void	usrdown();	/* Defined below. */
 
 /* Command table. */
 #define USRHTEXT \
-"bigram, knit, prop, load, save, lookup, clear, equiv, auto-tri, pword"
+"bigram, ens, knit, prop, load, save, lookup, clear, equiv, auto-tri, \
+pword, phrases, wrong-wires, multi-start, auto-solve, quit"
 
 cmdent	usrcmdtab[] = {
 		{"quit-program permanently", quitcmd},
@@ -46,11 +49,16 @@ cmdent	usrcmdtab[] = {
 		{"lookup-pattern: % in dictionary", webmatch},
 		{"equivalence-class guess, use accept level: % (try 2.0)", ecbguess},
 		{"pwords-from file: %  Max dev: % (try 1.0)", pwdguess},
+		{"phrases-from file: %  Max dev: % (try 1.0)", phrguess},
+		{"wrong-wires of this block", wwguess},
 		{"load-permutations", permload},
 		{"save-permutations", permsave},
 		{"clear-zee permutation", clearzee},
 		{"propagate-info from: % to: % using Zee", pgate},
 		{"bigram-guess level: % (2.0), min_prob: % (0.15)", lpbguess},
+		{"ensemble-guess votes: % (2), lone level: % (10.0), pwords: % (-)", ensguess},
+		{"multi-start level: % (1.5), min_prob: % (0.6), starts: % (8), top: % (1)", msguess},
+		{"auto-solve seconds: % (60), pwords: % (-)", orchcmd},
 		{0, NULL},
 		};
 
@@ -135,21 +143,36 @@ char	*str;
 
 /* Display a string in the help area.
  * If the string is empty, this will clear the help area.
+ * A string too long for the help line is broken at a space and
+ * the rest goes on the line below.
  * Put the cursor back where it was.
  */
 void usrhelp(w, str)
 twindow	*w;
 char	*str;
 {
-	displine *line;
-	int	 row, col;
+	displine *line, *rest;
+	int	 row, col, cut;
+	char	 first[MAXWIDTH+1];
 	
 	row = rowcursor();
 	col = colcursor();
 
 	line = w->dlines[USRHLP];
-	dlsetvar(line, str);
+	rest = w->dlines[USRHLP2];
+	cut = strlen(str);
+	if (cut > line->dl_max_col - line->dl_min_col + 1)  {
+		cut = line->dl_max_col - line->dl_min_col + 1;
+		while (cut > 0  &&  str[cut] != ' ')  cut--;
+		if (cut == 0)  cut = line->dl_max_col - line->dl_min_col + 1;
+		}
+	strncpy(first, str, cut);
+	first[cut] = 0;
+	while (str[cut] == ' ')  cut++;
+	dlsetvar(line, first);
 	(*(line->wredraw))(line);
+	dlsetvar(rest, &str[cut]);
+	(*(rest->wredraw))(rest);
 
 	setcursor(row, col);
 }
@@ -8,6 +8,8 @@
 
 
 #include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
 #include	"window.h"
 #include	"terminal.h"
 #include	"layout.h"
@@ -20,10 +22,22 @@
 #define	TOPINDEX	2
 #define	BOTINDEX	(WEBHEIGHT-2)
 
+extern	long	wtab_stamp();
+
 /* Forward declarations */
 int wordsim();
 int web_first();
 void webgraphics();
+int web_load();
+int web_nextword();
+
+/* The dictionary stays loaded from one lookup to the next, and is
+ * only read again when DICTIONARY names another file or the file
+ * has changed.
+ */
+char	*webdict = NULL;			/* The whole file. */
+char	webdictname[MAXWIDTH+1];
+long	webstamp;
 
 /* Strings for outlining the window.
  */
@@ -127,9 +141,8 @@ char	*args;
 	char	patbuf[MAXWIDTH+1];
 	char	wordbuf[MAXWIDTH+1];
 	int	i;
-	char	*bufptr;
+	char	*next;
 	int	row,col;
-	FILE	*fd;
 	displine *line;
 	int	nextline;	/* Index of next line to put result. */
 	char	*dictfile;
@@ -157,17 +170,17 @@ char	*args;
 	if (dictfile == NULL)
 	  	dictfile = DICTNAME;
 
-	if ((fd = fopen(dictfile, "r")) == NULL)  {
+	if (!web_load(dictfile))  {
 		sprintf(statmsg, "Could not open %s to read dictionary.",
 			dictfile);
 		return(statmsg);
 		}
+	next = webdict;
 
 	for (nextline = TOPINDEX ; nextline <= BOTINDEX ; nextline++) {
 		line = webster.dlines[nextline];
 		while (TRUE) {
-			bufptr = fgets(wordbuf, MAXWIDTH+1, fd);
-			if (bufptr != wordbuf) {
+			if (!web_nextword(&next, wordbuf)) {
 				wordbuf[0] = '\000';
 				goto alldone;
 				}
@@ -182,9 +195,65 @@ char	*args;
 		}
 
 alldone:
+	return(NULL);
+}
+
+
+/* Make webdict hold the contents of dictfile, reading it only if it
+ * is not already there.  Returns FALSE if the file can't be read.
+ */
+int web_load(dictfile)
+char	*dictfile;
+{
+	FILE	*fd;
+	long	stamp, size;
+
+	stamp = wtab_stamp(dictfile);
+	if (webdict != NULL  &&  stamp != 0  &&  stamp == webstamp
+	 && strcmp(dictfile, webdictname) == 0)
+		return(TRUE);
+
+	if ((fd = fopen(dictfile, "r")) == NULL)  return(FALSE);
+	fseek(fd, 0L, 2);
+	size = ftell(fd);
+	rewind(fd);
+	free(webdict);
+	webdictname[0] = 0;
+	if ((webdict = malloc(size + 1)) == NULL)  {
+		fclose(fd);
+		return(FALSE);
+		}
+	size = fread(webdict, 1, size, fd);
+	webdict[size] = 0;
 	fclose(fd);
 
-	return(NULL);
+	if (strlen(dictfile) <= MAXWIDTH)  strcpy(webdictname, dictfile);
+	webstamp = stamp;
+	return(TRUE);
+}
+
+
+/* Copy the line at *nextp into wordbuf, ending it with a newline as
+ * fgets would, and advance *nextp past it.  Returns FALSE at the end
+ * of the dictionary.
+ */
+int web_nextword(nextp, wordbuf)
+char	**nextp;
+char	*wordbuf;
+{
+	char	*p;
+	int		n;
+
+	p = *nextp;
+	if (*p == 0)  return(FALSE);
+	for (n = 0 ; *p != 0  &&  *p != '\n' ; p++)  {
+		if (n < MAXWIDTH-1)  wordbuf[n++] = *p;
+		}
+	if (*p == '\n')  p++;
+	wordbuf[n++] = '\n';
+	wordbuf[n] = 0;
+	*nextp = p;
+	return(TRUE);
 }
 
 
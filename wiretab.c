@@ -0,0 +1,238 @@
+/*
+ * Tables of wire outcomes.
+ *
+ * The outcome of wiring x to y only depends on the ciphertext of
+ * the block and the letter statistics, so it never has to be
+ * recomputed as wires are accepted or undone.
+ *
+ * The characters deduced for the class of x when it is wired to y
+ * are (y - pos) for each position pos in the class.  Each is ascii
+ * for the half of the values of y from pos on, so the values of y
+ * that keep the whole class ascii are the overlap of those halves,
+ * a single arc.  Wt_arcs finds it for every class as the block is
+ * set up, which makes the test for a wire a couple of compares.
+ *
+ * Scores of wires are kept in tables for the last NPERMS blocks
+ * asked about, found by their ciphertext, so the engines that go
+ * round all the blocks keep their tables.  A block only starts to
+ * use its table once it is set up a second time, as the engines that
+ * make one pass over the blocks would only pay for filling it in.
+ * Each entry carries the stamp of its table when it was filled in,
+ * so a table is emptied by giving it a new stamp, which happens when
+ * it is taken over by another block or new letter statistics are
+ * loaded.  Stamps are kept short so that an entry fits in eight
+ * bytes, and when they run out every table is cleared and they
+ * start over.
+ */
+
+#include	<stdio.h>
+#include	<string.h>
+#include	"window.h"
+#include	"specs.h"
+#include	"cipher.h"
+#include	"wiretab.h"
+
+
+/* Index of the wire between x and y, which must differ. */
+#define	wt_index(x, y)	((x) < (y) ? (y)*((y)-1)/2 + (x) : (x)*((x)-1)/2 + (y))
+
+
+/* The wires of one block. */
+#define	wttab	struct xwttab
+wttab	{
+		int		gen;			/* Zero if not in use. */
+		int		hot;			/* TRUE once the block is seen again. */
+		int		stamp;			/* Stamp of the entries filled in. */
+		int		statsgen;		/* Value of stats1gen for the stamp. */
+		long	used;			/* Value of wtclock when last used. */
+		char	ciphertext[BLOCKSIZE];
+		wtent	ent[WTNWIRES];
+		};
+
+
+extern	float	logprob[];
+extern	int		stats1loaded;
+extern	int		stats1gen;
+extern	char	*letterstats;
+
+/* Forward declarations */
+void wt_arcs(ecinfo *eci);
+wtent *wt_wire(ecinfo *eci, int x, int y);
+wttab *wt_find(ecinfo *eci);
+void wt_restamp(wttab *wtt);
+void wt_fill(ecinfo *eci, wtent *ent, int x, int y);
+int wt_class(ecinfo *eci, wtent *ent, int x, int y);
+
+/* Global state. */
+wttab	wttabs[WTNTABS];
+int		wtgen = 0;			/* Last generation given to a table. */
+int		wtstamp = 0;		/* Last stamp given to a table. */
+long	wtclock = 0;
+wtent	wtscratch;			/* Entry for blocks without a table. */
+
+
+/* Fill in the arc of every class of eci, that is the values
+ * wtlo[x] to wtlo[x] + wtlen[x] - 1, modulo BLOCKSIZE, that x can be
+ * wired to without deducing a non-ascii character.  Arcs of values
+ * with no class cover every value.
+ */
+void wt_arcs(ecinfo *eci)
+{
+	int		x, pos, d, lo, len, firstpos;
+	int		firstflag;			/* For macro for_pos_in_class. */
+
+	for (x = 0 ; x < BLOCKSIZE ; x++)  {
+		if ((firstpos = eci->permmap[x]) == NONE)  {
+			eci->wtlo[x] = 0;
+			eci->wtlen[x] = BLOCKSIZE;
+			continue;
+			}
+		lo = firstpos;
+		len = MAXCHAR + 1;
+		for_pos_in_class(pos, firstpos)  {
+			d = MODMASK & (pos - lo);
+			if (d < len)  {
+				lo = pos;
+				len = len - d;
+				}
+			else  {
+				d = d - (BLOCKSIZE - (MAXCHAR + 1));
+				len = (d < len) ? d : len;
+				}
+			if (len <= 0)  {
+				len = 0;
+				break;
+				}
+			}
+		eci->wtlo[x] = lo;
+		eci->wtlen[x] = len;
+		}
+}
+
+
+/* Return the entry for wiring x to y in the block of eci, filling
+ * it in if needed.  The entry may be overwritten by the next call.
+ * It says nothing about conflicts with the wires already in
+ * eci->perm.  The wire must pass wt_ascii.
+ */
+wtent *wt_wire(ecinfo *eci, int x, int y)
+{
+	wttab	*wtt;
+	wtent	*ent;
+
+	x = x & MODMASK;
+	y = y & MODMASK;
+	wtt = &wttabs[eci->wtidx];
+	if (eci->wtgen <= 0  ||  wtt->gen != eci->wtgen
+	 || wtt->statsgen != stats1gen)
+		wtt = wt_find(eci);
+	if (!wtt->hot)  {
+		wt_fill(eci, &wtscratch, x, y);
+		return(&wtscratch);
+		}
+	ent = &wtt->ent[wt_index(x, y)];
+	if (ent->stamp != wtt->stamp)  {
+		wt_fill(eci, ent, x, y);
+		ent->stamp = wtt->stamp;
+		}
+	return(ent);
+}
+
+
+/* Return the table for the block of eci, taking over the least
+ * recently used one if there is none.  Wt_wire only calls this
+ * when the table eci last used is not the right one.
+ */
+wttab *wt_find(ecinfo *eci)
+{
+	wttab	*wtt, *oldest;
+	int		i;
+
+	wtt = &wttabs[eci->wtidx];
+	if (eci->wtgen <= 0  ||  wtt->gen != eci->wtgen)  {
+		oldest = &wttabs[0];
+		for (i = 0 ; i < WTNTABS ; i++)  {
+			wtt = &wttabs[i];
+			if (wtt->gen != 0
+			 && memcmp(wtt->ciphertext, eci->ciphertext, BLOCKSIZE) == 0)
+				break;
+			if (wtt->used < oldest->used)  oldest = wtt;
+			}
+		if (i == WTNTABS)  {
+			wtt = oldest;
+			wtt->gen = ++wtgen;
+			wtt->hot = FALSE;
+			memcpy(wtt->ciphertext, eci->ciphertext, BLOCKSIZE);
+			wtt->statsgen = NONE;
+			}
+		else  {
+			wtt->hot = TRUE;
+			}
+		eci->wtidx = wtt - wttabs;
+		eci->wtgen = wtt->gen;
+		}
+
+	if (wtt->statsgen != stats1gen)  wt_restamp(wtt);
+	wtt->used = ++wtclock;
+	return(wtt);
+}
+
+
+/* Give wtt a new stamp, which empties it.  If the stamps have run
+ * out, clear every table and start them over, leaving the others
+ * to be given new stamps when they are next used.
+ */
+void wt_restamp(wttab *wtt)
+{
+	int		i;
+
+	if (wtstamp >= WTMAXSTAMP)  {
+		for (i = 0 ; i < WTNTABS ; i++)  {
+			memset(wttabs[i].ent, 0, sizeof(wttabs[i].ent));
+			wttabs[i].statsgen = NONE;
+			}
+		wtstamp = 0;
+		}
+	wtt->stamp = ++wtstamp;
+	wtt->statsgen = stats1gen;
+}
+
+
+/* Fill in the entry for x wired to y.  The characters are visited
+ * in the order decode_wire puts them in a pvec, so that the sum
+ * matches the one pvec_1score would compute.
+ */
+void wt_fill(ecinfo *eci, wtent *ent, int x, int y)
+{
+	int		nzero;
+
+	if (!stats1loaded)  {
+		need_1stats();
+		}
+	ent->sum = 0.0;
+	ent->count = 0;
+	nzero = 0;
+	nzero += wt_class(eci, ent, x, y);
+	nzero += wt_class(eci, ent, y, x);
+	if (nzero > 0)  ent->count = 0;
+}
+
+
+/* Add the characters of the class of x to ent, and return how
+ * many of them never occur.
+ */
+int wt_class(ecinfo *eci, wtent *ent, int x, int y)
+{
+	int		pos, c, firstpos, nzero;
+	int		firstflag;			/* For macro for_pos_in_class. */
+
+	nzero = 0;
+	if ((firstpos = eci->permmap[x]) == NONE)  return(nzero);
+	for_pos_in_class(pos, firstpos)  {
+		c = MODMASK & (eci->scipher[pos] + y - x - pos);
+		ent->count++;
+		if (logprob[c] == 0.0)  nzero++;
+		ent->sum += logprob[c];
+		}
+	return(nzero);
+}
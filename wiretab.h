@@ -0,0 +1,43 @@
+#ifndef __WIRETAB_H
+#define __WIRETAB_H
+
+/*
+ * Declarations for the tables of wire outcomes.
+ *
+ * Wiring x to y in a block decides the plaintext of every position
+ * in the classes of x and y, whatever else is known about the block.
+ * The guessing engines ask about the same wires over and over.
+ * Whether a wire only deduces ascii characters is kept for each
+ * class as the arc of values it may be wired to, which ec_init
+ * computes.  The unigram score of a wire is kept in a table for the
+ * block, filled in the first time the wire is scored.
+ */
+
+
+#define	WTNWIRES	(BLOCKSIZE*(BLOCKSIZE-1)/2)	/* Possible wires. */
+#define	WTNTABS		NPERMS	/* Blocks with tables at once. */
+#define	WTMAXSTAMP	32767	/* Stamps start over after this. */
+
+
+#define	wtent	struct xwtent
+wtent	{
+		float	sum;		/* Sum of logprob of the chars deduced. */
+		short	count;		/* Number of chars deduced, zero if */
+							/* one of them never occurs. */
+		short	stamp;		/* Filled in if equal to the table's. */
+		};
+
+
+/* TRUE if y is on the arc of the class of x in the block of eci. */
+#define	wt_onarc(eci, x, y) \
+		((((y) - (eci)->wtlo[x]) & MODMASK) < (eci)->wtlen[x])
+
+/* TRUE if wiring x to y only deduces ascii characters. */
+#define	wt_ascii(eci, x, y) \
+		((x) != (y)  &&  wt_onarc(eci, x, y)  &&  wt_onarc(eci, y, x))
+
+
+extern	void	wt_arcs(/* eci */);		/* Fill in the arcs of eci. */
+extern	wtent	*wt_wire(/* eci, x, y */);	/* Entry for x wired to y. */
+
+#endif /* __WIRETAB_H */
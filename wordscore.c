@@ -0,0 +1,368 @@
+/*
+ * Word level scoring of plaintext.
+ *
+ * The dictionary comes from the file named by WORDSTATS.  Each line
+ * is a word, optionally after a count of how often it occurs, in the
+ * format of the trigram file.  Words are folded to lower case, and
+ * words with characters that are not letters are skipped.  Every
+ * word, and every prefix of a word, is entered in one hash table
+ * with a weight from WSBASE for the rarest word to one for the most
+ * common, so a prefix carries the weight of the commonest word it
+ * starts.  A plain word list gives every word a weight of one.
+ *
+ * A word of the block scores WSHIT per letter times its weight if it
+ * is in the dictionary, and WSMISS per letter if not.  A word that
+ * runs into an unknown character or the right edge of the block
+ * might go on, so it scores WSPART per letter times the weight of
+ * the prefix if it starts a word, and WSMISS if nothing starts that
+ * way.  A word that starts after an unknown character or at the left
+ * edge is not scored, since its start is not known.
+ *
+ * Setting one character only changes the words on either side of
+ * it, so ws_set rescores just those.
+ *
+ * The scoring dictionary is wsmain.  Other word lists, such as the
+ * one wrong-wires looks words up in, are loaded into a wsdict of
+ * their own so they never change how guesses are scored.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<math.h>
+#include	"window.h"
+#include	"specs.h"
+#include	"wordscore.h"
+
+
+#define	WSMINSLOTS	4096		/* First size of the hash table. */
+#define	WSLINESZ	200			/* Longest line in the word list. */
+
+/* Flags of a dictionary entry. */
+#define	WSWORD		01			/* A whole word. */
+#define	WSPREFIX	02			/* Starts a longer word. */
+
+/* A word or a prefix of one.  The letters are in the buf
+ * of its wsdict. */
+#define	wsent	struct xwsent
+wsent	{
+		long	off;			/* Offset of the letters in buf. */
+		short	len;			/* Zero if the slot is empty. */
+		short	flags;			/* WSWORD, WSPREFIX. */
+		float	wweight;		/* Weight as a word. */
+		float	pweight;		/* Weight as a prefix. */
+		};
+
+
+/* Forward declarations */
+int ws_dload(wsdict *d, char *filename);
+int ws_load_from(char *filename);
+char *ws_load(void);
+int ws_ready(void);
+float ws_score(int *pbuf);
+void ws_init(wsinfo *wsi, int *pbuf);
+float ws_set(wsinfo *wsi, int pos, int c);
+float pbuf_wscore(int *pbuf);
+float ws_dweight(wsdict *d, char *word, int len);
+void ws_enter(wsdict *d, long off, int len, int flags, float weight);
+void ws_grow(wsdict *d);
+wsent *ws_find(wsdict *d, char *word, int len);
+unsigned ws_hash(char *word, int len);
+float ws_span(int *pbuf, int first, int last);
+float ws_word(int *pbuf, int first, int last);
+
+/* Global state. */
+int		wstried = FALSE;		/* TRUE once WSVAR has been looked at. */
+wsdict	wsmain;					/* The dictionary words are scored by. */
+
+
+/* Load the dictionary d from the named file, replacing what it held.
+ * Returns FALSE if the file cannot be read.
+ */
+int ws_dload(wsdict *d, char *filename)
+{
+	FILE	*inp;
+	char	line[WSLINESZ+1];
+	char	*p, *w;
+	long	size, off, count, maxcount;
+	int		len, i;
+	float	weight;
+
+	if ((inp = fopen(filename, "r")) == NULL)  return(FALSE);
+	fseek(inp, 0L, 2);
+	size = ftell(inp);
+	rewind(inp);
+
+	free(d->buf);
+	free(d->tab);
+	d->buf = malloc(size + 1);
+	d->tab = NULL;
+	d->slots = d->used = d->nwords = 0;
+	d->loaded = FALSE;
+	if (d->buf == NULL)  {
+		fclose(inp);
+		return(FALSE);
+		}
+	ws_grow(d);
+
+	/* First pass finds the biggest count. */
+	maxcount = 1;
+	while (fgets(line, WSLINESZ+1, inp) != NULL)  {
+		if (sscanf(line, "%ld", &count) == 1  &&  count > maxcount)
+			maxcount = count;
+		}
+	rewind(inp);
+
+	off = 0;
+	while (fgets(line, WSLINESZ+1, inp) != NULL)  {
+		count = 1;
+		for (p = line ; isspace(*p) ; p++);
+		if (*p >= '0'  &&  *p <= '9')  {
+			count = atol(p);
+			while (*p >= '0'  &&  *p <= '9')  p++;
+			while (isspace(*p))  p++;
+			}
+		w = &d->buf[off];
+		for (len = 0 ; isletter(*p) ; p++)  {
+			if (len < WSMAXLEN)  w[len++] = tolower(*p);
+			}
+		if (len == 0  ||  !(*p == '\0' || isspace(*p)))  continue;
+		if (count < 1)  count = 1;
+
+		if (maxcount > 1)
+			weight = WSBASE + (1.0 - WSBASE) * log((float) count) / log((float) maxcount);
+		else
+			weight = 1.0;
+		ws_enter(d, off, len, WSWORD, weight);
+		for (i = 1 ; i < len ; i++)
+			ws_enter(d, off, i, WSPREFIX, weight);
+		off += len;
+		d->nwords++;
+		}
+	fclose(inp);
+	d->loaded = TRUE;
+	return(TRUE);
+}
+
+
+/* Load the scoring dictionary from the named file.
+ * Returns FALSE if the file cannot be read.
+ */
+int ws_load_from(char *filename)
+{
+	wstried = TRUE;
+	return(ws_dload(&wsmain, filename));
+}
+
+
+/* Load the dictionary named by WSVAR, if there is one and this is
+ * the first time.  Returns NULL, or an error message if it could not
+ * be loaded, in which case words are not scored.
+ */
+char *ws_load(void)
+{
+	char	*filename;
+
+	if (wstried)  return(NULL);
+	wstried = TRUE;
+	if ((filename = getenv(WSVAR)) == NULL  ||  ws_load_from(filename))
+		return(NULL);
+	sprintf(statmsg, "Cannot load the words in %.200s.", filename);
+	return(statmsg);
+}
+
+
+/* Return TRUE if a dictionary is loaded, loading the one named by
+ * WSVAR the first time if there is one.
+ */
+int ws_ready(void)
+{
+	ws_load();
+	return(wsmain.loaded);
+}
+
+
+/* Return the word score of the plaintext block pbuf.
+ */
+float ws_score(int *pbuf)
+{
+	if (!ws_ready())  return(0.0);
+	return(ws_span(pbuf, 0, BLOCKSIZE-1));
+}
+
+
+/* Start keeping the word score of pbuf in wsi.
+ */
+void ws_init(wsinfo *wsi, int *pbuf)
+{
+	int		i;
+
+	for (i = 0 ; i < BLOCKSIZE ; i++)  wsi->plain[i] = pbuf[i];
+	wsi->total = ws_score(wsi->plain);
+}
+
+
+/* Set position pos of wsi to c, which may be NONE, and return the
+ * new word score.  Only the words on either side of pos change.
+ */
+float ws_set(wsinfo *wsi, int pos, int c)
+{
+	int		first, last;
+
+	if (!wsmain.loaded)  {
+		wsi->plain[pos] = c;
+		return(wsi->total);
+		}
+	for (first = pos ; first > 0  &&  isletter(wsi->plain[first-1]) ; first--);
+	for (last = pos ; last < BLOCKSIZE-1  &&  isletter(wsi->plain[last+1]) ; last++);
+	wsi->total -= ws_span(wsi->plain, first, last);
+	wsi->plain[pos] = c;
+	wsi->total += ws_span(wsi->plain, first, last);
+	return(wsi->total);
+}
+
+
+/* Return pbuf_2score of pbuf, plus its word score if there
+ * is a dictionary.
+ */
+float pbuf_wscore(int *pbuf)
+{
+	float	score;
+
+	score = pbuf_2score(pbuf);
+	if (ws_ready())  score += ws_span(pbuf, 0, BLOCKSIZE-1);
+	return(score);
+}
+
+
+/* Return the weight in the dictionary d of the len letters of word,
+ * which must be in lower case, as a whole word, or zero if it is
+ * not in d.
+ */
+float ws_dweight(wsdict *d, char *word, int len)
+{
+	wsent	*ent;
+
+	if (!d->loaded  ||  len > WSMAXLEN)  return(0.0);
+	ent = ws_find(d, word, len);
+	if (ent->len == 0  ||  !(ent->flags & WSWORD))  return(0.0);
+	return(ent->wweight);
+}
+
+
+/* Return the score of the words that start between first and last.
+ */
+float ws_span(int *pbuf, int first, int last)
+{
+	int		pos, end;
+	float	total;
+
+	total = 0.0;
+	for (pos = first ; pos <= last ; pos = end + 1)  {
+		if (!isletter(pbuf[pos]))  {
+			end = pos;
+			continue;
+			}
+		for (end = pos ; end < BLOCKSIZE-1  &&  isletter(pbuf[end+1]) ; end++);
+		total += ws_word(pbuf, pos, end);
+		}
+	return(total);
+}
+
+
+/* Return the score of the word of pbuf from first to last.
+ */
+float ws_word(int *pbuf, int first, int last)
+{
+	char	word[WSMAXLEN];
+	int		len, i;
+	wsent	*ent;
+
+	len = last - first + 1;
+	if (first == 0  ||  pbuf[first-1] == NONE  ||  len < WSMINLEN)
+		return(0.0);
+	if (len > WSMAXLEN)  return(len * WSMISS);
+	for (i = 0 ; i < len ; i++)  word[i] = tolower(pbuf[first+i]);
+
+	ent = ws_find(&wsmain, word, len);
+	if (last == BLOCKSIZE-1  ||  pbuf[last+1] == NONE)  {
+		if (ent->len == 0)  return(len * WSMISS);
+		if (ent->flags & WSWORD)  return(len * WSHIT * ent->wweight);
+		return(len * WSPART * ent->pweight);
+		}
+	if (ent->len == 0  ||  !(ent->flags & WSWORD))  return(len * WSMISS);
+	return(len * WSHIT * ent->wweight);
+}
+
+
+/* Enter the first len letters at off in d->buf in the table of d
+ * with the given flags, keeping the biggest weight seen.
+ */
+void ws_enter(wsdict *d, long off, int len, int flags, float weight)
+{
+	wsent	*ent;
+
+	if (4 * (d->used + 1) > 3 * d->slots)  ws_grow(d);
+	ent = ws_find(d, &d->buf[off], len);
+	if (ent->len == 0)  {
+		ent->off = off;
+		ent->len = len;
+		ent->flags = 0;
+		ent->wweight = ent->pweight = 0.0;
+		d->used++;
+		}
+	ent->flags |= flags;
+	if ((flags & WSWORD)  &&  weight > ent->wweight)  ent->wweight = weight;
+	if ((flags & WSPREFIX)  &&  weight > ent->pweight)  ent->pweight = weight;
+}
+
+
+/* Double the size of the hash table of d.
+ */
+void ws_grow(wsdict *d)
+{
+	wsent	*old, *ent;
+	long	oldslots, i;
+
+	old = d->tab;
+	oldslots = d->slots;
+	d->slots = (oldslots == 0) ? WSMINSLOTS : 2 * oldslots;
+	if ((d->tab = calloc(d->slots, sizeof(wsent))) == NULL)  {
+		printf("\nNo room for a table of %ld words.\n", d->slots);
+		exit(0);
+		}
+	for (i = 0 ; i < oldslots ; i++)  {
+		if (old[i].len == 0)  continue;
+		ent = ws_find(d, &d->buf[old[i].off], old[i].len);
+		*ent = old[i];
+		}
+	free(old);
+}
+
+
+/* Return the slot of d for the word of len letters, which is empty
+ * if it is not in the table.
+ */
+wsent *ws_find(wsdict *d, char *word, int len)
+{
+	wsent	*ent;
+	unsigned	h;
+
+	for (h = ws_hash(word, len) & (d->slots-1) ; ; h = (h+1) & (d->slots-1))  {
+		ent = &d->tab[h];
+		if (ent->len == 0)  return(ent);
+		if (ent->len == len  &&  memcmp(&d->buf[ent->off], word, len) == 0)
+			return(ent);
+		}
+}
+
+
+unsigned ws_hash(char *word, int len)
+{
+	unsigned	h;
+	int			i;
+
+	h = 0;
+	for (i = 0 ; i < len ; i++)  h = 31 * h + (word[i] & 0377);
+	return(h ^ (h >> 15));
+}
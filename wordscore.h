@@ -0,0 +1,59 @@
+#ifndef __WORDSCORE_H
+#define __WORDSCORE_H
+
+/*
+ * Declarations for scoring plaintext by the words in it.
+ *
+ * The letter statistics cannot tell "tje" from "the", but a
+ * dictionary can.  The known characters of a block are split into
+ * words at every character that is not a letter, and each word is
+ * looked up in a hashed dictionary.  Words that run into an unknown
+ * character or the edge of the block are only checked as the start
+ * of a word.  The score is in the same units as pbuf_2score.
+ */
+
+
+#define	WSVAR		"WORDSTATS"	/* Shell var naming the word list. */
+#define	WSMINLEN	2			/* Shorter words are not scored. */
+#define	WSMAXLEN	40			/* Longer words are cut. */
+
+/* Score per letter of a word. */
+#define	WSHIT		0.5			/* Word found, scaled by its weight. */
+#define	WSPART		0.25		/* Starts a word, scaled by its weight. */
+#define	WSMISS		(-0.5)		/* Neither. */
+#define	WSBASE		0.5			/* Weight of the rarest word. */
+
+
+/* A hashed word list.  The entries are private to wordscore.c. */
+#define	wsdict	struct xwsdict
+wsdict	{
+		char	*buf;				/* Letters of all the words. */
+		struct	xwsent	*tab;		/* Hash table, a power of two long. */
+		long	slots;
+		long	used;
+		long	nwords;
+		int		loaded;				/* TRUE once a file is in it. */
+		};
+
+
+/* Incremental score of one block. */
+#define	wsinfo	struct xwsinfo
+wsinfo	{
+		int		plain[BLOCKSIZE];	/* Plaintext or NONE. */
+		float	total;				/* Word score of plain. */
+		};
+
+
+extern	wsdict	wsmain;				/* The dictionary words are scored by. */
+
+extern	int		ws_dload(/* d, filename */);	/* FALSE if can't. */
+extern	int		ws_load_from(/* filename */);	/* Into wsmain, FALSE if can't. */
+extern	char	*ws_load();			/* NULL or why WSVAR did not load. */
+extern	int		ws_ready();			/* TRUE if a word list is loaded. */
+extern	float	ws_score(/* pbuf */);	/* Word score of a block. */
+extern	void	ws_init(/* wsi, pbuf */);
+extern	float	ws_set(/* wsi, pos, c */);	/* New total. */
+extern	float	pbuf_wscore(/* pbuf */);	/* Letter and word scores. */
+extern	float	ws_dweight(/* d, word, len */);	/* Zero if not a word in d. */
+
+#endif /* __WORDSCORE_H */
@@ -0,0 +1,267 @@
+/*
+ * Find wires that are probably wrong from misspelled words.
+ *
+ * A wrong wire decodes a wrong character at every position of its
+ * class, so the words of the block come out with the same misspelling
+ * in many places ("tqe", "wqre").  Each word of the block that is not
+ * in the dictionary is checked against every word one substitution
+ * away from it.  The dictionary is the scoring one of wordscore.c
+ * if WORDSTATS is set, else DICTIONARY loaded into a hashed table of
+ * its own, which leaves word scoring off.  Either answers an exact
+ * lookup in one probe, so the neighbours are
+ * simply made and looked up rather than kept in a tree.  When a
+ * neighbour is found, the wire that decoded the changed character is
+ * blamed by the weight of the neighbour.  Every wire is credited for
+ * each dictionary word it helps decode, and the wires are ranked by
+ * blame less credit.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	"window.h"
+#include	"terminal.h"
+#include	"layout.h"
+#include	"specs.h"
+#include	"wordscore.h"
+
+
+#define	DICTNAME	"/usr/dict/words"
+#define	DICTVAR		"DICTIONARY"	/* Name of shell var. */
+#define	WWMINLEN	3			/* Shorter words have too many neighbours. */
+#define	WWGOOD		0.5			/* Credit for each dictionary word. */
+#define	WWEXLEN		12			/* Length of the example shown. */
+#define	WWTOP		2			/* First display line of the list. */
+#define	WWBOT		(WEBHEIGHT-2)
+#define	WWHELP		"Wire, times blamed, example.  Worst first."
+#define	WWLABEL		"Wrong wires"
+#define	WWDONEMSG	"%d wires blamed for misspelled words."
+#define	WWNONEMSG	"No wire is blamed for misspelled words."
+
+/* The blame of one wire, x < y. */
+#define	wwwire	struct xwwwire
+wwwire	{
+		int		x, y;
+		float	bad;			/* Weight of neighbours found. */
+		int		nbad;			/* Words it was blamed for. */
+		int		ngood;			/* Dictionary words it decodes. */
+		char	example[WWEXLEN+1];	/* First word blamed on it. */
+		};
+
+
+extern	char	mcbuf[];
+extern	twindow	webster;
+
+/* Forward declarations */
+int ww_rank();
+void ww_word();
+int ww_neighbours();
+float ww_rankscore();
+int ww_wire();
+
+/* Global state. */
+wwwire	wwtab[BLOCKSIZE];			/* Indexed by x. */
+wsdict	wwlist;						/* DICTIONARY, if there is no WORDSTATS. */
+wsdict	*wwdict;					/* The one words are looked up in. */
+
+
+/* Command to list the wires of the current block that are blamed
+ * for misspelled words, worst first, in the word match window.
+ */
+char	*wwguess(char *str __attribute__((unused)))
+{
+	wwwire	*list[BLOCKSIZE/2];
+	int		n, i, row, col;
+	char	*dictfile;
+	char	buf[MAXWIDTH+1];
+
+	if (ws_ready())  {
+		wwdict = &wsmain;
+		}
+	else  {
+		if (!wwlist.loaded)  {
+			if ((dictfile = getenv(DICTVAR)) == NULL)  dictfile = DICTNAME;
+			if (!ws_dload(&wwlist, dictfile))  {
+				sprintf(statmsg, "Could not open %s to read dictionary.",
+				        dictfile);
+				return(statmsg);
+				}
+			}
+		wwdict = &wwlist;
+		}
+
+	row = rowcursor();
+	col = colcursor();
+	n = ww_rank(mcbuf, refperm(dbsgetblk(&dbstore)), list);
+
+	dlsetvar(webster.dlines[WWTOP-1], WWLABEL);
+	for (i = 0 ; WWTOP + i <= WWBOT ; i++)  {
+		buf[0] = 0;
+		if (i < n)
+			sprintf(buf, "%d-%d %d %s", list[i]->x, list[i]->y,
+			        list[i]->nbad, list[i]->example);
+		dlsetvar(webster.dlines[WWTOP+i], buf);
+		}
+	wl_draw(&webster);
+	setcursor(row, col);
+
+	usrhelp(&user, WWHELP);
+	if (n == 0)  return(WWNONEMSG);
+	sprintf(statmsg, WWDONEMSG, n);
+	return(statmsg);
+}
+
+
+/* Fill in list with the blamed wires of the block cbuf decoded
+ * by perm, worst first.  Returns the number of wires in list.
+ */
+int	ww_rank(cbuf, perm, list)
+char	cbuf[];
+int		perm[];
+wwwire	*list[];
+{
+	int		pbuf[BLOCKSIZE+1];
+	int		first, last, x, n, i, j;
+	wwwire	*w;
+
+	for (x = 0 ; x < BLOCKSIZE ; x++)  {
+		w = &wwtab[x];
+		w->x = x;
+		w->y = perm[x];
+		w->bad = 0.0;
+		w->nbad = w->ngood = 0;
+		w->example[0] = 0;
+		}
+	decode(cbuf, pbuf, perm);
+
+	/* Words are runs of known characters between white space.  Those
+	 * touching an edge or an unknown character may be cut, so they
+	 * are not looked at.
+	 */
+	for (first = 1 ; first < BLOCKSIZE ; first = last + 1)  {
+		last = first;
+		if (pbuf[first] == NONE  ||  isspace(pbuf[first]))  continue;
+		if (pbuf[first-1] == NONE  ||  !isspace(pbuf[first-1]))  continue;
+		while (last+1 < BLOCKSIZE  &&  pbuf[last+1] != NONE
+		    && !isspace(pbuf[last+1]))
+			last++;
+		if (last+1 >= BLOCKSIZE  ||  pbuf[last+1] == NONE)  continue;
+		while (first <= last  &&  !isletter(pbuf[first]))  first++;
+		for (j = last ; j >= first  &&  !isletter(pbuf[j]) ; j--);
+		ww_word(cbuf, perm, pbuf, first, j);
+		}
+
+	n = 0;
+	for (x = 0 ; x < BLOCKSIZE ; x++)  {
+		w = &wwtab[x];
+		if (w->y == NONE  ||  w->y < x  ||  ww_rankscore(w) <= 0.0)  continue;
+		for (i = n++ ; i > 0  &&  ww_rankscore(list[i-1]) < ww_rankscore(w) ; i--)
+			list[i] = list[i-1];
+		list[i] = w;
+		}
+	return(n);
+}
+
+
+/* Blame or credit the wires of the word of pbuf from first to last.
+ * The word may have one character that is not a letter, which is
+ * then the only one that is changed.
+ */
+void	ww_word(cbuf, perm, pbuf, first, last)
+char	cbuf[];
+int		perm[];
+int		pbuf[];
+int		first, last;
+{
+	char	word[WSMAXLEN+1];
+	int		pos[WSMAXLEN];		/* Where the neighbour differs. */
+	int		sub[WSMAXLEN];		/* Letter it has there. */
+	float	weight[WSMAXLEN];
+	int		len, odd, i, n;
+	wwwire	*w;
+
+	len = last - first + 1;
+	if (len < WWMINLEN  ||  len > WSMAXLEN)  return;
+	odd = NONE;
+	for (i = 0 ; i < len ; i++)  {
+		if (isletter(pbuf[first+i]))  {
+			word[i] = tolower(pbuf[first+i]);
+			continue;
+			}
+		if (odd != NONE  ||  pbuf[first+i] == '\''  ||  pbuf[first+i] == '-')
+			return;
+		odd = i;
+		word[i] = '?';
+		}
+	word[len] = 0;
+
+	if (odd == NONE  &&  ws_dweight(wwdict, word, len) > 0.0)  {
+		for (i = 0 ; i < len ; i++)
+			wwtab[ww_wire(cbuf, perm, first+i)].ngood++;
+		return;
+		}
+
+	n = ww_neighbours(word, len, odd, pos, sub, weight);
+	for (i = 0 ; i < n ; i++)  {
+		w = &wwtab[ww_wire(cbuf, perm, first+pos[i])];
+		w->bad += weight[i] / n;
+		w->nbad++;
+		if (w->example[0] == 0)
+			sprintf(w->example, "%.*s>%c", WWEXLEN-2, word, sub[i]);
+		}
+}
+
+
+/* Find the dictionary words that differ from the len letters of word
+ * in one place, which must be odd unless it is NONE.  For each fills
+ * in the place, the letter there and the weight of the word.
+ * Returns how many there are.
+ */
+int	ww_neighbours(word, len, odd, pos, sub, weight)
+char	word[];
+int		len, odd;
+int		pos[], sub[];
+float	weight[];
+{
+	int		i, c, was, n;
+	float	wt;
+
+	n = 0;
+	for (i = 0 ; i < len  &&  n < WSMAXLEN ; i++)  {
+		if (odd != NONE  &&  i != odd)  continue;
+		was = word[i];
+		for (c = 'a' ; c <= 'z'  &&  n < WSMAXLEN ; c++)  {
+			if (c == was)  continue;
+			word[i] = c;
+			if ((wt = ws_dweight(wwdict, word, len)) <= 0.0)  continue;
+			pos[n] = i;
+			sub[n] = c;
+			weight[n++] = wt;
+			}
+		word[i] = was;
+		}
+	return(n);
+}
+
+
+/* Return how strongly w is blamed.
+ */
+float	ww_rankscore(w)
+wwwire	*w;
+{
+	return(w->bad - WWGOOD * w->ngood);
+}
+
+
+/* Return the lower end of the wire that decodes position pos.
+ */
+int	ww_wire(cbuf, perm, pos)
+char	cbuf[];
+int		perm[];
+int		pos;
+{
+	int		x, y;
+
+	x = MODMASK & (cbuf[pos] + pos);
+	y = perm[x];
+	return((y != NONE  &&  y < x) ? y : x);
+}
@@ -8,6 +8,7 @@
 
 #include	<stdio.h>
 #include	<stdlib.h>
+#include	"tparse.h"
 
 
 #define	BLOCKSIZE	256
@@ -16,7 +17,7 @@
 #define	TRUE		1
 
 /* Forward declarations */
-void readblock(FILE *fd, int buf[]);
+void readblock(tpfile *tpf, int buf[]);
 int doblock(int p[]);
 void pgate(int *inperm, int *outperm, int *z, int *zi);
 
@@ -37,18 +38,18 @@ char	*permfile = "zeecode.perm";
 int main(void)
 {
 	int	i;
-	FILE *fd;
+	tpfile	tpf;
 
-	if ((fd = fopen(permfile, "r")) == NULL)  {
+	if (tp_open(&tpf, permfile) != NULL)  {
 		printf("\nCould not open %s to read permutations.\n", permfile);
 		exit(0);
 		}
 
-	readblock(fd, zee);
+	readblock(&tpf, zee);
 	for (i = 0 ; i < BLOCKSIZE ; i++)  zeeinv[zee[i]] = i;
-	readblock(fd, perm);
+	readblock(&tpf, perm);
 
-	fclose(fd);
+	tp_close(&tpf);
 
 	while (doblock(perm))  {
 		pgate(perm, nxtperm, zee, zeeinv);
@@ -101,21 +102,14 @@ int doblock(int p[])
 
 
 /* Read a block of BLOCKSIZE integers into the given buffer from
- * the given stream.
- * The block is terminated by a newline character.
+ * the given file.
  */
-void readblock(FILE *fd, int buf[])
+void readblock(tpfile *tpf, int buf[])
 {
-	int	i;
+	char	*msg;
 
-	for (i = 0 ; i < BLOCKSIZE ; i++) {
-		if (fscanf(fd, "%3d ", &buf[i]) != 1)  {
-			printf("\nReadblock error on i = %d\n", i);
-			exit(0);
-			}
-		}
-	if (fscanf(fd, "\n") != 0)  {
-		printf("\nReadblock error on newline\n");
+	if ((msg = tp_perm(tpf, buf)) != NULL)  {
+		printf("\n%s\n", msg);
 		exit(0);
 		}
 }